@@ -57,10 +57,16 @@ let package = Package(
                 .linkedFramework("SwiftUI")
             ]
         ),
+        // Micro-benchmarks for the C library (swift run -c release CPcStatsBench)
+        .executableTarget(
+            name: "CPcStatsBench",
+            dependencies: ["CPcStats"],
+            path: "Sources/CPcStatsBench"
+        ),
         // Test target
         .testTarget(
             name: "NexMacroTests",
-            dependencies: [],
+            dependencies: ["CPcStats"],
             path: "Tests/NexMacroTests"
         )
     ]
@@ -36,8 +36,8 @@ typedef struct {
     float load;
     float consume;
     float rpm;
-    float memUsed;
-    float memTotal;
+    float memUsed;      // GB: VRAM in use, or unified memory the GPU holds
+    float memTotal;     // GB: VRAM, or the unified memory the GPU may wire
     float freq;
 } GPU;
 
@@ -80,6 +80,12 @@ void pcstats_init(void);
 // Enable/disable temperature reading
 void pcstats_enable_temps(int enable);
 
+// Persist SMC/pmgr/IOReport probe results at path (call before pcstats_init).
+// The file is keyed by hw.model and OS build; other machines or OS updates
+// re-probe. Without a path, everything is probed on every launch.
+// Returns 0 on success, -1 if the path is too long.
+int pcstats_set_probe_cache_path(const char *path);
+
 // Collect all system stats into the provided structure
 void collect_stats(PcStatus *status);
 
@@ -101,16 +107,631 @@ void get_fan_info(FanInfo *fans);
 void get_memory_usage(Memory *mem);
 void get_network_throughput(Network *net);
 void get_disk_usage(Storage *storage);
+void get_disk_throughput(Storage *storage);
 int get_uptime_seconds(void);
 
-// JSON building
+// JSON building (NUL-terminated, returns length or -1 if it doesn't fit)
 int build_json(PcStatus *status, char *buffer, size_t bufsize);
 
-// Serial port communication
+// Stats packet: "pcs" + 2-byte big-endian length + JSON, built in place.
+// Returns the total packet length, or -1 if bufsize is too small.
+#define PCSTATS_PACKET_HEADER_LEN 5
+#define PCSTATS_MAX_PACKET_LEN 1024
+int pcstats_build_packet(const PcStatus *status, uint8_t *buffer, size_t bufsize);
+
+// ============================================================================
+// Binary Frame
+// ============================================================================
+
+// Compact alternative to "pcs" JSON for firmware that advertises it:
+//   "pcb" | version u8 | payload length u8 | payload | CRC-16 (LE)
+// Version 2 payload, little-endian: 22 int16 sensor fields in PcStatus order
+// (tenths, except rpm, tjMax and gpu.freq which are whole units), then
+// storage.read/write and network.up/down as u32 tenths, so fast SSDs and
+// 10GbE don't clamp at 3276.7, then board.tick and time_stamp as u32.
+// Out-of-range values saturate. The CRC is CRC-16/CCITT-FALSE over every
+// byte before it.
+#define PCSTATS_BINARY_VERSION 2
+#define PCSTATS_BINARY_PAYLOAD_LEN (22 * 2 + 4 * 4 + 2 * 4)
+#define PCSTATS_BINARY_FRAME_LEN (5 + PCSTATS_BINARY_PAYLOAD_LEN + 2)
+
+// Returns the frame length, or -1 if bufsize is too small
+int pcstats_build_binary_packet(const PcStatus *status, uint8_t *buffer, size_t bufsize);
+uint16_t pcstats_crc16(const uint8_t *data, size_t len);
+
+// Stats formats a firmware accepts besides full "pcs" JSON, from its reply to
+// the capabilities query: "p=" + comma-separated tokens, e.g. "p=pcb2,pcsd".
+// "pcbN" = binary frame version N (1-31), "pcsd" = partial (dirty-section) JSON.
+typedef struct {
+    uint32_t binary_versions;   // Bit N set: accepts binary frame version N
+    uint8_t binary;             // Accepts PCSTATS_BINARY_VERSION
+    uint8_t partial_json;
+} PcStatsCapabilities;
+
+// Parse the tokens after "p=". Unknown tokens are ignored; spaces around
+// tokens are allowed.
+void pcstats_parse_capabilities(const char *content, PcStatsCapabilities *caps);
+
+// ============================================================================
+// Delta Packets
+// ============================================================================
+
+// Top-level JSON sections, used as a dirty mask
+typedef enum {
+    PCSTATS_SECTION_BOARD   = 1 << 0,
+    PCSTATS_SECTION_CPU     = 1 << 1,
+    PCSTATS_SECTION_GPU     = 1 << 2,
+    PCSTATS_SECTION_STORAGE = 1 << 3,
+    PCSTATS_SECTION_MEMORY  = 1 << 4,
+    PCSTATS_SECTION_NETWORK = 1 << 5,
+    PCSTATS_SECTION_ALL     = 0x3F,
+    PCSTATS_SECTION_TIME    = 1 << 6   // Plan only: "cmd" and "time", nothing else changed
+} PcStatsSection;
+
+#define PCSTATS_DELTA_DEFAULT_KEYFRAME 20
+#define PCSTATS_DELTA_DEFAULT_MAX_SKIPPED 10
+
+// Change-detection state for one device connection
+typedef struct {
+    PcStatus last_sent;               // What the display currently shows
+    int has_last_sent;                // 0 = next packet is a keyframe
+    uint32_t keyframe_interval;       // Full packet at least every N sends (0 = never forced)
+    uint32_t packets_since_keyframe;
+    uint32_t max_skipped;             // Send anyway after N skipped ticks (0 = no limit)
+    uint32_t skipped;
+    float threshold_scale;            // Multiplies the per-field hysteresis (0 = any change)
+    uint32_t last_sections;           // Sections in the last packet built
+} PcStatsDelta;
+
+void pcstats_delta_init(PcStatsDelta *delta, uint32_t keyframe_interval);
+
+// Forget the last-sent state so the next packet is a full keyframe
+// (call after connecting or reconnecting)
+void pcstats_delta_reset(PcStatsDelta *delta);
+
+// Sections whose fields moved past their hysteresis since the last send
+uint32_t pcstats_delta_dirty_sections(const PcStatsDelta *delta, const PcStatus *status);
+
+// Packet options for pcstats_delta_build_packet()
+#define PCSTATS_PACKET_PARTIAL 0x1   // JSON with only the dirty sections
+#define PCSTATS_PACKET_BINARY  0x2   // "pcb" binary frame (always complete)
+
+// Build the packet to send for this tick. Without PCSTATS_PACKET_PARTIAL the
+// packet is always complete; with it only dirty sections are included
+// (keyframes are always complete). Returns the packet length, 0 if nothing
+// needs to be sent, or -1 if bufsize is too small.
+int pcstats_delta_build_packet(PcStatsDelta *delta, const PcStatus *status, int flags,
+                               uint8_t *buffer, size_t bufsize);
+
+// The same decision in two steps, for fanning one snapshot out to several
+// connections: a complete packet (PCSTATS_SECTION_ALL) is identical for every
+// connection using the same format, so it can be built once per tick with
+// pcstats_build_packet() / pcstats_build_binary_packet() and shared.
+// pcstats_delta_plan() returns the sections to send (0 = skip this tick, which
+// counts as skipped); after sending call pcstats_delta_mark_sent() with them.
+uint32_t pcstats_delta_plan(PcStatsDelta *delta, const PcStatus *status, int flags);
+void pcstats_delta_mark_sent(PcStatsDelta *delta, const PcStatus *status, uint32_t sections);
+
+// Packet with only the given JSON sections ("cmd" and "time" always present)
+int pcstats_build_sections_packet(const PcStatus *status, uint32_t sections,
+                                  uint8_t *buffer, size_t bufsize);
+
+// Serial port communication (open_serial() returns a blocking fd;
+// send_pc_status() retries short writes and gives up after ~1 s of stall)
 int open_serial(const char *port, int baud);
+// Any baud rate (via IOSSIOSPEED). latency_us > 0 sets the receive latency
+// (IOSSDATALAT). *applied_baud (may be NULL) receives the rate in effect.
+int open_serial_ex(const char *port, int baud, uint32_t latency_us, int *applied_baud);
 int send_pc_status(int fd, PcStatus *status);
+int serial_set_nonblocking(int fd, int enable);
+// Write all of buf, resuming after short writes; on a nonblocking fd waits
+// up to timeout_ms for the device to drain. Returns 0, or -1 on error/timeout.
+int serial_write_all(int fd, const uint8_t *buf, size_t len, int timeout_ms);
 
 // Display
 void print_stats(PcStatus *status);
 
+// ============================================================================
+// Serial Transmit Queue
+// ============================================================================
+
+// Small ring of outgoing frames for a nonblocking fd. When the device
+// falls behind, the oldest frame that hasn't started sending is dropped
+// (stats frames supersede each other), so a wedged keypad never blocks
+// the caller and a half-sent frame is always completed.
+#define PCSTATS_TXQ_SLOTS 4
+
+typedef struct {
+    uint8_t data[PCSTATS_MAX_PACKET_LEN];
+    uint16_t len;
+    uint16_t offset;    // Bytes already written
+} SerialTxSlot;
+
+typedef struct {
+    SerialTxSlot slots[PCSTATS_TXQ_SLOTS];
+    int head;
+    int tail;
+    int count;
+    uint64_t dropped;   // Frames discarded because the queue was full
+} SerialTxQueue;
+
+void serial_txq_init(SerialTxQueue *queue);
+
+// Queue a frame (copied). Returns 1 if an older frame was dropped, 0 if
+// not, -1 if the frame is too large.
+int serial_txq_push(SerialTxQueue *queue, const uint8_t *data, size_t len);
+
+// Write as much as the fd accepts without blocking (one writev for all
+// queued frames). Returns the bytes still pending, or -1 on a write error.
+int serial_txq_flush(SerialTxQueue *queue, int fd);
+
+// Flush until the queue is empty, waiting up to timeout_ms for the device
+// (before writing anything else, so a half-sent frame finishes first).
+// Returns 0, or -1 on a write error or timeout.
+int serial_txq_drain(SerialTxQueue *queue, int fd, int timeout_ms);
+
+// Build, queue and flush one stats packet (fd should be nonblocking)
+int send_pc_status_queued(SerialTxQueue *queue, int fd, PcStatus *status);
+
+// ============================================================================
+// Collector Scheduler
+// ============================================================================
+
+// Each collector runs at its own period inside collect_stats(); a tick only
+// samples the sources that are due and reuses the last value for the rest.
+typedef enum {
+    PCSTATS_COLLECTOR_TEMPS = 0,   // SMC/HID temperatures + board sensors
+    PCSTATS_COLLECTOR_FANS,        // SMC fan RPM
+    PCSTATS_COLLECTOR_POWER,       // IOReport power/frequency
+    PCSTATS_COLLECTOR_CPU,         // CPU load ticks
+    PCSTATS_COLLECTOR_MEMORY,      // VM statistics
+    PCSTATS_COLLECTOR_NETWORK,     // Interface byte counters
+    PCSTATS_COLLECTOR_DISK,        // Disk usage
+    PCSTATS_COLLECTOR_DISK_IO,     // Disk read/write byte counters
+    PCSTATS_COLLECTOR_PROCESSES,   // Per-process CPU/GPU time (while enabled)
+    PCSTATS_COLLECTOR_COUNT
+} PcCollector;
+
+// Set a collector's minimum period in milliseconds (0 = every tick)
+void pcstats_set_collector_period(PcCollector collector, uint32_t period_ms);
+uint32_t pcstats_get_collector_period(PcCollector collector);
+
+// Release the IOReport subscription and stop sampling power/frequency
+// (reported as 0) until unpaused; the first pass after resuming only
+// primes a new energy delta. Takes effect on the next collect pass.
+void pcstats_set_ioreport_paused(int paused);
+
+// ============================================================================
+// Snapshot API
+// ============================================================================
+
+// Collect stats once and publish them as the current snapshot.
+// Returns the new snapshot sequence number.
+uint64_t pcstats_sample(void);
+
+// Copy the most recent snapshot into *out without sampling again.
+// Wait-free with respect to sampling: never blocks on SMC/IOKit.
+// Returns its sequence number, or 0 if nothing has been sampled yet.
+uint64_t pcstats_snapshot_get(PcStatus *out);
+
+// ============================================================================
+// Extended Stats
+// ============================================================================
+
+// Fields beyond the device JSON protocol, for the app's own UI and exports.
+// Kept out of PcStatus so the wire format and its consumers stay unchanged.
+
+#define PCSTATS_MAX_CORES 32
+#define PCSTATS_MAX_CLUSTERS 8
+
+typedef struct {
+    int core_count;                         // Logical CPUs reported
+    float core_load[PCSTATS_MAX_CORES];     // Percent per logical CPU
+    int perf_core_count;                    // hw.perflevel0.logicalcpu
+    int efficiency_core_count;              // hw.perflevel1.logicalcpu
+    int cluster_count;
+    char cluster_name[PCSTATS_MAX_CLUSTERS][16];  // "ECPU", "PCPU", "PCPU1"...
+    float cluster_freq[PCSTATS_MAX_CLUSTERS];     // MHz, residency weighted
+    float cluster_load[PCSTATS_MAX_CLUSTERS];     // Percent of time active
+} CpuCoreStats;
+
+#define PCSTATS_MAX_INTERFACES 16
+
+typedef struct {
+    char name[16];          // BSD name, e.g. "en0"
+    float up;               // Mb/s
+    float down;             // Mb/s
+    uint64_t bytes_in;      // Cumulative 64-bit counters
+    uint64_t bytes_out;
+} InterfaceStats;
+
+typedef struct {
+    int interface_count;
+    InterfaceStats interfaces[PCSTATS_MAX_INTERFACES];
+} NetworkDetail;
+
+typedef enum {
+    PCSTATS_MEMORY_PRESSURE_NORMAL = 0,
+    PCSTATS_MEMORY_PRESSURE_WARNING,
+    PCSTATS_MEMORY_PRESSURE_CRITICAL
+} PcMemoryPressure;
+
+typedef struct {
+    uint64_t total_bytes;                // hw.memsize
+    uint64_t free_bytes;
+    uint64_t active_bytes;
+    uint64_t inactive_bytes;
+    uint64_t wired_bytes;
+    uint64_t app_bytes;                  // Anonymous pages minus purgeable
+    uint64_t compressed_bytes;           // Space taken by the compressor
+    uint64_t compressed_original_bytes;  // Uncompressed size of its contents
+    uint64_t purgeable_bytes;
+    uint64_t file_backed_bytes;
+    uint64_t swap_used_bytes;            // vm.swapusage
+    uint64_t swap_total_bytes;
+    PcMemoryPressure pressure_level;     // kern.memorystatus_vm_pressure_level
+    float pressure_percent;              // (wired + compressed) / total
+} MemoryDetail;
+
+typedef struct {
+    CpuCoreStats cores;
+    NetworkDetail network;  // Interfaces summed into PcStatus.network
+    MemoryDetail memory;
+} PcStatusExt;
+
+// Per-core load since the previous call (cores are ordered as the kernel
+// reports them; on Apple Silicon E-cores come first)
+void get_cpu_core_usage(CpuCoreStats *cores);
+
+// Memory breakdown from the last memory sample
+void get_memory_detail(MemoryDetail *detail);
+
+// Per-interface throughput from the last network sample
+void get_network_detail(NetworkDetail *detail);
+
+// Restrict network totals to the named interfaces (e.g. {"en0"}).
+// NULL/0 restores the default: all up, non-loopback, non-virtual
+// interfaces (utun, awdl, bridge... are skipped to avoid double counting).
+// Returns -1 if count exceeds PCSTATS_MAX_INTERFACES.
+int pcstats_set_network_interfaces(const char *const *names, int count);
+
+// collect_stats() plus the extended fields (ext may be NULL)
+void collect_stats_ext(PcStatus *status, PcStatusExt *ext);
+
+// pcstats_snapshot_get() plus the extended fields from the same sample
+uint64_t pcstats_snapshot_get_ext(PcStatus *out, PcStatusExt *ext);
+
+// ============================================================================
+// History
+// ============================================================================
+
+// Every published snapshot is also recorded into fixed-size rings: raw
+// samples plus 1-minute and 1-hour tiers whose min/max/avg are rolled up
+// as samples arrive. Storage is static, so memory stays bounded however
+// long the app runs.
+
+typedef enum {
+    PCSTATS_METRIC_CPU_LOAD = 0,    // Percent
+    PCSTATS_METRIC_CPU_TEMP,        // °C
+    PCSTATS_METRIC_CPU_POWER,       // W
+    PCSTATS_METRIC_GPU_LOAD,        // Percent
+    PCSTATS_METRIC_GPU_TEMP,        // °C
+    PCSTATS_METRIC_GPU_POWER,       // W
+    PCSTATS_METRIC_GPU_FREQ,        // MHz
+    PCSTATS_METRIC_MEMORY_PERCENT,  // Percent
+    PCSTATS_METRIC_NET_UP,          // Mb/s
+    PCSTATS_METRIC_NET_DOWN,        // Mb/s
+    PCSTATS_METRIC_DISK_READ,       // MB/s
+    PCSTATS_METRIC_DISK_WRITE,      // MB/s
+    PCSTATS_METRIC_BOARD_TEMP,      // °C
+    PCSTATS_METRIC_FAN_RPM,
+    PCSTATS_METRIC_COUNT
+} PcStatsMetric;
+
+typedef enum {
+    PCSTATS_TIER_RAW = 0,   // One point per sample
+    PCSTATS_TIER_MINUTE,    // One point per wall-clock minute
+    PCSTATS_TIER_HOUR,      // One point per wall-clock hour
+    PCSTATS_TIER_COUNT
+} PcStatsTier;
+
+#define PCSTATS_HISTORY_RAW_CAPACITY    1200  // 1 h at the default 3 s interval
+#define PCSTATS_HISTORY_MINUTE_CAPACITY 720   // 12 h
+#define PCSTATS_HISTORY_HOUR_CAPACITY   336   // 14 days
+
+typedef struct {
+    int64_t time_ms;    // Sample time, or bucket start for rollup tiers (Unix ms)
+    float min;
+    float max;
+    float avg;          // Raw tier: min == max == avg == the sample
+    uint32_t samples;   // Samples in the bucket (1 for raw)
+} PcStatsHistoryPoint;
+
+// Record a sample (snapshots are recorded automatically; exposed for
+// replaying recorded data and tests)
+void pcstats_history_record(const PcStatus *status, int64_t time_ms);
+
+// Copy up to max_points of a metric's points newer than since_ms into out,
+// oldest first; if more match, the most recent are kept. Rollup tiers end
+// with the bucket still being filled. Returns the number of points written.
+int pcstats_history_copy(PcStatsTier tier, PcStatsMetric metric, int64_t since_ms,
+                         PcStatsHistoryPoint *out, int max_points);
+
+// Min/max/sample-weighted avg over the same window as pcstats_history_copy
+// (out->time_ms is the oldest point). Returns the number of points covered.
+int pcstats_history_summary(PcStatsTier tier, PcStatsMetric metric, int64_t since_ms,
+                            PcStatsHistoryPoint *out);
+
+// Drop all history
+void pcstats_history_reset(void);
+
+// ============================================================================
+// Temperature Sensors
+// ============================================================================
+
+// The SMC keys behind cpu.temp/gpu.temp/board.temp. Apple Silicon chips
+// M1-M4 (Pro/Max/Ultra included) use a built-in key table selected from
+// machdep.cpu.brand_string; other chips fall back to probing generic key
+// lists. Readings come from the last live TEMPS pass (not recorded/replayed).
+
+#define PCSTATS_MAX_SENSORS 96
+
+typedef enum {
+    PCSTATS_SENSOR_CPU_EFFICIENCY = 0,  // E-cluster
+    PCSTATS_SENSOR_CPU_PERFORMANCE,     // P-cluster (or CPU, when the key list can't tell)
+    PCSTATS_SENSOR_GPU,
+    PCSTATS_SENSOR_BOARD
+} PcSensorKind;
+
+typedef struct {
+    char key[5];                // SMC key, e.g. "Tp01"
+    uint8_t kind;               // PcSensorKind
+    float celsius;              // 0 if the last read was out of range
+} PcSensorReading;
+
+// Copy up to max readings (CPU keys first, then GPU, then board).
+// Returns the number written, 0 before the first TEMPS pass.
+int pcstats_get_sensors(PcSensorReading *out, int max);
+
+// The key table in use: "M1".."M4", or "generic" when probing
+const char *pcstats_sensor_table(void);
+
+// ============================================================================
+// Top Processes
+// ============================================================================
+
+// Which processes use the CPU and GPU, sampled by PCSTATS_COLLECTOR_PROCESSES
+// while enabled (off by default). Per-pid time totals live in a table that is
+// updated in place every pass: exited pids are evicted, reused pids detected
+// by their start time, and names looked up only for pids that make a list.
+// CPU time comes from proc_pid_rusage(), so only the user's own processes are
+// visible without root; GPU time from the accelerator's user clients.
+
+#define PCSTATS_MAX_TOP_PROCESSES 16
+
+typedef struct {
+    int pid;
+    char name[32];              // proc_name(), truncated
+    float cpu_percent;          // Of one core since the previous pass (200 = two busy cores)
+    float gpu_percent;          // Of GPU time since the previous pass
+    uint64_t footprint_bytes;   // Physical footprint, as in Activity Monitor
+} PcProcessStats;
+
+typedef enum {
+    PCSTATS_PROCESS_SORT_CPU = 0,
+    PCSTATS_PROCESS_SORT_GPU
+} PcProcessSort;
+
+// Start tracking, or stop and free the table (on the next collect pass)
+void pcstats_processes_enable(int enable);
+
+// Copy up to max of the busiest processes from the last pass, busiest first
+// (at most PCSTATS_MAX_TOP_PROCESSES; idle processes are left out).
+// Returns the number written, 0 while disabled or before the second pass.
+int pcstats_get_top_processes(PcProcessSort sort, PcProcessStats *out, int max);
+
+// ============================================================================
+// Record / Replay
+// ============================================================================
+
+// A recording holds the output of every collector for each sampling pass.
+// Replaying one feeds collect_stats() from the file instead of from
+// SMC/HID/IOReport/sysctl, so the scheduler, encoders and delta detection
+// can be benchmarked and tested on machines without the hardware. Frames
+// are captured after each collector's own averaging, not as raw IOKit
+// replies. The format is host-endian and tied to this header's struct
+// layouts (frame_size is checked on open).
+
+#define PCSTATS_REPLAY_MAGIC   0x4650434e  // "NCPF"
+#define PCSTATS_REPLAY_VERSION 2
+
+typedef struct {
+    uint64_t offset_ms;         // Monotonic ms since the first frame (replay clock)
+    long time_stamp;            // PcStatus.time_stamp
+    int uptime_seconds;
+    float cpu_temp;             // SMC or HID
+    float gpu_temp;
+    float board_temp;
+    FanInfo fans;
+    float cpu_power;            // IOReport
+    float gpu_power;
+    float gpu_freq;
+    float gpu_load;
+    float gpu_mem_used;         // IOAccelerator, GB
+    float gpu_mem_total;
+    float cpu_load;
+    CpuCoreStats cores;         // Per-core load plus IOReport cluster residency
+    Memory memory;
+    MemoryDetail memory_detail;
+    Network network;
+    NetworkDetail network_detail;
+    Storage storage;
+} PcStatsReplayFrame;
+
+// Append a frame for every hardware sampling pass to path (truncated).
+// Returns 0, or -1 if the file can't be created or a recording is running.
+int pcstats_record_start(const char *path);
+void pcstats_record_stop(void);
+
+// Serve collect_stats() from a recording. Collectors still run on their
+// periods, against the frames' clock; after the last frame the recording
+// restarts (loop != 0) or its final frame repeats. Returns the number of
+// frames, or -1 if the file is missing, truncated or from another layout.
+int pcstats_replay_open(const char *path, int loop);
+
+// Same, from frames in memory (copied). Returns count, or -1 if count < 1.
+int pcstats_replay_load(const PcStatsReplayFrame *frames, int count, int loop);
+
+// Back to live sampling (collector schedules restart)
+void pcstats_replay_close(void);
+
+// Frames consumed since the replay started, or -1 when not replaying
+int pcstats_replay_position(void);
+
+// ============================================================================
+// Export - share snapshots with other processes
+// ============================================================================
+
+// While enabled, every published snapshot is also written to a memory-mapped
+// file so other processes can read the stats without sampling IOKit
+// themselves. The region is a seqlock: seq is odd while the writer is inside
+// it; readers copy, then retry if seq changed (pcstats_export_read).
+
+#define PCSTATS_EXPORT_MAGIC   0x5843504e  // "NPCX"
+#define PCSTATS_EXPORT_VERSION 1
+
+typedef struct {
+    uint32_t magic;         // PCSTATS_EXPORT_MAGIC
+    uint16_t version;       // PCSTATS_EXPORT_VERSION
+    uint16_t header_size;   // offsetof(status); later versions only append
+    uint32_t status_size;   // sizeof(PcStatus)
+    uint32_t ext_size;      // sizeof(PcStatusExt)
+    uint32_t seq;           // Accessed atomically; odd while being written
+    int32_t writer_pid;
+    uint64_t sample_id;     // Snapshot sequence number
+    int64_t time_ms;        // Unix ms when the snapshot was published
+    PcStatus status;
+    PcStatusExt ext;
+} PcStatsExportRegion;
+
+// Map path (created or truncated to the region size, mode 0644) and start
+// publishing into it. Returns 0 on success, -1 on error.
+int pcstats_export_shm_open(const char *path);
+
+// Stop publishing and unmap (the file stays, marked with seq = 0)
+void pcstats_export_shm_close(void);
+
+// Copy a consistent snapshot out of a mapped region (for readers).
+// Returns its sample id, or 0 if the region is empty, invalid or busy.
+uint64_t pcstats_export_read(const PcStatsExportRegion *region, PcStatus *status, PcStatusExt *ext);
+
+// Serve the current snapshot in Prometheus text format on a Unix socket.
+// Each connection gets one scrape, as an HTTP response if the client sent
+// a request line, otherwise as plain text. Returns 0 or -1.
+int pcstats_export_socket_start(const char *path);
+void pcstats_export_socket_stop(void);
+
+// Format the current snapshot as Prometheus text exposition.
+// Returns the length written (without NUL), or -1 if buf is too small.
+int pcstats_export_prometheus(char *buf, size_t size);
+
+// ============================================================================
+// Metrics - where a sampling pass spends its time
+// ============================================================================
+
+// Off by default. While disabled every probe is one relaxed atomic load;
+// enabled, timers read mach_absolute_time() and update lock-free
+// log-linear histograms (4 buckets per power of two, so percentiles are
+// within ~25%).
+
+typedef enum {
+    PCSTATS_TIMER_TICK = 0,       // Whole collect_stats_ext() pass
+    PCSTATS_TIMER_SMC_TEMPS,      // smc_get_temperatures
+    PCSTATS_TIMER_HID_TEMPS,      // hid_get_temperatures (M1 fallback)
+    PCSTATS_TIMER_BOARD_TEMP,     // SMC board sensors
+    PCSTATS_TIMER_IOREPORT,       // ior_sample
+    PCSTATS_TIMER_FANS,           // get_fan_info
+    PCSTATS_TIMER_CPU,            // host_processor_info (total + per core)
+    PCSTATS_TIMER_MEMORY,
+    PCSTATS_TIMER_NETWORK,        // NET_RT_IFLIST2 sysctl / getifaddrs
+    PCSTATS_TIMER_DISK_USAGE,     // statvfs
+    PCSTATS_TIMER_DISK_IO,        // IOBlockStorageDriver statistics
+    PCSTATS_TIMER_PROCESSES,      // proc_pid_rusage over all pids + GPU clients
+    PCSTATS_TIMER_SERIAL_SEND,    // One stats packet handed to the port
+    PCSTATS_TIMER_COUNT
+} PcStatsTimer;
+
+typedef enum {
+    PCSTATS_COUNTER_SMC_CALLS = 0,      // IOConnectCallStructMethod on AppleSMC
+    PCSTATS_COUNTER_SMC_ERRORS,         // ... that failed or found no key
+    PCSTATS_COUNTER_HID_CALLS,          // IOHIDServiceClientCopyEvent
+    PCSTATS_COUNTER_HID_ERRORS,         // ... that returned no event
+    PCSTATS_COUNTER_IOREPORT_CALLS,     // IOReportCreateSamples
+    PCSTATS_COUNTER_IOREPORT_ERRORS,
+    PCSTATS_COUNTER_IOREG_CALLS,        // IORegistryEntryCreateCFProperty (disk, GPU)
+    PCSTATS_COUNTER_IOREG_ERRORS,
+    PCSTATS_COUNTER_NET_FALLBACKS,      // Ticks that fell back to getifaddrs
+    PCSTATS_COUNTER_SERIAL_BYTES_SENT,
+    PCSTATS_COUNTER_SERIAL_BYTES_DROPPED, // Failed writes and queue overflow
+    PCSTATS_COUNTER_SERIAL_ERRORS,
+    PCSTATS_COUNTER_COUNT
+} PcStatsCounter;
+
+typedef struct {
+    uint64_t count;
+    uint64_t total_ns;
+    uint64_t max_ns;
+    uint64_t p50_ns;
+    uint64_t p99_ns;
+} PcStatsTimerStats;
+
+typedef struct {
+    int enabled;
+    PcStatsTimerStats timers[PCSTATS_TIMER_COUNT];
+    uint64_t counters[PCSTATS_COUNTER_COUNT];
+} PcStatsMetrics;
+
+// Start/stop recording (recorded values are kept when disabling)
+void pcstats_metrics_enable(int enable);
+
+// Copy everything recorded since the last reset. Returns 0, or -1 if out is NULL.
+int pcstats_get_metrics(PcStatsMetrics *out);
+
+// Zero all timers and counters
+void pcstats_metrics_reset(void);
+
+// Record from callers outside the library (e.g. an app sending over its own
+// serial port). No-ops while disabled.
+void pcstats_metrics_add(PcStatsCounter counter, uint64_t value);
+void pcstats_metrics_record_ns(PcStatsTimer timer, uint64_t ns);
+
+// Short stable names ("smc_temps", "serial_bytes_sent"), "" if out of range
+const char *pcstats_metrics_timer_name(PcStatsTimer timer);
+const char *pcstats_metrics_counter_name(PcStatsCounter counter);
+
+// ============================================================================
+// Background Sampler (optional)
+// ============================================================================
+
+// Called on the sampler thread after each snapshot is published
+typedef void (*pcstats_sample_callback)(uint64_t seq, void *ctx);
+
+// Start a dedicated thread that owns all collector state and publishes a
+// snapshot every interval_ms. While it runs, pcstats_sample() does not
+// collect. Returns 0 on success, -1 if already running or on error.
+int pcstats_sampler_start(uint32_t interval_ms, pcstats_sample_callback callback, void *ctx);
+
+// Stop the sampler thread; no callbacks run after this returns
+void pcstats_sampler_stop(void);
+
+// Change the sampling interval. The next sample is due interval_ms after the
+// last one started (right away if that has passed); no extra sample is taken.
+void pcstats_sampler_set_interval(uint32_t interval_ms);
+
+// Sample immediately instead of waiting for the next tick
+void pcstats_sampler_trigger(void);
+
+// Returns 1 if the background sampler is running
+int pcstats_sampler_is_running(void);
+
 #endif // PCSTATS_H
@@ -1,8 +1,17 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdarg.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <errno.h>
+#include <poll.h>
+#include <sys/uio.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <IOKit/serial/ioss.h>
 #include <termios.h>
 #include <time.h>
 #include <sys/time.h>
@@ -11,8 +20,17 @@
 #include <mach/mach.h>
 #include <mach/processor_info.h>
 #include <mach/mach_host.h>
+#include <mach/mach_time.h>
 #include <net/if.h>
+#include <net/if_dl.h>
+#include <net/route.h>
 #include <ifaddrs.h>
+#include <dlfcn.h>
+#include <libproc.h>
+#include <sys/resource.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <dispatch/dispatch.h>
 #include <IOKit/IOKitLib.h>
 #include <CoreFoundation/CoreFoundation.h>
 
@@ -23,6 +41,192 @@ typedef struct __IOHIDEventSystemClient *IOHIDEventSystemClientRef;
 typedef struct __IOHIDServiceClient *IOHIDServiceClientRef;
 typedef struct __IOHIDEvent *IOHIDEventRef;
 
+// ============================================================================
+// Metrics - per-collector latency histograms and IOKit call counters
+// ============================================================================
+
+// Log-linear buckets: values below 4 ns are exact, then 4 sub-buckets per
+// power of two up to 2^40 ns (~18 minutes)
+#define METRICS_SUB_BITS 2
+#define METRICS_SUBS (1 << METRICS_SUB_BITS)
+#define METRICS_BUCKETS (40 * METRICS_SUBS)
+
+typedef struct {
+    _Atomic uint64_t count;
+    _Atomic uint64_t total_ns;
+    _Atomic uint64_t max_ns;
+    _Atomic uint64_t buckets[METRICS_BUCKETS];
+} MetricsTimer;
+
+static _Atomic int metrics_enabled = 0;
+static MetricsTimer metrics_timers[PCSTATS_TIMER_COUNT];
+static _Atomic uint64_t metrics_counters[PCSTATS_COUNTER_COUNT];
+static mach_timebase_info_data_t metrics_timebase;
+
+static const char *const metrics_timer_names[PCSTATS_TIMER_COUNT] = {
+    [PCSTATS_TIMER_TICK]        = "tick",
+    [PCSTATS_TIMER_SMC_TEMPS]   = "smc_temps",
+    [PCSTATS_TIMER_HID_TEMPS]   = "hid_temps",
+    [PCSTATS_TIMER_BOARD_TEMP]  = "board_temp",
+    [PCSTATS_TIMER_IOREPORT]    = "ioreport",
+    [PCSTATS_TIMER_FANS]        = "fans",
+    [PCSTATS_TIMER_CPU]         = "cpu",
+    [PCSTATS_TIMER_MEMORY]      = "memory",
+    [PCSTATS_TIMER_NETWORK]     = "network",
+    [PCSTATS_TIMER_DISK_USAGE]  = "disk_usage",
+    [PCSTATS_TIMER_DISK_IO]     = "disk_io",
+    [PCSTATS_TIMER_PROCESSES]   = "processes",
+    [PCSTATS_TIMER_SERIAL_SEND] = "serial_send",
+};
+
+static const char *const metrics_counter_names[PCSTATS_COUNTER_COUNT] = {
+    [PCSTATS_COUNTER_SMC_CALLS]            = "smc_calls",
+    [PCSTATS_COUNTER_SMC_ERRORS]           = "smc_errors",
+    [PCSTATS_COUNTER_HID_CALLS]            = "hid_calls",
+    [PCSTATS_COUNTER_HID_ERRORS]           = "hid_errors",
+    [PCSTATS_COUNTER_IOREPORT_CALLS]       = "ioreport_calls",
+    [PCSTATS_COUNTER_IOREPORT_ERRORS]      = "ioreport_errors",
+    [PCSTATS_COUNTER_IOREG_CALLS]          = "ioreg_calls",
+    [PCSTATS_COUNTER_IOREG_ERRORS]         = "ioreg_errors",
+    [PCSTATS_COUNTER_NET_FALLBACKS]        = "net_fallbacks",
+    [PCSTATS_COUNTER_SERIAL_BYTES_SENT]    = "serial_bytes_sent",
+    [PCSTATS_COUNTER_SERIAL_BYTES_DROPPED] = "serial_bytes_dropped",
+    [PCSTATS_COUNTER_SERIAL_ERRORS]        = "serial_errors",
+};
+
+static inline int metrics_on(void) {
+    return atomic_load_explicit(&metrics_enabled, memory_order_relaxed);
+}
+
+// Start a timed section: 0 while disabled, so metrics_stop() skips it
+static inline uint64_t metrics_start(void) {
+    return metrics_on() ? mach_absolute_time() : 0;
+}
+
+static inline void metrics_count(PcStatsCounter counter, uint64_t value) {
+    if (metrics_on()) {
+        atomic_fetch_add_explicit(&metrics_counters[counter], value, memory_order_relaxed);
+    }
+}
+
+static int metrics_bucket(uint64_t ns) {
+    if (ns < METRICS_SUBS) return (int)ns;
+    int msb = 63 - __builtin_clzll(ns);
+    int sub = (int)(ns >> (msb - METRICS_SUB_BITS)) & (METRICS_SUBS - 1);
+    int bucket = ((msb - METRICS_SUB_BITS + 1) << METRICS_SUB_BITS) + sub;
+    return bucket < METRICS_BUCKETS ? bucket : METRICS_BUCKETS - 1;
+}
+
+// Midpoint of a bucket's range
+static uint64_t metrics_bucket_value(int bucket) {
+    if (bucket < METRICS_SUBS) return (uint64_t)bucket;
+    int shift = (bucket >> METRICS_SUB_BITS) - 1;
+    uint64_t low = (uint64_t)(METRICS_SUBS | (bucket & (METRICS_SUBS - 1))) << shift;
+    return low + ((1ull << shift) >> 1);
+}
+
+static void metrics_record(PcStatsTimer timer, uint64_t ns) {
+    MetricsTimer *t = &metrics_timers[timer];
+    atomic_fetch_add_explicit(&t->count, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&t->total_ns, ns, memory_order_relaxed);
+    atomic_fetch_add_explicit(&t->buckets[metrics_bucket(ns)], 1, memory_order_relaxed);
+
+    uint64_t max = atomic_load_explicit(&t->max_ns, memory_order_relaxed);
+    while (ns > max && !atomic_compare_exchange_weak_explicit(&t->max_ns, &max, ns,
+                                                              memory_order_relaxed,
+                                                              memory_order_relaxed)) {
+    }
+}
+
+static inline void metrics_stop(PcStatsTimer timer, uint64_t start) {
+    if (!start) return;
+    uint64_t ticks = mach_absolute_time() - start;
+    metrics_record(timer, ticks * metrics_timebase.numer / metrics_timebase.denom);
+}
+
+void pcstats_metrics_enable(int enable) {
+    if (enable && metrics_timebase.denom == 0) {
+        mach_timebase_info(&metrics_timebase);
+    }
+    atomic_store_explicit(&metrics_enabled, enable ? 1 : 0, memory_order_relaxed);
+}
+
+void pcstats_metrics_reset(void) {
+    for (int i = 0; i < PCSTATS_TIMER_COUNT; i++) {
+        MetricsTimer *t = &metrics_timers[i];
+        atomic_store_explicit(&t->count, 0, memory_order_relaxed);
+        atomic_store_explicit(&t->total_ns, 0, memory_order_relaxed);
+        atomic_store_explicit(&t->max_ns, 0, memory_order_relaxed);
+        for (int b = 0; b < METRICS_BUCKETS; b++) {
+            atomic_store_explicit(&t->buckets[b], 0, memory_order_relaxed);
+        }
+    }
+    for (int i = 0; i < PCSTATS_COUNTER_COUNT; i++) {
+        atomic_store_explicit(&metrics_counters[i], 0, memory_order_relaxed);
+    }
+}
+
+// Value at quantile q (0..1) of a bucket snapshot holding total samples
+static uint64_t metrics_quantile(const uint64_t *buckets, uint64_t total, double q, uint64_t max) {
+    if (total == 0) return 0;
+    uint64_t rank = (uint64_t)(q * (double)(total - 1)) + 1;
+    uint64_t seen = 0;
+    for (int b = 0; b < METRICS_BUCKETS; b++) {
+        seen += buckets[b];
+        if (seen >= rank) {
+            uint64_t value = metrics_bucket_value(b);
+            return value < max ? value : max;
+        }
+    }
+    return max;
+}
+
+int pcstats_get_metrics(PcStatsMetrics *out) {
+    if (!out) return -1;
+    memset(out, 0, sizeof(*out));
+    out->enabled = metrics_on();
+
+    for (int i = 0; i < PCSTATS_TIMER_COUNT; i++) {
+        MetricsTimer *t = &metrics_timers[i];
+        PcStatsTimerStats *s = &out->timers[i];
+        uint64_t buckets[METRICS_BUCKETS];
+        uint64_t total = 0;
+
+        // Writers may land mid-copy; percentiles use the buckets' own total
+        for (int b = 0; b < METRICS_BUCKETS; b++) {
+            buckets[b] = atomic_load_explicit(&t->buckets[b], memory_order_relaxed);
+            total += buckets[b];
+        }
+        s->count = atomic_load_explicit(&t->count, memory_order_relaxed);
+        s->total_ns = atomic_load_explicit(&t->total_ns, memory_order_relaxed);
+        s->max_ns = atomic_load_explicit(&t->max_ns, memory_order_relaxed);
+        s->p50_ns = metrics_quantile(buckets, total, 0.50, s->max_ns);
+        s->p99_ns = metrics_quantile(buckets, total, 0.99, s->max_ns);
+    }
+    for (int i = 0; i < PCSTATS_COUNTER_COUNT; i++) {
+        out->counters[i] = atomic_load_explicit(&metrics_counters[i], memory_order_relaxed);
+    }
+    return 0;
+}
+
+void pcstats_metrics_add(PcStatsCounter counter, uint64_t value) {
+    if ((unsigned)counter >= PCSTATS_COUNTER_COUNT) return;
+    metrics_count(counter, value);
+}
+
+void pcstats_metrics_record_ns(PcStatsTimer timer, uint64_t ns) {
+    if ((unsigned)timer >= PCSTATS_TIMER_COUNT || !metrics_on()) return;
+    metrics_record(timer, ns);
+}
+
+const char *pcstats_metrics_timer_name(PcStatsTimer timer) {
+    return (unsigned)timer < PCSTATS_TIMER_COUNT ? metrics_timer_names[timer] : "";
+}
+
+const char *pcstats_metrics_counter_name(PcStatsCounter counter) {
+    return (unsigned)counter < PCSTATS_COUNTER_COUNT ? metrics_counter_names[counter] : "";
+}
+
 // ============================================================================
 // SMC (System Management Controller) Interface for Apple Silicon
 // Based on macmon implementation (https://github.com/vladkens/macmon)
@@ -109,9 +313,11 @@ static int smc_read(SMCKeyData *input, SMCKeyData *output) {
     kern_return_t kr = IOConnectCallStructMethod(smc_conn, 2,
         input, sizeof(SMCKeyData), output, &outsize);
 
-    if (kr != KERN_SUCCESS) return -1;
-    if (output->result == 132) return -1;  // Key not found
-    if (output->result != 0) return -1;
+    metrics_count(PCSTATS_COUNTER_SMC_CALLS, 1);
+    if (kr != KERN_SUCCESS || output->result != 0) {  // 132 = key not found
+        metrics_count(PCSTATS_COUNTER_SMC_ERRORS, 1);
+        return -1;
+    }
 
     return 0;
 }
@@ -181,6 +387,7 @@ static float smc_bytes_to_float(uint8_t *data, uint32_t size, uint32_t type) {
 
 typedef struct {
     uint32_t key_fourcc;           // Pre-computed fourcc
+    uint8_t kind;                  // PcSensorKind
     SMCKeyDataKeyInfo key_info;    // Cached key info
 } CachedSMCKey;
 
@@ -192,6 +399,27 @@ static int num_cached_gpu_keys = 0;
 static int num_cached_board_keys = 0;
 static int smc_cache_initialized = 0;
 
+// Last reading of every cached key, published for pcstats_get_sensors()
+// (CPU keys first, then GPU, then board - the order of the cache lists)
+static pthread_mutex_t smc_sensor_mutex = PTHREAD_MUTEX_INITIALIZER;
+static PcSensorReading smc_sensor_readings[PCSTATS_MAX_SENSORS];
+static int smc_sensor_count = 0;
+
+// Fan keys - the fan count and min/max RPM are static, so they are probed
+// once; each tick then only reads FxAc with its cached key_info
+typedef struct {
+    CachedSMCKey actual;           // F%dAc - current RPM
+    float min_rpm;                 // F%dMn - read once
+    float max_rpm;                 // F%dMx - read once
+} CachedFanKeys;
+
+static CachedFanKeys cached_fan_keys[MAX_FANS];
+static int num_cached_fan_keys = 0;
+
+// Probe cache (see "Probe Cache" below the IOReport types)
+static int probe_cache_restore_smc(void);
+static void probe_cache_store_smc(void);
+
 // Read a single SMC float value by key string (for non-cached reads like fans)
 static float smc_read_key(const char *key) {
     SMCKeyDataKeyInfo info;
@@ -210,7 +438,8 @@ static float smc_read_key(const char *key) {
     return smc_bytes_to_float(output.bytes, info.data_size, info.data_type);
 }
 
-// Read temperature using cached key_info (skips key_info lookup - 1 IOKit call instead of 2)
+// Read a key using cached key_info (skips key_info lookup - 1 IOKit call instead of 2).
+// Used for temperatures and fan RPM.
 static float smc_read_temp_cached(uint32_t key_fourcc, SMCKeyDataKeyInfo *info) {
     SMCKeyData input = {0};
     SMCKeyData output = {0};
@@ -224,26 +453,210 @@ static float smc_read_temp_cached(uint32_t key_fourcc, SMCKeyDataKeyInfo *info)
     return smc_bytes_to_float(output.bytes, info->data_size, info->data_type);
 }
 
-// Initialize SMC key cache - probe all possible keys once, remember valid ones
+// Probe fan keys once: fan count from FNum (or by probing F%dAc), min/max RPM
+static void smc_init_fan_cache(void) {
+    int fan_count = (int)smc_read_key("FNum");
+    if (fan_count <= 0 || fan_count > MAX_FANS) {
+        fan_count = MAX_FANS;  // FNum missing - probe until the first absent key
+    }
+
+    for (int i = 0; i < fan_count; i++) {
+        char key[5];
+        SMCKeyDataKeyInfo info;
+
+        snprintf(key, sizeof(key), "F%dAc", i);
+        if (smc_read_key_info(key, &info) != 0 || info.data_size == 0 || info.data_size > 32) {
+            break;  // No more fans
+        }
+
+        CachedFanKeys *fan = &cached_fan_keys[num_cached_fan_keys];
+        fan->actual.key_fourcc = str_to_fourcc(key);
+        fan->actual.key_info = info;
+
+        snprintf(key, sizeof(key), "F%dMn", i);
+        fan->min_rpm = smc_read_key(key);
+
+        snprintf(key, sizeof(key), "F%dMx", i);
+        fan->max_rpm = smc_read_key(key);
+
+        num_cached_fan_keys++;
+    }
+}
+
+// Check a cached key still reads (1 IOKit call) - validates restored probe results
+static int smc_key_readable(const CachedSMCKey *key) {
+    SMCKeyData input = {0};
+    SMCKeyData output = {0};
+
+    input.key = key->key_fourcc;
+    input.data8 = 5;  // Command: read bytes
+    input.key_info = key->key_info;
+
+    return smc_read(&input, &output) == 0;
+}
+
+// ============================================================================
+// Per-chip SMC sensor tables
+// ============================================================================
+
+// Temperature keys each Apple Silicon generation is known to have. Pro, Max
+// and Ultra parts have the base chip's keys plus those of their extra cores
+// (an Ultra's second die reports through the same keys), so one table per
+// generation covers the family: keys a smaller part lacks fail their key_info
+// lookup at init and are dropped, which costs one call instead of a probe
+// through every generic guess.
+typedef struct {
+    char key[5];
+    uint8_t kind;  // PcSensorKind
+} SmcSensorDef;
+
+#define SENSOR_E(k) { k, PCSTATS_SENSOR_CPU_EFFICIENCY }
+#define SENSOR_P(k) { k, PCSTATS_SENSOR_CPU_PERFORMANCE }
+#define SENSOR_G(k) { k, PCSTATS_SENSOR_GPU }
+
+static const SmcSensorDef smc_sensors_m1[] = {
+    SENSOR_E("Tp09"), SENSOR_E("Tp0T"),
+    SENSOR_P("Tp01"), SENSOR_P("Tp05"), SENSOR_P("Tp0D"), SENSOR_P("Tp0H"),
+    SENSOR_P("Tp0L"), SENSOR_P("Tp0P"), SENSOR_P("Tp0X"), SENSOR_P("Tp0b"),
+    SENSOR_G("Tg05"), SENSOR_G("Tg0D"), SENSOR_G("Tg0L"), SENSOR_G("Tg0T"),
+};
+
+static const SmcSensorDef smc_sensors_m2[] = {
+    SENSOR_E("Tp1h"), SENSOR_E("Tp1t"), SENSOR_E("Tp1p"), SENSOR_E("Tp1l"),
+    SENSOR_P("Tp01"), SENSOR_P("Tp05"), SENSOR_P("Tp09"), SENSOR_P("Tp0D"),
+    SENSOR_P("Tp0X"), SENSOR_P("Tp0b"), SENSOR_P("Tp0f"), SENSOR_P("Tp0j"),
+    SENSOR_G("Tg0f"), SENSOR_G("Tg0j"),
+};
+
+static const SmcSensorDef smc_sensors_m3[] = {
+    SENSOR_E("Te05"), SENSOR_E("Te0L"), SENSOR_E("Te0P"), SENSOR_E("Te0S"),
+    SENSOR_P("Tf04"), SENSOR_P("Tf09"), SENSOR_P("Tf0A"), SENSOR_P("Tf0B"),
+    SENSOR_P("Tf0D"), SENSOR_P("Tf0E"), SENSOR_P("Tf44"), SENSOR_P("Tf49"),
+    SENSOR_P("Tf4A"), SENSOR_P("Tf4B"), SENSOR_P("Tf4D"), SENSOR_P("Tf4E"),
+    SENSOR_G("Tf14"), SENSOR_G("Tf18"), SENSOR_G("Tf19"), SENSOR_G("Tf1A"),
+    SENSOR_G("Tf24"), SENSOR_G("Tf28"), SENSOR_G("Tf29"), SENSOR_G("Tf2A"),
+};
+
+static const SmcSensorDef smc_sensors_m4[] = {
+    SENSOR_E("Te05"), SENSOR_E("Te0S"), SENSOR_E("Te09"), SENSOR_E("Te0H"),
+    SENSOR_P("Tp01"), SENSOR_P("Tp05"), SENSOR_P("Tp09"), SENSOR_P("Tp0D"),
+    SENSOR_P("Tp0V"), SENSOR_P("Tp0Y"), SENSOR_P("Tp0b"), SENSOR_P("Tp0e"),
+    SENSOR_G("Tg0G"), SENSOR_G("Tg0H"), SENSOR_G("Tg1U"), SENSOR_G("Tg1k"),
+    SENSOR_G("Tg0K"), SENSOR_G("Tg0L"), SENSOR_G("Tg0d"), SENSOR_G("Tg0e"),
+    SENSOR_G("Tg0j"), SENSOR_G("Tg0k"),
+};
+
+#undef SENSOR_E
+#undef SENSOR_P
+#undef SENSOR_G
+
+typedef struct {
+    const char *name;              // Generation as in the brand string ("Apple M3 Pro")
+    const SmcSensorDef *sensors;
+    int count;
+} SmcChipTable;
+
+#define CHIP_TABLE(name, sensors) { name, sensors, (int)(sizeof(sensors) / sizeof(sensors[0])) }
+
+static const SmcChipTable smc_chip_tables[] = {
+    CHIP_TABLE("M1", smc_sensors_m1),
+    CHIP_TABLE("M2", smc_sensors_m2),
+    CHIP_TABLE("M3", smc_sensors_m3),
+    CHIP_TABLE("M4", smc_sensors_m4),
+};
+
+#undef CHIP_TABLE
+
+// Table the cache was built from, "generic" when probing
+static char smc_table_name[8] = "generic";
+
+// Pick the table from machdep.cpu.brand_string ("Apple M2 Max"); NULL for
+// Intel and for chips newer than the tables
+static const SmcChipTable *smc_select_chip_table(void) {
+    char brand[128] = {0};
+    size_t len = sizeof(brand) - 1;
+    if (sysctlbyname("machdep.cpu.brand_string", brand, &len, NULL, 0) != 0) return NULL;
+    if (strncmp(brand, "Apple ", 6) != 0) return NULL;
+
+    const char *chip = brand + 6;
+    for (size_t i = 0; i < sizeof(smc_chip_tables) / sizeof(smc_chip_tables[0]); i++) {
+        const SmcChipTable *table = &smc_chip_tables[i];
+        size_t n = strlen(table->name);
+        // "M1" must not match a future "M10"
+        if (strncmp(chip, table->name, n) == 0 && (chip[n] == '\0' || chip[n] == ' ')) {
+            return table;
+        }
+    }
+    return NULL;
+}
+
+// Look a key up once and append it to a cache list; 0 if the chip lacks it
+static int smc_cache_key(const char *key, uint8_t kind, CachedSMCKey *list, int *count) {
+    if (*count >= MAX_CACHED_KEYS) return 0;
+
+    SMCKeyDataKeyInfo info;
+    if (smc_read_key_info(key, &info) != 0 || info.data_size == 0) return 0;
+
+    list[*count].key_fourcc = str_to_fourcc(key);
+    list[*count].kind = kind;
+    list[*count].key_info = info;
+    (*count)++;
+    return 1;
+}
+
+// Initialize SMC key cache - look up the chip's known keys once (or probe
+// the generic lists on unknown chips), remember the valid ones
 static void smc_init_cache(void) {
     if (smc_cache_initialized) return;
     if (smc_open() != 0) return;
 
-    // All possible temperature keys to probe
-    const char *cpu_keys[] = {
-        "Tp01", "Tp02", "Tp03", "Tp04", "Tp05", "Tp06", "Tp07", "Tp08",
-        "Tp09", "Tp0A", "Tp0B", "Tp0C", "Tp0D", "Tp0E", "Tp0F", "Tp0G",
-        "Te01", "Te02", "Te03", "Te04", "Te05", "Te06", "Te07", "Te08",
-        "Tc0c", "Tc1c", "Tc2c", "Tc3c",
-        NULL
-    };
+    // Same model and OS as last launch: reuse its key list
+    if (probe_cache_restore_smc()) {
+        smc_cache_initialized = 1;
+        return;
+    }
 
-    const char *gpu_keys[] = {
-        "Tg0f", "Tg0j", "Tg0D", "Tg0d", "Tg05", "Tg0P", "Tg0p",
-        NULL
-    };
+    const SmcChipTable *table = smc_select_chip_table();
+    if (table) {
+        for (int i = 0; i < table->count; i++) {
+            const SmcSensorDef *def = &table->sensors[i];
+            if (def->kind == PCSTATS_SENSOR_GPU) {
+                smc_cache_key(def->key, def->kind, cached_gpu_keys, &num_cached_gpu_keys);
+            } else {
+                smc_cache_key(def->key, def->kind, cached_cpu_keys, &num_cached_cpu_keys);
+            }
+        }
+    }
+
+    if (num_cached_cpu_keys > 0 || num_cached_gpu_keys > 0) {
+        snprintf(smc_table_name, sizeof(smc_table_name), "%s", table->name);
+    } else {
+        // Unknown chip, or none of its table's keys exist: probe generic guesses
+        const char *cpu_keys[] = {
+            "Tp01", "Tp02", "Tp03", "Tp04", "Tp05", "Tp06", "Tp07", "Tp08",
+            "Tp09", "Tp0A", "Tp0B", "Tp0C", "Tp0D", "Tp0E", "Tp0F", "Tp0G",
+            "Te01", "Te02", "Te03", "Te04", "Te05", "Te06", "Te07", "Te08",
+            "Tc0c", "Tc1c", "Tc2c", "Tc3c",
+            NULL
+        };
+
+        const char *gpu_keys[] = {
+            "Tg0f", "Tg0j", "Tg0D", "Tg0d", "Tg05", "Tg0P", "Tg0p",
+            NULL
+        };
+
+        for (int i = 0; cpu_keys[i]; i++) {
+            // Te* are E-cluster sensors; Tp*/Tc* can't be told apart
+            uint8_t kind = cpu_keys[i][1] == 'e' ? PCSTATS_SENSOR_CPU_EFFICIENCY
+                                                 : PCSTATS_SENSOR_CPU_PERFORMANCE;
+            smc_cache_key(cpu_keys[i], kind, cached_cpu_keys, &num_cached_cpu_keys);
+        }
+        for (int i = 0; gpu_keys[i]; i++) {
+            smc_cache_key(gpu_keys[i], PCSTATS_SENSOR_GPU, cached_gpu_keys, &num_cached_gpu_keys);
+        }
+    }
 
-    // Motherboard/PCH/system temperature keys
+    // Motherboard/PCH/system temperature keys, the same on every chip
     const char *board_keys[] = {
         "Tm0P", "Tm1P", "Tm2P",  // PCH (Platform Controller Hub)
         "Ts0P", "Ts1P", "Ts2P",  // System/case sensors
@@ -251,38 +664,51 @@ static void smc_init_cache(void) {
         "Tw0P",                   // Wireless module (often on board)
         NULL
     };
-
-    // Probe CPU keys
-    for (int i = 0; cpu_keys[i] && num_cached_cpu_keys < MAX_CACHED_KEYS; i++) {
-        SMCKeyDataKeyInfo info;
-        if (smc_read_key_info(cpu_keys[i], &info) == 0 && info.data_size > 0) {
-            cached_cpu_keys[num_cached_cpu_keys].key_fourcc = str_to_fourcc(cpu_keys[i]);
-            cached_cpu_keys[num_cached_cpu_keys].key_info = info;
-            num_cached_cpu_keys++;
-        }
+    for (int i = 0; board_keys[i]; i++) {
+        smc_cache_key(board_keys[i], PCSTATS_SENSOR_BOARD, cached_board_keys, &num_cached_board_keys);
     }
 
-    // Probe GPU keys
-    for (int i = 0; gpu_keys[i] && num_cached_gpu_keys < MAX_CACHED_KEYS; i++) {
-        SMCKeyDataKeyInfo info;
-        if (smc_read_key_info(gpu_keys[i], &info) == 0 && info.data_size > 0) {
-            cached_gpu_keys[num_cached_gpu_keys].key_fourcc = str_to_fourcc(gpu_keys[i]);
-            cached_gpu_keys[num_cached_gpu_keys].key_info = info;
-            num_cached_gpu_keys++;
-        }
+    smc_init_fan_cache();
+
+    probe_cache_store_smc();
+    smc_cache_initialized = 1;
+}
+
+// Publish one list's readings at its slot in smc_sensor_readings (CPU, GPU, board)
+static void smc_publish_readings(const CachedSMCKey *keys, int count, const float *values, int offset) {
+    pthread_mutex_lock(&smc_sensor_mutex);
+    for (int i = 0; i < count && offset + i < PCSTATS_MAX_SENSORS; i++) {
+        PcSensorReading *reading = &smc_sensor_readings[offset + i];
+        uint32_t key = keys[i].key_fourcc;
+        reading->key[0] = (char)(key >> 24);
+        reading->key[1] = (char)(key >> 16);
+        reading->key[2] = (char)(key >> 8);
+        reading->key[3] = (char)key;
+        reading->key[4] = '\0';
+        reading->kind = keys[i].kind;
+        reading->celsius = values[i];
+    }
+    if (offset + count > smc_sensor_count) {
+        smc_sensor_count = offset + count < PCSTATS_MAX_SENSORS ? offset + count : PCSTATS_MAX_SENSORS;
     }
+    pthread_mutex_unlock(&smc_sensor_mutex);
+}
 
-    // Probe motherboard/system keys
-    for (int i = 0; board_keys[i] && num_cached_board_keys < MAX_CACHED_KEYS; i++) {
-        SMCKeyDataKeyInfo info;
-        if (smc_read_key_info(board_keys[i], &info) == 0 && info.data_size > 0) {
-            cached_board_keys[num_cached_board_keys].key_fourcc = str_to_fourcc(board_keys[i]);
-            cached_board_keys[num_cached_board_keys].key_info = info;
-            num_cached_board_keys++;
-        }
+int pcstats_get_sensors(PcSensorReading *out, int max) {
+    if (!out || max <= 0) return 0;
+
+    // Slots of a list that hasn't been read yet (board temps only, say) are empty
+    int count = 0;
+    pthread_mutex_lock(&smc_sensor_mutex);
+    for (int i = 0; i < smc_sensor_count && count < max; i++) {
+        if (smc_sensor_readings[i].key[0]) out[count++] = smc_sensor_readings[i];
     }
+    pthread_mutex_unlock(&smc_sensor_mutex);
+    return count;
+}
 
-    smc_cache_initialized = 1;
+const char *pcstats_sensor_table(void) {
+    return smc_table_name;
 }
 
 // Get temperatures from SMC using cached keys (optimized)
@@ -297,14 +723,19 @@ static void smc_get_temperatures(float *cpu_temp, float *gpu_temp) {
 
     if (!smc_conn) return;
 
+    uint64_t started = metrics_start();
+
     float cpu_sum = 0, gpu_sum = 0;
     int cpu_count = 0, gpu_count = 0;
+    float cpu_values[MAX_CACHED_KEYS] = {0};
+    float gpu_values[MAX_CACHED_KEYS] = {0};
 
     // Read only cached (valid) CPU keys - 1 IOKit call each
     for (int i = 0; i < num_cached_cpu_keys; i++) {
         float t = smc_read_temp_cached(cached_cpu_keys[i].key_fourcc,
                                         &cached_cpu_keys[i].key_info);
         if (t > 10 && t < 130) {
+            cpu_values[i] = t;
             cpu_sum += t;
             cpu_count++;
         }
@@ -315,6 +746,7 @@ static void smc_get_temperatures(float *cpu_temp, float *gpu_temp) {
         float t = smc_read_temp_cached(cached_gpu_keys[i].key_fourcc,
                                         &cached_gpu_keys[i].key_info);
         if (t > 10 && t < 130) {
+            gpu_values[i] = t;
             gpu_sum += t;
             gpu_count++;
         }
@@ -322,6 +754,9 @@ static void smc_get_temperatures(float *cpu_temp, float *gpu_temp) {
 
     if (cpu_count > 0) *cpu_temp = cpu_sum / cpu_count;
     if (gpu_count > 0) *gpu_temp = gpu_sum / gpu_count;
+    smc_publish_readings(cached_cpu_keys, num_cached_cpu_keys, cpu_values, 0);
+    smc_publish_readings(cached_gpu_keys, num_cached_gpu_keys, gpu_values, num_cached_cpu_keys);
+    metrics_stop(PCSTATS_TIMER_SMC_TEMPS, started);
 }
 
 // Get motherboard/system temperature from SMC
@@ -333,22 +768,28 @@ static float smc_get_board_temperature(void) {
 
     if (!smc_conn || num_cached_board_keys == 0) return 0.0f;
 
+    uint64_t started = metrics_start();
     float board_sum = 0;
     int board_count = 0;
+    float board_values[MAX_CACHED_KEYS] = {0};
 
     for (int i = 0; i < num_cached_board_keys; i++) {
         float t = smc_read_temp_cached(cached_board_keys[i].key_fourcc,
                                         &cached_board_keys[i].key_info);
         if (t > 10 && t < 100) {  // Board temps typically lower than CPU/GPU
+            board_values[i] = t;
             board_sum += t;
             board_count++;
         }
     }
+    smc_publish_readings(cached_board_keys, num_cached_board_keys, board_values,
+                         num_cached_cpu_keys + num_cached_gpu_keys);
+    metrics_stop(PCSTATS_TIMER_BOARD_TEMP, started);
 
     return (board_count > 0) ? board_sum / board_count : 0.0f;
 }
 
-// Get fan RPM info from SMC
+// Get fan RPM info from SMC using cached fan keys (1 IOKit call per fan)
 void get_fan_info(FanInfo *fans) {
     fans->count = 0;
     for (int i = 0; i < MAX_FANS; i++) {
@@ -357,32 +798,22 @@ void get_fan_info(FanInfo *fans) {
         fans->max_rpm[i] = 0;
     }
 
-    if (smc_open() != 0) return;
-
-    // Fan keys: F0Ac (actual), F0Mn (min), F0Mx (max)
-    for (int i = 0; i < MAX_FANS; i++) {
-        char key[5];
-
-        // Read actual RPM (F0Ac, F1Ac, etc.)
-        snprintf(key, sizeof(key), "F%dAc", i);
-        float rpm = smc_read_key(key);
-
-        if (rpm > 0) {
-            fans->rpm[i] = rpm;
-
-            // Read min RPM
-            snprintf(key, sizeof(key), "F%dMn", i);
-            fans->min_rpm[i] = smc_read_key(key);
+    // Initialize cache on first call
+    if (!smc_cache_initialized) {
+        smc_init_cache();
+    }
 
-            // Read max RPM
-            snprintf(key, sizeof(key), "F%dMx", i);
-            fans->max_rpm[i] = smc_read_key(key);
+    if (!smc_conn) return;
 
-            fans->count = i + 1;
-        } else {
-            break;  // No more fans
-        }
+    uint64_t started = metrics_start();
+    for (int i = 0; i < num_cached_fan_keys; i++) {
+        CachedFanKeys *fan = &cached_fan_keys[i];
+        fans->rpm[i] = smc_read_temp_cached(fan->actual.key_fourcc, &fan->actual.key_info);
+        fans->min_rpm[i] = fan->min_rpm;
+        fans->max_rpm[i] = fan->max_rpm;
     }
+    fans->count = num_cached_fan_keys;
+    metrics_stop(PCSTATS_TIMER_FANS, started);
 }
 
 // ============================================================================
@@ -402,12 +833,52 @@ extern CFTypeRef IOHIDServiceClientCopyProperty(IOHIDServiceClientRef, CFStringR
 extern IOHIDEventRef IOHIDServiceClientCopyEvent(IOHIDServiceClientRef, int64_t, int32_t, int64_t);
 extern double IOHIDEventGetFloatValue(IOHIDEventRef, int32_t);
 
-static void hid_get_temperatures(float *cpu_temp, float *gpu_temp) {
-    *cpu_temp = 0.0f;
-    *gpu_temp = 0.0f;
+// Service add/remove notifications (private, resolved at runtime so a
+// missing symbol only disables notifications instead of failing to load)
+typedef void (*IOHIDServiceClientCallback)(void *target, void *refcon, IOHIDServiceClientRef service);
+typedef void (*IOHIDEventSystemClientScheduleWithDispatchQueue_t)(IOHIDEventSystemClientRef, dispatch_queue_t);
+typedef void (*IOHIDEventSystemClientRegisterDeviceMatchingCallback_t)(IOHIDEventSystemClientRef,
+    IOHIDServiceClientCallback, void *, void *);
+typedef void (*IOHIDServiceClientRegisterRemovalCallback_t)(IOHIDServiceClientRef,
+    IOHIDServiceClientCallback, void *, void *);
 
-    IOHIDEventSystemClientRef client = IOHIDEventSystemClientCreate(kCFAllocatorDefault);
-    if (!client) return;
+static IOHIDServiceClientRegisterRemovalCallback_t pIOHIDServiceClientRegisterRemovalCallback = NULL;
+
+// Without notifications, re-copy the service list every this many samples
+#define HID_RESCAN_SAMPLES 100
+#define MAX_HID_SENSORS 64
+
+// Sensor classification, decided once per service when the list is built
+typedef enum {
+    HID_SENSOR_CPU = 0,
+    HID_SENSOR_GPU = 1
+} HidSensorKind;
+
+typedef struct {
+    IOHIDServiceClientRef service;  // Borrowed from hid_services
+    uint8_t kind;
+} HidSensor;
+
+// Persistent client and service list (created once, rebuilt on add/remove)
+static IOHIDEventSystemClientRef hid_client = NULL;
+static CFArrayRef hid_services = NULL;
+static HidSensor hid_sensors[MAX_HID_SENSORS];
+static int num_hid_sensors = 0;
+static _Atomic int hid_services_dirty = 1;
+static int hid_notifications = 0;
+static int hid_samples_since_scan = 0;
+
+// Runs on the HID dispatch queue when a service appears or disappears
+static void hid_service_changed(void *target, void *refcon, IOHIDServiceClientRef service) {
+    (void)target; (void)refcon; (void)service;
+    atomic_store(&hid_services_dirty, 1);
+}
+
+static int hid_client_init(void) {
+    if (hid_client) return 0;
+
+    hid_client = IOHIDEventSystemClientCreate(kCFAllocatorDefault);
+    if (!hid_client) return -1;
 
     // Create matching dictionary for temperature sensors
     CFNumberRef page = CFNumberCreate(kCFAllocatorDefault, kCFNumberIntType,
@@ -422,23 +893,50 @@ static void hid_get_temperatures(float *cpu_temp, float *gpu_temp) {
         (const void **)keys, (const void **)vals, 2,
         &kCFTypeDictionaryKeyCallBacks, &kCFTypeDictionaryValueCallBacks);
 
-    IOHIDEventSystemClientSetMatching(client, match);
+    IOHIDEventSystemClientSetMatching(hid_client, match);
     CFRelease(match);
     CFRelease(page);
     CFRelease(usage);
 
-    CFArrayRef services = IOHIDEventSystemClientCopyServices(client);
-    if (!services) {
-        CFRelease(client);
-        return;
+    // Register for service add/remove so the list is only rebuilt on change
+    IOHIDEventSystemClientScheduleWithDispatchQueue_t schedule =
+        (IOHIDEventSystemClientScheduleWithDispatchQueue_t)dlsym(RTLD_DEFAULT,
+            "IOHIDEventSystemClientScheduleWithDispatchQueue");
+    IOHIDEventSystemClientRegisterDeviceMatchingCallback_t register_matching =
+        (IOHIDEventSystemClientRegisterDeviceMatchingCallback_t)dlsym(RTLD_DEFAULT,
+            "IOHIDEventSystemClientRegisterDeviceMatchingCallback");
+    pIOHIDServiceClientRegisterRemovalCallback =
+        (IOHIDServiceClientRegisterRemovalCallback_t)dlsym(RTLD_DEFAULT,
+            "IOHIDServiceClientRegisterRemovalCallback");
+
+    if (schedule && register_matching && pIOHIDServiceClientRegisterRemovalCallback) {
+        dispatch_queue_t queue = dispatch_queue_create("pcstats.hid", DISPATCH_QUEUE_SERIAL);
+        register_matching(hid_client, hid_service_changed, NULL, NULL);
+        schedule(hid_client, queue);
+        hid_notifications = 1;
     }
 
-    float cpu_sum = 0, gpu_sum = 0;
-    int cpu_count = 0, gpu_count = 0;
+    atomic_store(&hid_services_dirty, 1);
+    return 0;
+}
+
+// Copy the service list and classify each sensor once (CPU/GPU/ignored)
+static void hid_rebuild_sensors(void) {
+    atomic_store(&hid_services_dirty, 0);
+    hid_samples_since_scan = 0;
+
+    if (hid_services) {
+        CFRelease(hid_services);
+        hid_services = NULL;
+    }
+    num_hid_sensors = 0;
+
+    hid_services = IOHIDEventSystemClientCopyServices(hid_client);
+    if (!hid_services) return;
 
-    CFIndex count = CFArrayGetCount(services);
-    for (CFIndex i = 0; i < count; i++) {
-        IOHIDServiceClientRef service = (IOHIDServiceClientRef)CFArrayGetValueAtIndex(services, i);
+    CFIndex count = CFArrayGetCount(hid_services);
+    for (CFIndex i = 0; i < count && num_hid_sensors < MAX_HID_SENSORS; i++) {
+        IOHIDServiceClientRef service = (IOHIDServiceClientRef)CFArrayGetValueAtIndex(hid_services, i);
 
         CFStringRef product = IOHIDServiceClientCopyProperty(service, CFSTR("Product"));
         if (!product) continue;
@@ -447,9 +945,54 @@ static void hid_get_temperatures(float *cpu_temp, float *gpu_temp) {
         CFStringGetCString(product, name, sizeof(name), kCFStringEncodingUTF8);
         CFRelease(product);
 
-        IOHIDEventRef event = IOHIDServiceClientCopyEvent(service,
+        // Match sensor names (M1 chips)
+        // CPU: pACC MTR Temp Sensor*, eACC MTR Temp Sensor*
+        // GPU: GPU MTR Temp Sensor*
+        int kind;
+        if (strstr(name, "ACC MTR Temp") || strstr(name, "CPU")) {
+            kind = HID_SENSOR_CPU;
+        } else if (strstr(name, "GPU MTR Temp") || strstr(name, "GPU")) {
+            kind = HID_SENSOR_GPU;
+        } else {
+            continue;  // Not a sensor we report
+        }
+
+        if (hid_notifications) {
+            pIOHIDServiceClientRegisterRemovalCallback(service, hid_service_changed, NULL, NULL);
+        }
+
+        hid_sensors[num_hid_sensors].service = service;
+        hid_sensors[num_hid_sensors].kind = (uint8_t)kind;
+        num_hid_sensors++;
+    }
+}
+
+static void hid_get_temperatures(float *cpu_temp, float *gpu_temp) {
+    *cpu_temp = 0.0f;
+    *gpu_temp = 0.0f;
+
+    if (hid_client_init() != 0) return;
+
+    uint64_t started = metrics_start();
+    if (!hid_notifications && ++hid_samples_since_scan >= HID_RESCAN_SAMPLES) {
+        atomic_store(&hid_services_dirty, 1);
+    }
+    if (atomic_load(&hid_services_dirty)) {
+        hid_rebuild_sensors();
+    }
+
+    float sum[2] = {0, 0};
+    int count[2] = {0, 0};
+
+    // Steady state: one IOHIDServiceClientCopyEvent per classified sensor
+    for (int i = 0; i < num_hid_sensors; i++) {
+        IOHIDEventRef event = IOHIDServiceClientCopyEvent(hid_sensors[i].service,
             kIOHIDEventTypeTemperature, 0, 0);
-        if (!event) continue;
+        metrics_count(PCSTATS_COUNTER_HID_CALLS, 1);
+        if (!event) {
+            metrics_count(PCSTATS_COUNTER_HID_ERRORS, 1);
+            continue;
+        }
 
         float temp = (float)IOHIDEventGetFloatValue(event,
             kIOHIDEventTypeTemperature << 16);
@@ -457,23 +1000,13 @@ static void hid_get_temperatures(float *cpu_temp, float *gpu_temp) {
 
         if (temp < 10 || temp > 130) continue;
 
-        // Match sensor names (M1 chips)
-        // CPU: pACC MTR Temp Sensor*, eACC MTR Temp Sensor*
-        // GPU: GPU MTR Temp Sensor*
-        if (strstr(name, "ACC MTR Temp") || strstr(name, "CPU")) {
-            cpu_sum += temp;
-            cpu_count++;
-        } else if (strstr(name, "GPU MTR Temp") || strstr(name, "GPU")) {
-            gpu_sum += temp;
-            gpu_count++;
-        }
+        sum[hid_sensors[i].kind] += temp;
+        count[hid_sensors[i].kind]++;
     }
 
-    CFRelease(services);
-    CFRelease(client);
-
-    if (cpu_count > 0) *cpu_temp = cpu_sum / cpu_count;
-    if (gpu_count > 0) *gpu_temp = gpu_sum / gpu_count;
+    if (count[HID_SENSOR_CPU] > 0) *cpu_temp = sum[HID_SENSOR_CPU] / count[HID_SENSOR_CPU];
+    if (count[HID_SENSOR_GPU] > 0) *gpu_temp = sum[HID_SENSOR_GPU] / count[HID_SENSOR_GPU];
+    metrics_stop(PCSTATS_TIMER_HID_TEMPS, started);
 }
 
 // ============================================================================
@@ -495,8 +1028,6 @@ static void get_apple_silicon_temps(float *cpu_temp, float *gpu_temp) {
 // Private API - loaded dynamically from IOReport.framework
 // ============================================================================
 
-#include <dlfcn.h>
-
 // IOReport opaque types
 typedef struct __IOReportSubscription *IOReportSubscriptionRef;
 
@@ -579,10 +1110,47 @@ static float cached_gpu_power = 0.0f;   // Watts
 static float cached_gpu_freq = 0.0f;    // MHz
 static float cached_gpu_load = 0.0f;    // Percent
 
-// GPU frequency table (will be populated from pmgr)
+// Cached per-cluster CPU frequency/residency (from "CPU Stats")
+static int cached_cluster_count = 0;
+static char cached_cluster_name[PCSTATS_MAX_CLUSTERS][16];
+static float cached_cluster_freq[PCSTATS_MAX_CLUSTERS];    // MHz
+static float cached_cluster_load[PCSTATS_MAX_CLUSTERS];    // Percent
+
+// Channel classification, resolved once from channel names so each sample
+// is indexed integer math instead of CFString conversions and strcmp chains
+#define MAX_IOR_CHANNELS 256
+
+typedef enum {
+    IOR_CH_IGNORE = 0,
+    IOR_CH_CPU_ENERGY,       // "CPU Energy" / "DIE_*_CPU Energy"
+    IOR_CH_GPU_ENERGY,       // "GPU Energy" / "DIE_*_GPU Energy"
+    IOR_CH_GPU_PSTATES,      // GPU Stats / GPUPH residencies
+    IOR_CH_CPU_PSTATES       // CPU Stats / ECPU, PCPU, PCPU1... cluster residencies
+} IorChannelKind;
+
+typedef struct {
+    uint8_t kind;
+    int8_t cluster;          // Cluster index for IOR_CH_CPU_PSTATES
+    int16_t state_offset;    // First active P-state, -1 = not resolved yet
+    int8_t die;              // Ultra "DIE_<n>_" prefix, -1 = chip-wide channel
+    double joules_per_unit;  // Energy unit scale (nJ/uJ/mJ), 0 = unknown unit
+} IorChannel;
+
+static IorChannel ior_channel_table[MAX_IOR_CHANNELS];
+static CFIndex ior_classified_count = -1;   // Channel count the table was built for
+
+// P-state frequency tables (will be populated from pmgr)
 #define MAX_GPU_FREQS 32
-static uint32_t gpu_freqs[MAX_GPU_FREQS];
-static int num_gpu_freqs = 0;
+
+typedef struct {
+    uint32_t mhz[MAX_GPU_FREQS];
+    int count;
+} FreqTable;
+
+static FreqTable gpu_freq_table;
+static FreqTable ecpu_freq_table;
+static FreqTable pcpu_freq_table;
+static int freq_tables_loaded = 0;
 
 // Get current time in milliseconds
 static uint64_t get_time_ms(void) {
@@ -597,145 +1165,533 @@ static int cfstring_to_cstr(CFStringRef str, char *buf, size_t bufsize) {
     return CFStringGetCString(str, buf, bufsize, kCFStringEncodingUTF8);
 }
 
-// Get GPU frequencies from pmgr IOKit device
-static void ior_load_gpu_freqs(void) {
-    if (num_gpu_freqs > 0) return;  // Already loaded
+// ============================================================================
+// Probe Cache - SMC keys, pmgr frequency tables and IOReport channel
+// classification persisted per machine model and OS build, so later launches
+// restore them and only validate instead of probing
+// ============================================================================
 
-    io_iterator_t iter;
-    kern_return_t kr = IOServiceGetMatchingServices(kIOMainPortDefault,
-        IOServiceMatching("AppleARMIODevice"), &iter);
-    if (kr != KERN_SUCCESS) return;
+#define PROBE_CACHE_MAGIC   0x50435043  // "PCPC"
+#define PROBE_CACHE_VERSION 2
 
-    io_object_t device;
-    while ((device = IOIteratorNext(iter)) != 0) {
-        char name[128] = {0};
-        IORegistryEntryGetName(device, name);
+enum {
+    PROBE_SECTION_SMC   = 1 << 0,
+    PROBE_SECTION_FREQS = 1 << 1,
+    PROBE_SECTION_IOR   = 1 << 2,
+};
 
-        if (strcmp(name, "pmgr") == 0) {
-            CFMutableDictionaryRef props = NULL;
-            if (IORegistryEntryCreateCFProperties(device, &props,
-                    kCFAllocatorDefault, 0) == KERN_SUCCESS && props) {
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;      // sizeof(ProbeCache) - catches layout changes between builds
+    uint32_t sections;  // PROBE_SECTION_* present
+    char model[64];     // hw.model
+    char os_build[32];  // kern.osversion
+
+    // SMC
+    int32_t num_cpu_keys;
+    int32_t num_gpu_keys;
+    int32_t num_board_keys;
+    int32_t num_fan_keys;
+    char sensor_table[8];   // smc_table_name the keys came from
+    CachedSMCKey cpu_keys[MAX_CACHED_KEYS];
+    CachedSMCKey gpu_keys[MAX_CACHED_KEYS];
+    CachedSMCKey board_keys[MAX_CACHED_KEYS];
+    CachedFanKeys fan_keys[MAX_FANS];
+
+    // pmgr voltage-states
+    FreqTable gpu_freqs;
+    FreqTable ecpu_freqs;
+    FreqTable pcpu_freqs;
+
+    // IOReport
+    int32_t channel_count;
+    int32_t cluster_count;
+    IorChannel channels[MAX_IOR_CHANNELS];
+    uint32_t channel_hash[MAX_IOR_CHANNELS];  // group/name hash of classified channels
+    char cluster_name[PCSTATS_MAX_CLUSTERS][16];
+} ProbeCache;
+
+static pthread_mutex_t probe_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static char probe_cache_path[1024] = {0};
+static ProbeCache probe_cache;
+static int probe_cache_loaded = 0;
+
+int pcstats_set_probe_cache_path(const char *path) {
+    if (!path || strlen(path) >= sizeof(probe_cache_path)) return -1;
+
+    pthread_mutex_lock(&probe_cache_mutex);
+    snprintf(probe_cache_path, sizeof(probe_cache_path), "%s", path);
+    probe_cache_loaded = 0;
+    pthread_mutex_unlock(&probe_cache_mutex);
+    return 0;
+}
 
-                // Get voltage-states9 (GPU frequencies)
-                CFDataRef data = CFDictionaryGetValue(props, CFSTR("voltage-states9"));
-                if (data) {
-                    CFIndex len = CFDataGetLength(data);
-                    const uint8_t *bytes = CFDataGetBytePtr(data);
-
-                    // Data is pairs of (freq_hz, voltage) - 4 bytes each
-                    int count = (int)(len / 8);
-                    for (int i = 0; i < count && num_gpu_freqs < MAX_GPU_FREQS; i++) {
-                        uint32_t freq_hz = bytes[i*8] | (bytes[i*8+1] << 8) |
-                                          (bytes[i*8+2] << 16) | (bytes[i*8+3] << 24);
-                        uint32_t freq_mhz = freq_hz / 1000000;
-                        if (freq_mhz > 0) {
-                            gpu_freqs[num_gpu_freqs++] = freq_mhz;
-                        }
-                    }
-                }
-                CFRelease(props);
-            }
-        }
-        IOObjectRelease(device);
-    }
-    IOObjectRelease(iter);
+// Identity the cache is keyed by
+static void probe_cache_identity(char *model, size_t model_len, char *os_build, size_t os_len) {
+    memset(model, 0, model_len);
+    memset(os_build, 0, os_len);
+    size_t len = model_len - 1;
+    sysctlbyname("hw.model", model, &len, NULL, 0);
+    len = os_len - 1;
+    sysctlbyname("kern.osversion", os_build, &len, NULL, 0);
 }
 
-// Initialize IOReport subscription
-static int ior_init(void) {
-    if (ior_initialized) return 0;
+// Load the file once (mutex held). A cache for another model, OS build or
+// layout is discarded and starts over empty.
+static void probe_cache_load(void) {
+    if (probe_cache_loaded) return;
+    probe_cache_loaded = 1;
+
+    char model[sizeof(probe_cache.model)];
+    char os_build[sizeof(probe_cache.os_build)];
+    probe_cache_identity(model, sizeof(model), os_build, sizeof(os_build));
+
+    ProbeCache file;
+    int valid = 0;
+    FILE *fp = probe_cache_path[0] ? fopen(probe_cache_path, "rb") : NULL;
+    if (fp) {
+        valid = fread(&file, sizeof(file), 1, fp) == 1 &&
+                file.magic == PROBE_CACHE_MAGIC &&
+                file.version == PROBE_CACHE_VERSION &&
+                file.size == sizeof(ProbeCache) &&
+                strncmp(file.model, model, sizeof(model)) == 0 &&
+                strncmp(file.os_build, os_build, sizeof(os_build)) == 0;
+        fclose(fp);
+    }
 
-    // Load IOReport framework
-    if (ior_load_framework() != 0) {
-        return -1;
+    if (valid) {
+        probe_cache = file;
+    } else {
+        memset(&probe_cache, 0, sizeof(probe_cache));
+        probe_cache.magic = PROBE_CACHE_MAGIC;
+        probe_cache.version = PROBE_CACHE_VERSION;
+        probe_cache.size = sizeof(ProbeCache);
+        memcpy(probe_cache.model, model, sizeof(model));
+        memcpy(probe_cache.os_build, os_build, sizeof(os_build));
     }
+}
 
-    // Get channels for Energy Model (power) and GPU Stats (frequency)
-    CFDictionaryRef energy_ch = pIOReportCopyChannelsInGroup(CFSTR("Energy Model"), NULL, 0, 0, 0);
-    CFDictionaryRef gpu_ch = pIOReportCopyChannelsInGroup(CFSTR("GPU Stats"),
-                                                          CFSTR("GPU Performance States"), 0, 0, 0);
+// Write the cache atomically (mutex held)
+static void probe_cache_save(void) {
+    if (!probe_cache_path[0]) return;
 
-    if (!energy_ch && !gpu_ch) {
-        return -1;  // No channels available
-    }
+    char tmp_path[sizeof(probe_cache_path) + 8];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", probe_cache_path);
 
-    // Merge channels
-    if (energy_ch && gpu_ch) {
-        if (pIOReportMergeChannels) pIOReportMergeChannels(energy_ch, gpu_ch, NULL);
-        CFRelease(gpu_ch);
-        ior_channels = CFDictionaryCreateMutableCopy(kCFAllocatorDefault,
-                                                      CFDictionaryGetCount(energy_ch), energy_ch);
-        CFRelease(energy_ch);
-    } else if (energy_ch) {
-        ior_channels = CFDictionaryCreateMutableCopy(kCFAllocatorDefault,
-                                                      CFDictionaryGetCount(energy_ch), energy_ch);
-        CFRelease(energy_ch);
+    FILE *fp = fopen(tmp_path, "wb");
+    if (!fp) return;
+    int ok = fwrite(&probe_cache, sizeof(probe_cache), 1, fp) == 1;
+    ok = (fclose(fp) == 0) && ok;
+    if (ok) {
+        rename(tmp_path, probe_cache_path);
     } else {
-        ior_channels = CFDictionaryCreateMutableCopy(kCFAllocatorDefault,
-                                                      CFDictionaryGetCount(gpu_ch), gpu_ch);
-        CFRelease(gpu_ch);
+        unlink(tmp_path);
     }
+}
 
-    if (!ior_channels) return -1;
-
-    // Create subscription
-    CFMutableDictionaryRef result = NULL;
-    ior_subscription = pIOReportCreateSubscription(NULL, ior_channels, &result, 0, NULL);
-    if (!ior_subscription) {
-        CFRelease(ior_channels);
-        ior_channels = NULL;
-        return -1;
-    }
+// Look up a cached section (mutex held); 0 if it has to be probed
+static int probe_cache_has(uint32_t section) {
+    if (!probe_cache_path[0]) return 0;
+    probe_cache_load();
+    return (probe_cache.sections & section) != 0;
+}
 
-    // Load GPU frequencies
-    ior_load_gpu_freqs();
+// Drop a section whose restored contents failed validation (mutex held)
+static void probe_cache_invalidate(uint32_t section) {
+    probe_cache.sections &= ~section;
+    probe_cache_save();
+}
 
-    ior_initialized = 1;
-    return 0;
+static int probe_cache_restore_smc(void) {
+    pthread_mutex_lock(&probe_cache_mutex);
+    int restored = 0;
+    if (probe_cache_has(PROBE_SECTION_SMC)) {
+        const ProbeCache *c = &probe_cache;
+        restored = c->num_cpu_keys >= 0 && c->num_cpu_keys <= MAX_CACHED_KEYS &&
+                   c->num_gpu_keys >= 0 && c->num_gpu_keys <= MAX_CACHED_KEYS &&
+                   c->num_board_keys >= 0 && c->num_board_keys <= MAX_CACHED_KEYS &&
+                   c->num_fan_keys >= 0 && c->num_fan_keys <= MAX_FANS;
+
+        // Every remembered key must still read
+        for (int i = 0; restored && i < c->num_cpu_keys; i++) restored = smc_key_readable(&c->cpu_keys[i]);
+        for (int i = 0; restored && i < c->num_gpu_keys; i++) restored = smc_key_readable(&c->gpu_keys[i]);
+        for (int i = 0; restored && i < c->num_board_keys; i++) restored = smc_key_readable(&c->board_keys[i]);
+        for (int i = 0; restored && i < c->num_fan_keys; i++) restored = smc_key_readable(&c->fan_keys[i].actual);
+
+        if (restored) {
+            memcpy(cached_cpu_keys, c->cpu_keys, sizeof(cached_cpu_keys));
+            memcpy(cached_gpu_keys, c->gpu_keys, sizeof(cached_gpu_keys));
+            memcpy(cached_board_keys, c->board_keys, sizeof(cached_board_keys));
+            memcpy(cached_fan_keys, c->fan_keys, sizeof(cached_fan_keys));
+            num_cached_cpu_keys = c->num_cpu_keys;
+            num_cached_gpu_keys = c->num_gpu_keys;
+            num_cached_board_keys = c->num_board_keys;
+            num_cached_fan_keys = c->num_fan_keys;
+            memcpy(smc_table_name, c->sensor_table, sizeof(smc_table_name));
+            smc_table_name[sizeof(smc_table_name) - 1] = '\0';
+        } else {
+            probe_cache_invalidate(PROBE_SECTION_SMC);
+        }
+    }
+    pthread_mutex_unlock(&probe_cache_mutex);
+    return restored;
 }
 
-// Convert energy to power (watts)
-// energy_val is in nJ, uJ, or mJ depending on unit
-static float energy_to_watts(int64_t energy_val, const char *unit, uint64_t duration_ms) {
-    if (duration_ms == 0) return 0.0f;
+static void probe_cache_store_smc(void) {
+    pthread_mutex_lock(&probe_cache_mutex);
+    if (probe_cache_path[0]) {
+        probe_cache_load();
+        ProbeCache *c = &probe_cache;
+        memcpy(c->cpu_keys, cached_cpu_keys, sizeof(c->cpu_keys));
+        memcpy(c->gpu_keys, cached_gpu_keys, sizeof(c->gpu_keys));
+        memcpy(c->board_keys, cached_board_keys, sizeof(c->board_keys));
+        memcpy(c->fan_keys, cached_fan_keys, sizeof(c->fan_keys));
+        c->num_cpu_keys = num_cached_cpu_keys;
+        c->num_gpu_keys = num_cached_gpu_keys;
+        c->num_board_keys = num_cached_board_keys;
+        c->num_fan_keys = num_cached_fan_keys;
+        memcpy(c->sensor_table, smc_table_name, sizeof(c->sensor_table));
+        c->sections |= PROBE_SECTION_SMC;
+        probe_cache_save();
+    }
+    pthread_mutex_unlock(&probe_cache_mutex);
+}
 
-    double joules_per_sec = (double)energy_val / (duration_ms / 1000.0);
+// Frequency tables are static per model/OS build (the cache is keyed on
+// both), so only the table sizes are checked: each count must fit the table.
+// A file with a bad count is dropped and the tables are probed again.
+static int probe_cache_restore_freqs(void) {
+    pthread_mutex_lock(&probe_cache_mutex);
+    int restored = 0;
+    if (probe_cache_has(PROBE_SECTION_FREQS)) {
+        const ProbeCache *c = &probe_cache;
+        restored = c->gpu_freqs.count >= 0 && c->gpu_freqs.count <= MAX_GPU_FREQS &&
+                   c->ecpu_freqs.count >= 0 && c->ecpu_freqs.count <= MAX_GPU_FREQS &&
+                   c->pcpu_freqs.count >= 0 && c->pcpu_freqs.count <= MAX_GPU_FREQS;
+        if (restored) {
+            gpu_freq_table = c->gpu_freqs;
+            ecpu_freq_table = c->ecpu_freqs;
+            pcpu_freq_table = c->pcpu_freqs;
+        } else {
+            probe_cache_invalidate(PROBE_SECTION_FREQS);
+        }
+    }
+    pthread_mutex_unlock(&probe_cache_mutex);
+    return restored;
+}
 
-    if (strcmp(unit, "nJ") == 0) {
-        return (float)(joules_per_sec / 1e9);
-    } else if (strcmp(unit, "uJ") == 0) {
-        return (float)(joules_per_sec / 1e6);
-    } else if (strcmp(unit, "mJ") == 0) {
-        return (float)(joules_per_sec / 1e3);
+static void probe_cache_store_freqs(void) {
+    pthread_mutex_lock(&probe_cache_mutex);
+    if (probe_cache_path[0]) {
+        probe_cache_load();
+        probe_cache.gpu_freqs = gpu_freq_table;
+        probe_cache.ecpu_freqs = ecpu_freq_table;
+        probe_cache.pcpu_freqs = pcpu_freq_table;
+        probe_cache.sections |= PROBE_SECTION_FREQS;
+        probe_cache_save();
     }
-    return 0.0f;
+    pthread_mutex_unlock(&probe_cache_mutex);
 }
 
-// Calculate GPU frequency from residency states
-static void calc_gpu_freq_from_residency(CFDictionaryRef channel, float *freq_mhz, float *load_pct) {
-    *freq_mhz = 0.0f;
-    *load_pct = 0.0f;
+// FNV-1a over a channel's group and name
+static uint32_t ior_channel_hash(CFDictionaryRef ch) {
+    char group_str[64] = {0};
+    char name_str[64] = {0};
+    if (pIOReportChannelGetGroup) cfstring_to_cstr(pIOReportChannelGetGroup(ch), group_str, sizeof(group_str));
+    if (pIOReportChannelGetChannelName) cfstring_to_cstr(pIOReportChannelGetChannelName(ch), name_str, sizeof(name_str));
+
+    uint32_t hash = 2166136261u;
+    for (const char *p = group_str; *p; p++) hash = (hash ^ (uint8_t)*p) * 16777619u;
+    hash = (hash ^ '/') * 16777619u;
+    for (const char *p = name_str; *p; p++) hash = (hash ^ (uint8_t)*p) * 16777619u;
+    return hash;
+}
 
-    if (num_gpu_freqs == 0) return;
+// Restore the channel table if the subscription has the same layout: same
+// channel count, and every classified channel still has the same group/name
+static int probe_cache_restore_ior(CFArrayRef channels) {
+    CFIndex count = channels ? CFArrayGetCount(channels) : 0;
+
+    pthread_mutex_lock(&probe_cache_mutex);
+    const ProbeCache *c = &probe_cache;
+    int restored = probe_cache_has(PROBE_SECTION_IOR) &&
+                   c->channel_count == count &&
+                   c->cluster_count >= 0 && c->cluster_count <= PCSTATS_MAX_CLUSTERS;
+
+    for (CFIndex i = 0; restored && i < count && i < MAX_IOR_CHANNELS; i++) {
+        if (c->channels[i].kind == IOR_CH_IGNORE) continue;
+        CFDictionaryRef ch = CFArrayGetValueAtIndex(channels, i);
+        restored = ch && ior_channel_hash(ch) == c->channel_hash[i];
+    }
 
-    if (!pIOReportStateGetCount || !pIOReportStateGetResidency) return;
+    if (restored) {
+        memcpy(ior_channel_table, c->channels, sizeof(ior_channel_table));
+        ior_classified_count = count;
+        cached_cluster_count = c->cluster_count;
+        memcpy(cached_cluster_name, c->cluster_name, sizeof(cached_cluster_name));
+    } else if (probe_cache.sections & PROBE_SECTION_IOR) {
+        probe_cache_invalidate(PROBE_SECTION_IOR);
+    }
+    pthread_mutex_unlock(&probe_cache_mutex);
+    return restored;
+}
 
-    int state_count = pIOReportStateGetCount(channel);
-    if (state_count <= 0) return;
+static void probe_cache_store_ior(CFArrayRef channels) {
+    pthread_mutex_lock(&probe_cache_mutex);
+    if (probe_cache_path[0]) {
+        probe_cache_load();
+        ProbeCache *c = &probe_cache;
+        memcpy(c->channels, ior_channel_table, sizeof(c->channels));
+        for (CFIndex i = 0; i < ior_classified_count && i < MAX_IOR_CHANNELS; i++) {
+            c->channel_hash[i] = ior_channel_table[i].kind == IOR_CH_IGNORE ? 0 :
+                ior_channel_hash(CFArrayGetValueAtIndex(channels, i));
+        }
+        c->channel_count = (int32_t)ior_classified_count;
+        c->cluster_count = cached_cluster_count;
+        memcpy(c->cluster_name, cached_cluster_name, sizeof(c->cluster_name));
+        c->sections |= PROBE_SECTION_IOR;
+        probe_cache_save();
+    }
+    pthread_mutex_unlock(&probe_cache_mutex);
+}
+
+// Parse a pmgr voltage-states table into MHz
+static void load_freq_table(CFDictionaryRef props, CFStringRef key, FreqTable *table) {
+    CFDataRef data = CFDictionaryGetValue(props, key);
+    if (!data) return;
+
+    CFIndex len = CFDataGetLength(data);
+    const uint8_t *bytes = CFDataGetBytePtr(data);
+
+    // Data is pairs of (freq_hz, voltage) - 4 bytes each
+    int count = (int)(len / 8);
+    for (int i = 0; i < count && table->count < MAX_GPU_FREQS; i++) {
+        uint32_t freq_hz = bytes[i*8] | (bytes[i*8+1] << 8) |
+                          (bytes[i*8+2] << 16) | ((uint32_t)bytes[i*8+3] << 24);
+        uint32_t freq_mhz = freq_hz / 1000000;
+        if (freq_mhz > 0) {
+            table->mhz[table->count++] = freq_mhz;
+        }
+    }
+}
+
+// Get GPU and CPU cluster frequencies from pmgr IOKit device
+static void ior_load_freq_tables(void) {
+    if (freq_tables_loaded) return;  // Already loaded
+    freq_tables_loaded = 1;
+
+    if (probe_cache_restore_freqs()) return;
+
+    io_iterator_t iter;
+    kern_return_t kr = IOServiceGetMatchingServices(kIOMainPortDefault,
+        IOServiceMatching("AppleARMIODevice"), &iter);
+    if (kr != KERN_SUCCESS) return;
+
+    io_object_t device;
+    while ((device = IOIteratorNext(iter)) != 0) {
+        char name[128] = {0};
+        IORegistryEntryGetName(device, name);
+
+        if (strcmp(name, "pmgr") == 0) {
+            CFMutableDictionaryRef props = NULL;
+            if (IORegistryEntryCreateCFProperties(device, &props,
+                    kCFAllocatorDefault, 0) == KERN_SUCCESS && props) {
+                load_freq_table(props, CFSTR("voltage-states9"), &gpu_freq_table);        // GPU
+                load_freq_table(props, CFSTR("voltage-states1-sram"), &ecpu_freq_table);  // E-cluster
+                load_freq_table(props, CFSTR("voltage-states5-sram"), &pcpu_freq_table);  // P-cluster
+                CFRelease(props);
+            }
+        }
+        IOObjectRelease(device);
+    }
+    IOObjectRelease(iter);
+
+    probe_cache_store_freqs();
+}
+
+// Energy unit label -> joules per unit (0 for units we don't understand)
+static double ior_unit_scale(const char *unit) {
+    if (strcmp(unit, "nJ") == 0) return 1e-9;
+    if (strcmp(unit, "uJ") == 0) return 1e-6;
+    if (strcmp(unit, "mJ") == 0) return 1e-3;
+    return 0.0;
+}
+
+// Split an Ultra channel name ("DIE_1_CPU Energy") into its die and the
+// per-chip name; die is -1 for names without the prefix
+static const char *ior_strip_die(const char *name, int *die) {
+    *die = -1;
+    if (strncmp(name, "DIE_", 4) != 0 || name[4] < '0' || name[4] > '9') return name;
+
+    char *end;
+    long index = strtol(name + 4, &end, 10);
+    if (*end != '_' || index > 127) return name;
+    *die = (int)index;
+    return end + 1;
+}
+
+// Classify every channel once by group/name/unit. Runs at subscribe time and
+// again only if the sample's channel layout ever differs from the table.
+static void ior_classify_channels(CFArrayRef channels) {
+    CFIndex count = channels ? CFArrayGetCount(channels) : 0;
+    memset(ior_channel_table, 0, sizeof(ior_channel_table));
+    ior_classified_count = count;
+    cached_cluster_count = 0;
+
+    for (CFIndex i = 0; i < count && i < MAX_IOR_CHANNELS; i++) {
+        CFDictionaryRef ch = CFArrayGetValueAtIndex(channels, i);
+        if (!ch) continue;
+
+        CFStringRef group = pIOReportChannelGetGroup ? pIOReportChannelGetGroup(ch) : NULL;
+        CFStringRef channel_name = pIOReportChannelGetChannelName ? pIOReportChannelGetChannelName(ch) : NULL;
+        CFStringRef unit_label = pIOReportChannelGetUnitLabel ? pIOReportChannelGetUnitLabel(ch) : NULL;
+
+        char group_str[64] = {0};
+        char name_str[64] = {0};
+        char unit_str[16] = {0};
+
+        if (group) cfstring_to_cstr(group, group_str, sizeof(group_str));
+        if (channel_name) cfstring_to_cstr(channel_name, name_str, sizeof(name_str));
+        if (unit_label) cfstring_to_cstr(unit_label, unit_str, sizeof(unit_str));
+
+        IorChannel *entry = &ior_channel_table[i];
+        entry->state_offset = -1;
+
+        int die;
+        const char *base_name = ior_strip_die(name_str, &die);
+        entry->die = (int8_t)die;
+
+        // Energy Model - power consumption
+        if (strcmp(group_str, "Energy Model") == 0) {
+            entry->joules_per_unit = ior_unit_scale(unit_str);
+            if (entry->joules_per_unit == 0.0) continue;
+
+            // CPU Energy (per die on Ultra: "DIE_0_CPU Energy", "DIE_1_CPU Energy")
+            if (strstr(base_name, "CPU Energy")) {
+                entry->kind = IOR_CH_CPU_ENERGY;
+            }
+            // GPU Energy
+            else if (strcmp(base_name, "GPU Energy") == 0) {
+                entry->kind = IOR_CH_GPU_ENERGY;
+            }
+        }
+        // GPU Stats - frequency (one GPUPH per die on Ultra)
+        else if (strcmp(group_str, "GPU Stats") == 0) {
+            if (strcmp(base_name, "GPUPH") == 0) {
+                entry->kind = IOR_CH_GPU_PSTATES;
+            }
+        }
+        // CPU Stats - one channel per cluster (ECPU, PCPU, PCPU1, DIE_1_PCPU...)
+        else if (strcmp(group_str, "CPU Stats") == 0) {
+            if ((strstr(name_str, "ECPU") || strstr(name_str, "PCPU")) &&
+                cached_cluster_count < PCSTATS_MAX_CLUSTERS) {
+                entry->kind = IOR_CH_CPU_PSTATES;
+                entry->cluster = (int8_t)cached_cluster_count;
+                snprintf(cached_cluster_name[cached_cluster_count],
+                         sizeof(cached_cluster_name[0]), "%s", name_str);
+                cached_cluster_count++;
+            }
+        }
+    }
+}
 
-    // Find offset (skip IDLE/OFF states)
-    int offset = 0;
+// Find the first active P-state (skip IDLE/OFF/DOWN). Done once per channel
+// layout - the state names don't change between samples.
+static int ior_find_state_offset(CFDictionaryRef channel) {
+    if (!pIOReportStateGetCount || !pIOReportStateGetNameForIndex) return 0;
+
+    int state_count = pIOReportStateGetCount(channel);
     for (int i = 0; i < state_count; i++) {
-        CFStringRef name = pIOReportStateGetNameForIndex ? pIOReportStateGetNameForIndex(channel, i) : NULL;
+        CFStringRef name = pIOReportStateGetNameForIndex(channel, i);
         if (name) {
             char buf[64];
             cfstring_to_cstr(name, buf, sizeof(buf));
             if (strcmp(buf, "IDLE") != 0 && strcmp(buf, "OFF") != 0 && strcmp(buf, "DOWN") != 0) {
-                offset = i;
-                break;
+                return i;
             }
         }
     }
+    return 0;
+}
+
+// Initialize IOReport subscription
+static int ior_init(void) {
+    if (ior_initialized) return 0;
+
+    // Load IOReport framework
+    if (ior_load_framework() != 0) {
+        return -1;
+    }
+
+    // Get channels for Energy Model (power), GPU Stats (frequency) and
+    // CPU Stats (per-cluster frequency)
+    CFDictionaryRef groups[] = {
+        pIOReportCopyChannelsInGroup(CFSTR("Energy Model"), NULL, 0, 0, 0),
+        pIOReportCopyChannelsInGroup(CFSTR("GPU Stats"), CFSTR("GPU Performance States"), 0, 0, 0),
+        pIOReportCopyChannelsInGroup(CFSTR("CPU Stats"), CFSTR("CPU Complex Performance States"), 0, 0, 0),
+    };
+    const int num_groups = sizeof(groups) / sizeof(groups[0]);
+
+    // Merge channels into the first group that exists
+    CFDictionaryRef base = NULL;
+    for (int i = 0; i < num_groups; i++) {
+        if (!groups[i]) continue;
+        if (!base) {
+            base = groups[i];
+            continue;
+        }
+        if (pIOReportMergeChannels) pIOReportMergeChannels(base, groups[i], NULL);
+        CFRelease(groups[i]);
+    }
+
+    if (!base) {
+        return -1;  // No channels available
+    }
+
+    ior_channels = CFDictionaryCreateMutableCopy(kCFAllocatorDefault,
+                                                  CFDictionaryGetCount(base), base);
+    CFRelease(base);
+
+    if (!ior_channels) return -1;
+
+    // Create subscription
+    CFMutableDictionaryRef result = NULL;
+    ior_subscription = pIOReportCreateSubscription(NULL, ior_channels, &result, 0, NULL);
+    if (!ior_subscription) {
+        CFRelease(ior_channels);
+        ior_channels = NULL;
+        return -1;
+    }
+
+    // Classify subscribed channels once (index into each sample's channel array),
+    // or reuse last launch's classification if the layout is unchanged
+    CFArrayRef subscribed = CFDictionaryGetValue(ior_channels, CFSTR("IOReportChannels"));
+    if (!probe_cache_restore_ior(subscribed)) {
+        ior_classify_channels(subscribed);
+        probe_cache_store_ior(subscribed);
+    }
+
+    // Load GPU and CPU cluster frequencies
+    ior_load_freq_tables();
+
+    ior_initialized = 1;
+    return 0;
+}
+
+// Calculate residency-weighted frequency and active percent from P-states
+// (offset = first active state, freqs[i] = MHz of active state i)
+static void calc_freq_from_residency(CFDictionaryRef channel, int offset, const FreqTable *freqs,
+                                     float *freq_mhz, float *load_pct) {
+    *freq_mhz = 0.0f;
+    *load_pct = 0.0f;
+
+    if (freqs->count == 0) return;
+
+    if (!pIOReportStateGetCount || !pIOReportStateGetResidency) return;
+
+    int state_count = pIOReportStateGetCount(channel);
+    if (state_count <= 0) return;
 
     // Sum residencies
     int64_t total_residency = 0;
@@ -749,8 +1705,8 @@ static void calc_gpu_freq_from_residency(CFDictionaryRef channel, float *freq_mh
         if (i >= offset) {
             active_residency += residency;
             int freq_idx = i - offset;
-            if (freq_idx < num_gpu_freqs) {
-                weighted_freq += (double)residency * gpu_freqs[freq_idx];
+            if (freq_idx < freqs->count) {
+                weighted_freq += (double)residency * freqs->mhz[freq_idx];
             }
         }
     }
@@ -762,12 +1718,16 @@ static void calc_gpu_freq_from_residency(CFDictionaryRef channel, float *freq_mh
 }
 
 // Sample IOReport and update cached values
-static void ior_sample(void) {
+static void ior_take_sample(void) {
     if (!ior_initialized && ior_init() != 0) return;
     if (!ior_subscription) return;
 
     CFDictionaryRef sample = pIOReportCreateSamples(ior_subscription, ior_channels, NULL);
-    if (!sample) return;
+    metrics_count(PCSTATS_COUNTER_IOREPORT_CALLS, 1);
+    if (!sample) {
+        metrics_count(PCSTATS_COUNTER_IOREPORT_ERRORS, 1);
+        return;
+    }
 
     uint64_t now_ms = get_time_ms();
 
@@ -781,51 +1741,69 @@ static void ior_sample(void) {
             // Get channels array
             CFArrayRef channels = CFDictionaryGetValue(delta, CFSTR("IOReportChannels"));
             if (channels) {
-                float cpu_power = 0, gpu_power = 0;
-                float gpu_freq = 0, gpu_load = 0;
+                // Energy as [chip-wide, sum of dies]: an Ultra that reports
+                // both must not count its dies twice
+                double cpu_joules[2] = {0, 0}, gpu_joules[2] = {0, 0};
+                int cpu_chip_wide = 0, gpu_chip_wide = 0;
+                float gpu_freq_sum = 0, gpu_load_sum = 0;
+                int gpu_channels = 0;
 
                 CFIndex count = CFArrayGetCount(channels);
-                for (CFIndex i = 0; i < count; i++) {
-                    CFDictionaryRef ch = CFArrayGetValueAtIndex(channels, i);
-                    if (!ch) continue;
-
-                    CFStringRef group = pIOReportChannelGetGroup ? pIOReportChannelGetGroup(ch) : NULL;
-                    CFStringRef channel_name = pIOReportChannelGetChannelName ? pIOReportChannelGetChannelName(ch) : NULL;
-                    CFStringRef unit_label = pIOReportChannelGetUnitLabel ? pIOReportChannelGetUnitLabel(ch) : NULL;
-
-                    char group_str[64] = {0};
-                    char name_str[64] = {0};
-                    char unit_str[16] = {0};
+                if (count != ior_classified_count) {
+                    ior_classify_channels(channels);
+                }
 
-                    if (group) cfstring_to_cstr(group, group_str, sizeof(group_str));
-                    if (channel_name) cfstring_to_cstr(channel_name, name_str, sizeof(name_str));
-                    if (unit_label) cfstring_to_cstr(unit_label, unit_str, sizeof(unit_str));
+                for (CFIndex i = 0; i < count && i < MAX_IOR_CHANNELS; i++) {
+                    IorChannel *entry = &ior_channel_table[i];
+                    if (entry->kind == IOR_CH_IGNORE) continue;
 
-                    // Energy Model - power consumption
-                    if (strcmp(group_str, "Energy Model") == 0) {
-                        int64_t energy = pIOReportSimpleGetIntegerValue(ch, 0);
+                    CFDictionaryRef ch = CFArrayGetValueAtIndex(channels, i);
+                    if (!ch) continue;
 
-                        // CPU Energy (handles both "CPU Energy" and "DIE_*_CPU Energy" for Ultra)
-                        if (strstr(name_str, "CPU Energy")) {
-                            cpu_power += energy_to_watts(energy, unit_str, duration_ms);
-                        }
-                        // GPU Energy
-                        else if (strcmp(name_str, "GPU Energy") == 0) {
-                            gpu_power += energy_to_watts(energy, unit_str, duration_ms);
+                    switch (entry->kind) {
+                        case IOR_CH_CPU_ENERGY:
+                            cpu_joules[entry->die >= 0] += (double)pIOReportSimpleGetIntegerValue(ch, 0) * entry->joules_per_unit;
+                            cpu_chip_wide |= entry->die < 0;
+                            break;
+                        case IOR_CH_GPU_ENERGY:
+                            gpu_joules[entry->die >= 0] += (double)pIOReportSimpleGetIntegerValue(ch, 0) * entry->joules_per_unit;
+                            gpu_chip_wide |= entry->die < 0;
+                            break;
+                        case IOR_CH_GPU_PSTATES: {
+                            if (entry->state_offset < 0) {
+                                entry->state_offset = (int16_t)ior_find_state_offset(ch);
+                            }
+                            float freq, load;
+                            calc_freq_from_residency(ch, entry->state_offset, &gpu_freq_table,
+                                                     &freq, &load);
+                            gpu_freq_sum += freq;
+                            gpu_load_sum += load;
+                            gpu_channels++;
+                            break;
                         }
-                    }
-                    // GPU Stats - frequency
-                    else if (strcmp(group_str, "GPU Stats") == 0) {
-                        if (strcmp(name_str, "GPUPH") == 0) {
-                            calc_gpu_freq_from_residency(ch, &gpu_freq, &gpu_load);
+                        case IOR_CH_CPU_PSTATES: {
+                            if (entry->state_offset < 0) {
+                                entry->state_offset = (int16_t)ior_find_state_offset(ch);
+                            }
+                            const char *cluster_name = cached_cluster_name[entry->cluster];
+                            const FreqTable *table = strstr(cluster_name, "ECPU") ? &ecpu_freq_table
+                                                                                  : &pcpu_freq_table;
+                            calc_freq_from_residency(ch, entry->state_offset, table,
+                                                     &cached_cluster_freq[entry->cluster],
+                                                     &cached_cluster_load[entry->cluster]);
+                            break;
                         }
                     }
                 }
 
+                double duration_s = duration_ms / 1000.0;
+                float cpu_power = (float)((cpu_chip_wide ? cpu_joules[0] : cpu_joules[1]) / duration_s);
+                float gpu_power = (float)((gpu_chip_wide ? gpu_joules[0] : gpu_joules[1]) / duration_s);
+
                 cached_cpu_power = cpu_power;
                 cached_gpu_power = gpu_power;
-                cached_gpu_freq = gpu_freq;
-                cached_gpu_load = gpu_load;
+                cached_gpu_freq = gpu_channels > 0 ? gpu_freq_sum / gpu_channels : 0.0f;
+                cached_gpu_load = gpu_channels > 0 ? gpu_load_sum / gpu_channels : 0.0f;
             }
             CFRelease(delta);
         }
@@ -839,6 +1817,38 @@ static void ior_sample(void) {
     ior_prev_time_ms = now_ms;
 }
 
+static void ior_sample(void) {
+    uint64_t started = metrics_start();
+    ior_take_sample();
+    metrics_stop(PCSTATS_TIMER_IOREPORT, started);
+}
+
+// Drop the subscription and the sample the next delta would start from;
+// ior_sample() subscribes again (from the probe cache) on next use
+static void ior_release(void) {
+    if (ior_prev_sample) {
+        CFRelease(ior_prev_sample);
+        ior_prev_sample = NULL;
+    }
+    ior_prev_time_ms = 0;
+    if (ior_subscription) {
+        CFRelease(ior_subscription);
+        ior_subscription = NULL;
+    }
+    if (ior_channels) {
+        CFRelease(ior_channels);
+        ior_channels = NULL;
+    }
+    ior_initialized = 0;
+
+    cached_cpu_power = 0.0f;
+    cached_gpu_power = 0.0f;
+    cached_gpu_freq = 0.0f;
+    cached_gpu_load = 0.0f;
+    memset(cached_cluster_freq, 0, sizeof(cached_cluster_freq));
+    memset(cached_cluster_load, 0, sizeof(cached_cluster_load));
+}
+
 // Public getters for power/frequency
 float get_cpu_power(void) {
     return cached_cpu_power;
@@ -872,9 +1882,7 @@ static mach_port_t get_host_port(void) {
 static uint64_t prev_total_ticks = 0;
 static uint64_t prev_idle_ticks = 0;
 
-// Previous network bytes for calculating throughput
-static uint64_t prev_bytes_in = 0;
-static uint64_t prev_bytes_out = 0;
+// Previous network sample time for calculating throughput
 static struct timeval prev_net_time;
 
 // Start time for uptime calculation
@@ -907,13 +1915,86 @@ float get_cpu_usage(void) {
     return (1.0f - ((float)idle_diff / (float)total_diff)) * 100.0f;
 }
 
+// Previous per-core ticks, sized once for the largest machine we support so
+// sampling never allocates; host_processor_info()'s array is freed per call
+static uint32_t prev_core_ticks[PCSTATS_MAX_CORES][CPU_STATE_MAX];
+static int perf_core_count = 0;
+static int efficiency_core_count = 0;
+
+// Read P/E core counts once (missing on Intel, where both stay 0)
+static void load_core_topology(void) {
+    size_t len = sizeof(perf_core_count);
+    if (sysctlbyname("hw.perflevel0.logicalcpu", &perf_core_count, &len, NULL, 0) != 0) {
+        perf_core_count = 0;
+    }
+    len = sizeof(efficiency_core_count);
+    if (sysctlbyname("hw.perflevel1.logicalcpu", &efficiency_core_count, &len, NULL, 0) != 0) {
+        efficiency_core_count = 0;
+    }
+}
+
+// Get per-core CPU usage percentages
+void get_cpu_core_usage(CpuCoreStats *cores) {
+    natural_t cpu_count = 0;
+    processor_info_array_t info = NULL;
+    mach_msg_type_number_t info_count = 0;
+
+    cores->core_count = 0;
+    cores->perf_core_count = perf_core_count;
+    cores->efficiency_core_count = efficiency_core_count;
+
+    if (host_processor_info(get_host_port(), PROCESSOR_CPU_LOAD_INFO,
+                            &cpu_count, &info, &info_count) != KERN_SUCCESS) {
+        return;
+    }
+
+    processor_cpu_load_info_t load = (processor_cpu_load_info_t)info;
+    int n = cpu_count < PCSTATS_MAX_CORES ? (int)cpu_count : PCSTATS_MAX_CORES;
+
+    for (int c = 0; c < n; c++) {
+        uint32_t total_diff = 0;
+        for (int s = 0; s < CPU_STATE_MAX; s++) {
+            total_diff += load[c].cpu_ticks[s] - prev_core_ticks[c][s];
+        }
+        uint32_t idle_diff = load[c].cpu_ticks[CPU_STATE_IDLE] - prev_core_ticks[c][CPU_STATE_IDLE];
+
+        cores->core_load[c] = total_diff > 0
+            ? (1.0f - ((float)idle_diff / (float)total_diff)) * 100.0f
+            : 0.0f;
+        memcpy(prev_core_ticks[c], load[c].cpu_ticks, sizeof(prev_core_ticks[c]));
+    }
+    cores->core_count = n;
+
+    vm_deallocate(mach_task_self(), (vm_address_t)info, info_count * sizeof(integer_t));
+}
+
+// Page size and physical memory can't change while we run, read them once
+static vm_size_t cached_page_size = 0;
+static uint64_t cached_total_mem = 0;
+static MemoryDetail cached_memory_detail;
+
+static void load_memory_invariants(void) {
+    if (host_page_size(get_host_port(), &cached_page_size) != KERN_SUCCESS) {
+        cached_page_size = 4096;
+    }
+
+    int64_t total_mem = 0;
+    size_t len = sizeof(total_mem);
+    sysctlbyname("hw.memsize", &total_mem, &len, NULL, 0);
+    cached_total_mem = (uint64_t)total_mem;
+}
+
 // Get memory usage
+// "Used" follows Activity Monitor: app memory (anonymous minus purgeable)
+// + wired + compressed. Inactive and file-backed pages count as available,
+// since the kernel reclaims them without swapping.
 void get_memory_usage(Memory *mem) {
-    vm_size_t page_size;
     vm_statistics64_data_t vm_stats;
     mach_msg_type_number_t count = sizeof(vm_stats) / sizeof(natural_t);
 
-    host_page_size(get_host_port(), &page_size);
+    if (!cached_page_size) {
+        load_memory_invariants();
+    }
 
     if (host_statistics64(get_host_port(), HOST_VM_INFO64,
                           (host_info64_t)&vm_stats, &count) != KERN_SUCCESS) {
@@ -923,63 +2004,362 @@ void get_memory_usage(Memory *mem) {
         return;
     }
 
-    // Get total physical memory
-    int64_t total_mem;
-    size_t len = sizeof(total_mem);
-    sysctlbyname("hw.memsize", &total_mem, &len, NULL, 0);
+    uint64_t page_size = cached_page_size;
+    MemoryDetail *detail = &cached_memory_detail;
+    detail->total_bytes = cached_total_mem;
+    detail->free_bytes = (uint64_t)vm_stats.free_count * page_size;
+    detail->active_bytes = (uint64_t)vm_stats.active_count * page_size;
+    detail->inactive_bytes = (uint64_t)vm_stats.inactive_count * page_size;
+    detail->wired_bytes = (uint64_t)vm_stats.wire_count * page_size;
+    detail->compressed_bytes = (uint64_t)vm_stats.compressor_page_count * page_size;
+    detail->compressed_original_bytes = vm_stats.total_uncompressed_pages_in_compressor * page_size;
+    detail->purgeable_bytes = (uint64_t)vm_stats.purgeable_count * page_size;
+    detail->file_backed_bytes = (uint64_t)vm_stats.external_page_count * page_size;
+
+    uint64_t app_pages = vm_stats.internal_page_count > vm_stats.purgeable_count
+        ? vm_stats.internal_page_count - vm_stats.purgeable_count : 0;
+    detail->app_bytes = app_pages * page_size;
+
+    uint64_t used = detail->app_bytes + detail->wired_bytes + detail->compressed_bytes;
+    if (cached_total_mem && used > cached_total_mem) used = cached_total_mem;
+    uint64_t avail = cached_total_mem > used ? cached_total_mem - used : 0;
+
+    // Swap usage (not part of the VM statistics)
+    struct xsw_usage swap;
+    size_t len = sizeof(swap);
+    if (sysctlbyname("vm.swapusage", &swap, &len, NULL, 0) == 0) {
+        detail->swap_total_bytes = swap.xsu_total;
+        detail->swap_used_bytes = swap.xsu_used;
+    }
+
+    // Kernel pressure level: 1 = normal, 2 = warning, 4 = critical
+    int level = 0;
+    len = sizeof(level);
+    if (sysctlbyname("kern.memorystatus_vm_pressure_level", &level, &len, NULL, 0) != 0) {
+        level = 0;
+    }
+    detail->pressure_level = level == 4 ? PCSTATS_MEMORY_PRESSURE_CRITICAL
+                           : level == 2 ? PCSTATS_MEMORY_PRESSURE_WARNING
+                           : PCSTATS_MEMORY_PRESSURE_NORMAL;
+
+    // Wired and compressed pages can't be dropped cheaply; their share of
+    // RAM approximates Activity Monitor's pressure graph
+    detail->pressure_percent = cached_total_mem
+        ? (float)(detail->wired_bytes + detail->compressed_bytes) / (float)cached_total_mem * 100.0f
+        : 0.0f;
+
+    mem->used = (float)used / (1024.0f * 1024.0f * 1024.0f);    // GB
+    mem->avail = (float)avail / (1024.0f * 1024.0f * 1024.0f);  // GB
+    mem->percent = cached_total_mem ? ((float)used / (float)cached_total_mem) * 100.0f : 0.0f;
+}
+
+void get_memory_detail(MemoryDetail *detail) {
+    *detail = cached_memory_detail;
+}
+
+// Interface counters. The default set is every up, non-loopback interface
+// except virtual ones that mirror traffic of a physical interface (VPN
+// tunnels, AWDL, bridges), which would otherwise be counted twice.
+static const char *const net_virtual_prefixes[] = {
+    "utun", "awdl", "llw", "bridge", "gif", "stf", "ipsec", "anpi", "ap", "vmenet",
+};
+
+// Optional allowlist (e.g. just "en0"), guarded by net_filter_mutex
+static pthread_mutex_t net_filter_mutex = PTHREAD_MUTEX_INITIALIZER;
+static char net_allowlist[PCSTATS_MAX_INTERFACES][IFNAMSIZ];
+static int net_allowlist_count = 0;
+
+// Per-interface previous bytes, matched by name across ticks
+typedef struct {
+    char name[IFNAMSIZ];
+    uint64_t bytes_in;
+    uint64_t bytes_out;
+} NetCounter;
+
+static NetCounter net_counters[PCSTATS_MAX_INTERFACES];
+static NetCounter prev_net_counters[PCSTATS_MAX_INTERFACES];
+static int num_net_counters = 0;
+static int num_prev_net_counters = 0;
+static NetworkDetail cached_network_detail;
+
+// Reusable NET_RT_IFLIST2 buffer (only grows)
+static char *iflist_buf = NULL;
+static size_t iflist_cap = 0;
+
+int pcstats_set_network_interfaces(const char *const *names, int count) {
+    if (count < 0 || count > PCSTATS_MAX_INTERFACES) return -1;
+    if (!names) count = 0;
+
+    pthread_mutex_lock(&net_filter_mutex);
+    for (int i = 0; i < count; i++) {
+        snprintf(net_allowlist[i], IFNAMSIZ, "%s", names[i]);
+    }
+    net_allowlist_count = count;
+    pthread_mutex_unlock(&net_filter_mutex);
+    return 0;
+}
+
+// Returns 1 if the interface should be counted
+static int net_interface_included(const char *name, int flags) {
+    if (!(flags & IFF_UP)) return 0;
+    if (flags & IFF_LOOPBACK) return 0;
+
+    int included = 1;
+    pthread_mutex_lock(&net_filter_mutex);
+    if (net_allowlist_count > 0) {
+        included = 0;
+        for (int i = 0; i < net_allowlist_count; i++) {
+            if (strcmp(name, net_allowlist[i]) == 0) {
+                included = 1;
+                break;
+            }
+        }
+    } else {
+        for (size_t i = 0; i < sizeof(net_virtual_prefixes) / sizeof(net_virtual_prefixes[0]); i++) {
+            if (strncmp(name, net_virtual_prefixes[i], strlen(net_virtual_prefixes[i])) == 0) {
+                included = 0;
+                break;
+            }
+        }
+    }
+    pthread_mutex_unlock(&net_filter_mutex);
+    return included;
+}
+
+static void net_add_counter(const char *name, uint64_t bytes_in, uint64_t bytes_out) {
+    if (num_net_counters >= PCSTATS_MAX_INTERFACES) return;
+    NetCounter *counter = &net_counters[num_net_counters++];
+    snprintf(counter->name, IFNAMSIZ, "%s", name);
+    counter->bytes_in = bytes_in;
+    counter->bytes_out = bytes_out;
+}
+
+// Read 64-bit link counters from the routing sysctl, returns -1 on failure
+static int net_read_iflist2(void) {
+    int mib[6] = { CTL_NET, PF_ROUTE, 0, 0, NET_RT_IFLIST2, 0 };
+    size_t len = 0;
+
+    if (sysctl(mib, 6, NULL, &len, NULL, 0) != 0) return -1;
+    if (len > iflist_cap) {
+        size_t cap = len + len / 4;  // Headroom for interfaces appearing later
+        char *buf = realloc(iflist_buf, cap);
+        if (!buf) return -1;
+        iflist_buf = buf;
+        iflist_cap = cap;
+    }
+    len = iflist_cap;
+    if (sysctl(mib, 6, iflist_buf, &len, NULL, 0) != 0) return -1;
+
+    num_net_counters = 0;
+    for (char *next = iflist_buf; next < iflist_buf + len; ) {
+        struct if_msghdr *ifm = (struct if_msghdr *)next;
+        if (ifm->ifm_msglen == 0) break;
+        next += ifm->ifm_msglen;
+
+        if (ifm->ifm_type != RTM_IFINFO2) continue;
+        struct if_msghdr2 *ifm2 = (struct if_msghdr2 *)ifm;
+
+        // The link-level address with the interface name follows the header
+        struct sockaddr_dl *sdl = (struct sockaddr_dl *)(ifm2 + 1);
+        char name[IFNAMSIZ] = {0};
+        size_t nlen = sdl->sdl_nlen < IFNAMSIZ - 1 ? sdl->sdl_nlen : IFNAMSIZ - 1;
+        memcpy(name, sdl->sdl_data, nlen);
+
+        if (!net_interface_included(name, ifm2->ifm_flags)) continue;
+        net_add_counter(name, ifm2->ifm_data.ifi_ibytes, ifm2->ifm_data.ifi_obytes);
+    }
+    return 0;
+}
+
+// Fallback: AF_LINK entries from getifaddrs (32-bit counters)
+static void net_read_getifaddrs(void) {
+    struct ifaddrs *ifap, *ifa;
+
+    num_net_counters = 0;
+    if (getifaddrs(&ifap) != 0) return;
+
+    for (ifa = ifap; ifa != NULL; ifa = ifa->ifa_next) {
+        if (ifa->ifa_addr == NULL) continue;
+        if (ifa->ifa_addr->sa_family != AF_LINK) continue;
+        if (!net_interface_included(ifa->ifa_name, (int)ifa->ifa_flags)) continue;
 
-    // Calculate used and available
-    uint64_t used_pages = vm_stats.active_count + vm_stats.wire_count;
-    uint64_t free_pages = vm_stats.free_count + vm_stats.inactive_count;
+        struct if_data *if_data = (struct if_data *)ifa->ifa_data;
+        if (if_data) {
+            net_add_counter(ifa->ifa_name, if_data->ifi_ibytes, if_data->ifi_obytes);
+        }
+    }
+    freeifaddrs(ifap);
+}
 
-    mem->used = (float)(used_pages * page_size) / (1024.0f * 1024.0f * 1024.0f);  // GB
-    mem->avail = (float)(free_pages * page_size) / (1024.0f * 1024.0f * 1024.0f); // GB
-    mem->percent = ((float)(used_pages * page_size) / (float)total_mem) * 100.0f;
+static const NetCounter *net_find_prev(const char *name) {
+    for (int i = 0; i < num_prev_net_counters; i++) {
+        if (strcmp(prev_net_counters[i].name, name) == 0) return &prev_net_counters[i];
+    }
+    return NULL;
 }
 
 // Get network throughput (Mb/s - megabits per second)
 void get_network_throughput(Network *net) {
-    struct ifaddrs *ifap, *ifa;
-    uint64_t bytes_in = 0, bytes_out = 0;
     struct timeval now;
 
     gettimeofday(&now, NULL);
 
-    if (getifaddrs(&ifap) == 0) {
-        for (ifa = ifap; ifa != NULL; ifa = ifa->ifa_next) {
-            if (ifa->ifa_addr == NULL) continue;
-            if (ifa->ifa_addr->sa_family != AF_LINK) continue;
-            if (!(ifa->ifa_flags & IFF_UP)) continue;
-            if (ifa->ifa_flags & IFF_LOOPBACK) continue;
-
-            struct if_data *if_data = (struct if_data *)ifa->ifa_data;
-            if (if_data) {
-                bytes_in += if_data->ifi_ibytes;
-                bytes_out += if_data->ifi_obytes;
-            }
-        }
-        freeifaddrs(ifap);
+    uint64_t started = metrics_start();
+    if (net_read_iflist2() != 0) {
+        metrics_count(PCSTATS_COUNTER_NET_FALLBACKS, 1);
+        net_read_getifaddrs();
     }
+    metrics_stop(PCSTATS_TIMER_NETWORK, started);
 
     // Calculate time difference
     double time_diff = (now.tv_sec - prev_net_time.tv_sec) +
                        (now.tv_usec - prev_net_time.tv_usec) / 1000000.0;
 
-    if (time_diff > 0 && prev_bytes_in > 0) {
-        // Convert bytes/s to Mb/s (megabits per second): bytes * 8 / 1,000,000
-        net->down = (float)(bytes_in - prev_bytes_in) / time_diff * 8.0f / 1000000.0f;   // Mb/s
-        net->up = (float)(bytes_out - prev_bytes_out) / time_diff * 8.0f / 1000000.0f;   // Mb/s
-    } else {
-        net->down = 0;
-        net->up = 0;
+    // Per-interface deltas; an interface without a previous sample (or
+    // whose counters reset) contributes 0 this tick
+    net->down = 0;
+    net->up = 0;
+    cached_network_detail.interface_count = num_net_counters;
+    for (int i = 0; i < num_net_counters; i++) {
+        const NetCounter *cur = &net_counters[i];
+        const NetCounter *prev = net_find_prev(cur->name);
+        InterfaceStats *out = &cached_network_detail.interfaces[i];
+
+        memcpy(out->name, cur->name, sizeof(out->name));
+        out->bytes_in = cur->bytes_in;
+        out->bytes_out = cur->bytes_out;
+        out->down = 0;
+        out->up = 0;
+
+        if (time_diff > 0 && prev &&
+            cur->bytes_in >= prev->bytes_in && cur->bytes_out >= prev->bytes_out) {
+            // Convert bytes/s to Mb/s (megabits per second): bytes * 8 / 1,000,000
+            out->down = (float)(cur->bytes_in - prev->bytes_in) / time_diff * 8.0f / 1000000.0f;   // Mb/s
+            out->up = (float)(cur->bytes_out - prev->bytes_out) / time_diff * 8.0f / 1000000.0f;   // Mb/s
+        }
+        net->down += out->down;
+        net->up += out->up;
     }
 
-    prev_bytes_in = bytes_in;
-    prev_bytes_out = bytes_out;
+    memcpy(prev_net_counters, net_counters, sizeof(NetCounter) * num_net_counters);
+    num_prev_net_counters = num_net_counters;
     prev_net_time = now;
 }
 
-// Get disk usage
+void get_network_detail(NetworkDetail *detail) {
+    *detail = cached_network_detail;
+}
+
+// Block storage drivers, matched once; their "Statistics" dictionary holds
+// cumulative byte counters since boot
+#define MAX_DISK_DRIVERS 8
+
+static io_service_t disk_drivers[MAX_DISK_DRIVERS];
+static int num_disk_drivers = 0;
+static int disk_drivers_loaded = 0;
+
+// Previous disk bytes for calculating throughput
+static uint64_t prev_disk_read = 0;
+static uint64_t prev_disk_write = 0;
+static struct timeval prev_disk_time;
+
+static void disk_release_drivers(void) {
+    for (int i = 0; i < num_disk_drivers; i++) {
+        IOObjectRelease(disk_drivers[i]);
+    }
+    num_disk_drivers = 0;
+}
+
+// Match IOBlockStorageDriver services (the iterator's references are kept)
+static void disk_load_drivers(void) {
+    disk_release_drivers();
+    disk_drivers_loaded = 1;
+
+    io_iterator_t iter;
+    if (IOServiceGetMatchingServices(kIOMainPortDefault,
+            IOServiceMatching("IOBlockStorageDriver"), &iter) != KERN_SUCCESS) {
+        return;
+    }
+
+    io_service_t service;
+    while ((service = IOIteratorNext(iter)) != 0) {
+        if (num_disk_drivers < MAX_DISK_DRIVERS) {
+            disk_drivers[num_disk_drivers++] = service;
+        } else {
+            IOObjectRelease(service);
+        }
+    }
+    IOObjectRelease(iter);
+}
+
+// Helper: read a 64-bit counter from a CFDictionary
+static uint64_t cfdict_get_u64(CFDictionaryRef dict, CFStringRef key) {
+    CFNumberRef num = CFDictionaryGetValue(dict, key);
+    int64_t value = 0;
+    if (num) CFNumberGetValue(num, kCFNumberSInt64Type, &value);
+    return (uint64_t)value;
+}
+
+// Sum read/write bytes over all drivers, returns -1 if a driver went away
+static int disk_read_counters(uint64_t *bytes_read, uint64_t *bytes_written) {
+    *bytes_read = 0;
+    *bytes_written = 0;
+
+    for (int i = 0; i < num_disk_drivers; i++) {
+        CFDictionaryRef stats = IORegistryEntryCreateCFProperty(disk_drivers[i],
+            CFSTR("Statistics"), kCFAllocatorDefault, 0);
+        metrics_count(PCSTATS_COUNTER_IOREG_CALLS, 1);
+        if (!stats) {
+            metrics_count(PCSTATS_COUNTER_IOREG_ERRORS, 1);
+            return -1;
+        }
+
+        if (CFGetTypeID(stats) == CFDictionaryGetTypeID()) {
+            *bytes_read += cfdict_get_u64(stats, CFSTR("Bytes (Read)"));
+            *bytes_written += cfdict_get_u64(stats, CFSTR("Bytes (Write)"));
+        }
+        CFRelease(stats);
+    }
+    return 0;
+}
+
+// Get disk throughput (MB/s - megabytes per second) into storage->read/write
+void get_disk_throughput(Storage *storage) {
+    uint64_t bytes_read, bytes_written;
+    struct timeval now;
+
+    if (!disk_drivers_loaded) {
+        disk_load_drivers();
+    }
+
+    gettimeofday(&now, NULL);
+
+    if (disk_read_counters(&bytes_read, &bytes_written) != 0) {
+        // A disk was ejected: re-match and restart the delta from scratch
+        disk_load_drivers();
+        disk_read_counters(&bytes_read, &bytes_written);
+        prev_disk_read = 0;
+        prev_disk_write = 0;
+    }
+
+    double time_diff = (now.tv_sec - prev_disk_time.tv_sec) +
+                       (now.tv_usec - prev_disk_time.tv_usec) / 1000000.0;
+
+    if (time_diff > 0 && prev_disk_read > 0 &&
+        bytes_read >= prev_disk_read && bytes_written >= prev_disk_write) {
+        storage->read = (float)(bytes_read - prev_disk_read) / time_diff / 1000000.0f;      // MB/s
+        storage->write = (float)(bytes_written - prev_disk_write) / time_diff / 1000000.0f; // MB/s
+    } else {
+        storage->read = 0;
+        storage->write = 0;
+    }
+
+    prev_disk_read = bytes_read;
+    prev_disk_write = bytes_written;
+    prev_disk_time = now;
+}
+
+// Get disk usage (percent of the boot volume; read/write come from get_disk_throughput)
 void get_disk_usage(Storage *storage) {
     struct statvfs stat;
 
@@ -993,23 +2373,377 @@ void get_disk_usage(Storage *storage) {
         storage->percent = 0;
     }
 
-    // Disk read/write speeds would require IOKit - set to 0 for now
-    storage->read = 0;
-    storage->write = 0;
     storage->temp = 0;
 }
 
-// Get uptime in seconds
-int get_uptime_seconds(void) {
-    struct timeval now;
-    gettimeofday(&now, NULL);
-    return (int)(now.tv_sec - start_time.tv_sec);
+// GPU memory from the first IOAccelerator's "PerformanceStatistics". The
+// service is matched once and re-matched only if it goes away (eGPU).
+static io_service_t gpu_accelerator = 0;
+static int gpu_accelerator_loaded = 0;
+static uint64_t gpu_mem_limit_bytes = 0;
+static float cached_gpu_mem_used = 0.0f;   // GB
+static float cached_gpu_mem_total = 0.0f;
+
+static uint64_t cf_number_or_data_u64(CFTypeRef value) {
+    uint64_t result = 0;
+    if (!value) return 0;
+    if (CFGetTypeID(value) == CFNumberGetTypeID()) {
+        CFNumberGetValue(value, kCFNumberSInt64Type, &result);
+    } else if (CFGetTypeID(value) == CFDataGetTypeID() && CFDataGetLength(value) >= 4) {
+        uint32_t small;  // Some PCI GPUs publish VRAM,totalMB as 4 bytes
+        memcpy(&small, CFDataGetBytePtr(value), sizeof(small));
+        result = small;
+    }
+    return result;
+}
+
+static void gpu_load_accelerator(void) {
+    if (gpu_accelerator) IOObjectRelease(gpu_accelerator);
+    gpu_accelerator = IOServiceGetMatchingService(kIOMainPortDefault, IOServiceMatching("IOAccelerator"));
+    gpu_accelerator_loaded = 1;
+    gpu_mem_limit_bytes = 0;
+    if (!gpu_accelerator) return;
+
+    // Discrete GPUs publish their VRAM on the accelerator or its PCI device
+    CFTypeRef vram = IORegistryEntrySearchCFProperty(gpu_accelerator, kIOServicePlane,
+        CFSTR("VRAM,totalMB"), kCFAllocatorDefault,
+        kIORegistryIterateRecursively | kIORegistryIterateParents);
+    if (vram) {
+        gpu_mem_limit_bytes = cf_number_or_data_u64(vram) << 20;
+        CFRelease(vram);
+    }
+    if (gpu_mem_limit_bytes) return;
+
+    // Unified memory: the GPU may wire up to iogpu.wired_limit_mb, by
+    // default about 2/3 of RAM (3/4 above 36 GB)
+    int limit_mb = 0;
+    size_t len = sizeof(limit_mb);
+    if (sysctlbyname("iogpu.wired_limit_mb", &limit_mb, &len, NULL, 0) == 0 && limit_mb > 0) {
+        gpu_mem_limit_bytes = (uint64_t)limit_mb << 20;
+    } else {
+        if (!cached_page_size) load_memory_invariants();
+        gpu_mem_limit_bytes = cached_total_mem > (36ull << 30)
+            ? cached_total_mem / 4 * 3 : cached_total_mem / 3 * 2;
+    }
+}
+
+// GPU memory in use and available to the GPU (GB), 0 if there is no accelerator
+static void get_gpu_memory(float *used_gb, float *total_gb) {
+    *used_gb = 0;
+    *total_gb = 0;
+    if (!gpu_accelerator_loaded) gpu_load_accelerator();
+    if (!gpu_accelerator) return;
+
+    CFDictionaryRef perf = IORegistryEntryCreateCFProperty(gpu_accelerator,
+        CFSTR("PerformanceStatistics"), kCFAllocatorDefault, 0);
+    metrics_count(PCSTATS_COUNTER_IOREG_CALLS, 1);
+    if (!perf) {
+        metrics_count(PCSTATS_COUNTER_IOREG_ERRORS, 1);
+        gpu_accelerator_loaded = 0;  // Re-match on the next pass
+        return;
+    }
+
+    uint64_t used = 0, total = gpu_mem_limit_bytes;
+    if (CFGetTypeID(perf) == CFDictionaryGetTypeID()) {
+        if (CFDictionaryContainsKey(perf, CFSTR("In use system memory"))) {
+            used = cfdict_get_u64(perf, CFSTR("In use system memory"));     // Apple Silicon
+        } else {
+            used = cfdict_get_u64(perf, CFSTR("vramUsedBytes"));            // AMD/Intel
+            uint64_t free_bytes = cfdict_get_u64(perf, CFSTR("vramFreeBytes"));
+            if (free_bytes) total = used + free_bytes;
+        }
+    }
+    CFRelease(perf);
+
+    *used_gb = (float)used / (1024.0f * 1024.0f * 1024.0f);
+    *total_gb = (float)total / (1024.0f * 1024.0f * 1024.0f);
+}
+
+// ============================================================================
+// Top Processes - per-pid CPU/GPU time, updated in place each pass
+// ============================================================================
+
+// Open addressing keyed by pid (0 = empty slot: kernel_task needs root anyway).
+// Kept below 3/4 full; pids beyond that are not tracked until others exit.
+#define PROC_TABLE_BITS 12
+#define PROC_TABLE_SLOTS (1 << PROC_TABLE_BITS)
+#define PROC_TABLE_MASK (PROC_TABLE_SLOTS - 1)
+#define PROC_TABLE_MAX_USED (PROC_TABLE_SLOTS / 4 * 3)
+
+typedef struct {
+    int pid;
+    uint32_t seen_pass;         // Last pass the pid was listed in
+    uint32_t gpu_pass;          // Last pass gpu_sum was accumulated in
+    uint64_t start_abstime;     // Detects pid reuse
+    uint64_t cpu_ns;            // Cumulative at the previous pass
+    uint64_t gpu_ns;
+    uint64_t gpu_sum;           // GPU time summed over this pass's clients
+    uint64_t footprint;
+    float cpu_percent;
+    float gpu_percent;
+    char name[32];              // Looked up once the pid makes a list
+} ProcEntry;
+
+static _Atomic int processes_enabled = 0;
+static ProcEntry *proc_table = NULL;    // Collecting thread only
+static int *proc_pids = NULL;
+static int proc_used = 0;
+static uint32_t proc_pass = 0;
+static uint64_t proc_prev_ns = 0;
+
+// Published lists, copied out under proc_top_mutex
+static pthread_mutex_t proc_top_mutex = PTHREAD_MUTEX_INITIALIZER;
+static PcProcessStats proc_top[2][PCSTATS_MAX_TOP_PROCESSES];
+static int proc_top_count[2];
+
+static inline uint32_t proc_hash(int pid) {
+    return ((uint32_t)pid * 2654435761u) >> (32 - PROC_TABLE_BITS);
+}
+
+static ProcEntry *proc_find(int pid) {
+    for (uint32_t i = proc_hash(pid); proc_table[i].pid != 0; i = (i + 1) & PROC_TABLE_MASK) {
+        if (proc_table[i].pid == pid) return &proc_table[i];
+    }
+    return NULL;
+}
+
+static ProcEntry *proc_insert(int pid) {
+    if (proc_used >= PROC_TABLE_MAX_USED) return NULL;
+    uint32_t i = proc_hash(pid);
+    while (proc_table[i].pid != 0) i = (i + 1) & PROC_TABLE_MASK;
+    memset(&proc_table[i], 0, sizeof(proc_table[i]));
+    proc_table[i].pid = pid;
+    proc_used++;
+    return &proc_table[i];
+}
+
+// Backward-shift deletion keeps probe chains intact without tombstones
+static void proc_remove(ProcEntry *entry) {
+    uint32_t hole = (uint32_t)(entry - proc_table);
+    uint32_t next = (hole + 1) & PROC_TABLE_MASK;
+    while (proc_table[next].pid != 0) {
+        uint32_t home = proc_hash(proc_table[next].pid);
+        if (((next - home) & PROC_TABLE_MASK) >= ((next - hole) & PROC_TABLE_MASK)) {
+            proc_table[hole] = proc_table[next];
+            hole = next;
+        }
+        next = (next + 1) & PROC_TABLE_MASK;
+    }
+    proc_table[hole].pid = 0;
+    proc_used--;
+}
+
+static void processes_release(void) {
+    free(proc_table);
+    free(proc_pids);
+    proc_table = NULL;
+    proc_pids = NULL;
+    proc_used = 0;
+    proc_prev_ns = 0;
+
+    pthread_mutex_lock(&proc_top_mutex);
+    proc_top_count[0] = proc_top_count[1] = 0;
+    pthread_mutex_unlock(&proc_top_mutex);
+}
+
+static inline uint64_t abstime_to_ns(uint64_t ticks) {
+    static mach_timebase_info_data_t timebase;
+    if (timebase.denom == 0) mach_timebase_info(&timebase);
+    return ticks * timebase.numer / timebase.denom;
+}
+
+// Sum "accumulatedGPUTime" per process over the accelerator's user clients
+static void processes_sample_gpu(void) {
+    if (!gpu_accelerator_loaded) gpu_load_accelerator();
+    if (!gpu_accelerator) return;
+
+    io_iterator_t iter;
+    if (IORegistryEntryGetChildIterator(gpu_accelerator, kIOServicePlane, &iter) != KERN_SUCCESS) {
+        return;
+    }
+    io_registry_entry_t client;
+    while ((client = IOIteratorNext(iter)) != 0) {
+        CFStringRef creator = IORegistryEntryCreateCFProperty(client, CFSTR("IOUserClientCreator"),
+                                                              kCFAllocatorDefault, 0);
+        CFArrayRef usage = IORegistryEntryCreateCFProperty(client, CFSTR("AppUsage"),
+                                                           kCFAllocatorDefault, 0);
+        metrics_count(PCSTATS_COUNTER_IOREG_CALLS, 2);
+        IOObjectRelease(client);
+
+        char text[64];
+        int pid = 0;
+        ProcEntry *entry = NULL;
+        if (creator && CFGetTypeID(creator) == CFStringGetTypeID() &&
+            CFStringGetCString(creator, text, sizeof(text), kCFStringEncodingUTF8) &&
+            sscanf(text, "pid %d", &pid) == 1) {
+            entry = proc_find(pid);
+        }
+        if (entry && usage && CFGetTypeID(usage) == CFArrayGetTypeID()) {
+            if (entry->gpu_pass != proc_pass) {
+                entry->gpu_pass = proc_pass;
+                entry->gpu_sum = 0;
+            }
+            for (CFIndex i = 0; i < CFArrayGetCount(usage); i++) {
+                CFDictionaryRef app = CFArrayGetValueAtIndex(usage, i);
+                if (CFGetTypeID(app) == CFDictionaryGetTypeID()) {
+                    entry->gpu_sum += cfdict_get_u64(app, CFSTR("accumulatedGPUTime"));
+                }
+            }
+        }
+        if (creator) CFRelease(creator);
+        if (usage) CFRelease(usage);
+    }
+    IOObjectRelease(iter);
+}
+
+// Highest `key` first, ties by pid; entries at 0 are left out
+static int proc_select_top(const ProcEntry **top, int sort) {
+    int count = 0;
+    for (int i = 0; i < PROC_TABLE_SLOTS; i++) {
+        const ProcEntry *entry = &proc_table[i];
+        if (entry->pid == 0) continue;
+        float key = sort == PCSTATS_PROCESS_SORT_GPU ? entry->gpu_percent : entry->cpu_percent;
+        if (key <= 0.0f) continue;
+        if (count == PCSTATS_MAX_TOP_PROCESSES) {
+            const ProcEntry *last = top[count - 1];
+            if (key <= (sort == PCSTATS_PROCESS_SORT_GPU ? last->gpu_percent : last->cpu_percent)) continue;
+            count--;
+        }
+        int j = count++;
+        while (j > 0 && key > (sort == PCSTATS_PROCESS_SORT_GPU ? top[j - 1]->gpu_percent
+                                                                : top[j - 1]->cpu_percent)) {
+            top[j] = top[j - 1];
+            j--;
+        }
+        top[j] = entry;
+    }
+    return count;
+}
+
+static void processes_publish(void) {
+    PcProcessStats lists[2][PCSTATS_MAX_TOP_PROCESSES];
+    int counts[2];
+
+    for (int sort = 0; sort < 2; sort++) {
+        const ProcEntry *top[PCSTATS_MAX_TOP_PROCESSES];
+        counts[sort] = proc_select_top(top, sort);
+        for (int i = 0; i < counts[sort]; i++) {
+            ProcEntry *entry = (ProcEntry *)top[i];
+            if (entry->name[0] == '\0' && proc_name(entry->pid, entry->name, sizeof(entry->name)) <= 0) {
+                snprintf(entry->name, sizeof(entry->name), "%d", entry->pid);
+            }
+            PcProcessStats *out = &lists[sort][i];
+            out->pid = entry->pid;
+            memcpy(out->name, entry->name, sizeof(out->name));
+            out->cpu_percent = entry->cpu_percent;
+            out->gpu_percent = entry->gpu_percent;
+            out->footprint_bytes = entry->footprint;
+        }
+    }
+
+    pthread_mutex_lock(&proc_top_mutex);
+    memcpy(proc_top, lists, sizeof(proc_top));
+    memcpy(proc_top_count, counts, sizeof(proc_top_count));
+    pthread_mutex_unlock(&proc_top_mutex);
+}
+
+static void processes_sample(void) {
+    if (!proc_table) {
+        proc_table = calloc(PROC_TABLE_SLOTS, sizeof(ProcEntry));
+        proc_pids = calloc(PROC_TABLE_SLOTS, sizeof(int));
+        if (!proc_table || !proc_pids) {
+            processes_release();
+            return;
+        }
+    }
+
+    uint64_t now_ns = abstime_to_ns(mach_absolute_time());
+    double elapsed_ns = proc_prev_ns ? (double)(now_ns - proc_prev_ns) : 0.0;
+    proc_prev_ns = now_ns;
+    proc_pass++;
+
+    int count = proc_listallpids(proc_pids, PROC_TABLE_SLOTS * (int)sizeof(int));
+    for (int i = 0; i < count && i < PROC_TABLE_SLOTS; i++) {
+        int pid = proc_pids[i];
+        struct rusage_info_v2 info;
+        if (pid <= 0 || proc_pid_rusage(pid, RUSAGE_INFO_V2, (rusage_info_t *)&info) != 0) {
+            continue;  // Exited, or another user's process
+        }
+
+        ProcEntry *entry = proc_find(pid);
+        if (entry && entry->start_abstime != info.ri_proc_start_abstime) {
+            proc_remove(entry);  // Pid was reused
+            entry = NULL;
+        }
+        // rusage times are in mach absolute time units on Apple Silicon
+        uint64_t cpu_ns = abstime_to_ns(info.ri_user_time + info.ri_system_time);
+        if (!entry) {
+            entry = proc_insert(pid);
+            if (!entry) continue;
+            entry->start_abstime = info.ri_proc_start_abstime;
+        } else if (elapsed_ns > 0 && cpu_ns >= entry->cpu_ns) {
+            entry->cpu_percent = (float)((double)(cpu_ns - entry->cpu_ns) / elapsed_ns * 100.0);
+        }
+        entry->cpu_ns = cpu_ns;
+        entry->footprint = info.ri_phys_footprint;
+        entry->seen_pass = proc_pass;
+    }
+
+    processes_sample_gpu();
+
+    // GPU deltas, collecting exited pids into proc_pids (the listing is done)
+    int exited = 0;
+    for (int i = 0; i < PROC_TABLE_SLOTS; i++) {
+        ProcEntry *entry = &proc_table[i];
+        if (entry->pid == 0) continue;
+        if (entry->seen_pass != proc_pass) {
+            proc_pids[exited++] = entry->pid;
+            continue;
+        }
+
+        uint64_t gpu_ns = entry->gpu_pass == proc_pass ? entry->gpu_sum : 0;
+        if (elapsed_ns > 0 && gpu_ns > entry->gpu_ns && entry->gpu_ns > 0) {
+            float percent = (float)((double)(gpu_ns - entry->gpu_ns) / elapsed_ns * 100.0);
+            entry->gpu_percent = percent < 100.0f ? percent : 100.0f;
+        } else {
+            entry->gpu_percent = 0.0f;  // Idle, first seen, or a client closed
+        }
+        entry->gpu_ns = gpu_ns;
+    }
+    // Removing shifts entries, so look each one up again
+    for (int i = 0; i < exited; i++) {
+        ProcEntry *entry = proc_find(proc_pids[i]);
+        if (entry) proc_remove(entry);
+    }
+
+    if (elapsed_ns > 0) processes_publish();
+}
+
+void pcstats_processes_enable(int enable) {
+    atomic_store_explicit(&processes_enabled, enable != 0, memory_order_relaxed);
+}
+
+int pcstats_get_top_processes(PcProcessSort sort, PcProcessStats *out, int max) {
+    if (!out || max <= 0 || (unsigned)sort > PCSTATS_PROCESS_SORT_GPU) return 0;
+
+    pthread_mutex_lock(&proc_top_mutex);
+    int count = proc_top_count[sort] < max ? proc_top_count[sort] : max;
+    memcpy(out, proc_top[sort], (size_t)count * sizeof(*out));
+    pthread_mutex_unlock(&proc_top_mutex);
+    return count;
+}
+
+// Get uptime in seconds
+int get_uptime_seconds(void) {
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    return (int)(now.tv_sec - start_time.tv_sec);
 }
 
 // Cached temperature values
 static float cached_cpu_temp = 0.0f;
 static float cached_gpu_temp = 0.0f;
-static int use_native_temps = 0;  // -t flag enables native temp reading
+static _Atomic int use_native_temps = 0;  // -t flag enables native temp reading
 static int pcstats_initialized = 0;
 
 // ============================================================================
@@ -1023,9 +2757,21 @@ void pcstats_init(void) {
     // Initialize timing
     gettimeofday(&start_time, NULL);
     gettimeofday(&prev_net_time, NULL);
+    prev_disk_time = start_time;
 
-    // Take initial CPU reading to establish baseline
+    // Take initial CPU readings to establish baselines
     get_cpu_usage();
+    load_core_topology();
+    load_memory_invariants();
+    CpuCoreStats cores;
+    get_cpu_core_usage(&cores);
+
+    // Match disk drivers and take the first byte counts
+    Storage disk;
+    get_disk_throughput(&disk);
+
+    // Match the GPU accelerator once; GPU memory and per-process GPU time read it
+    gpu_load_accelerator();
 
     // Take initial IOReport sample (for power/frequency delta)
     ior_sample();
@@ -1043,45 +2789,485 @@ static void update_temperatures_native(void) {
     get_apple_silicon_temps(&cached_cpu_temp, &cached_gpu_temp);
 }
 
-// Get CPU temperature
+// Get CPU temperature (from the latest snapshot once one has been published)
 float get_cpu_temperature(void) {
-    return cached_cpu_temp;
+    PcStatus snap;
+    if (pcstats_snapshot_get(&snap) == 0) return cached_cpu_temp;
+    return snap.cpu.temp;
 }
 
-// Get GPU temperature
+// Get GPU temperature (from the latest snapshot once one has been published)
 float get_gpu_temperature(void) {
-    return cached_gpu_temp;
+    PcStatus snap;
+    if (pcstats_snapshot_get(&snap) == 0) return cached_gpu_temp;
+    return snap.gpu.temp;
 }
 
 // Build JSON string
+// ============================================================================
+// JSON Encoder - fixed-point writer, no locale lookups or allocations
+// ============================================================================
+
+typedef struct {
+    char *pos;
+    char *end;
+    int overflow;
+} JsonWriter;
+
+static void jw_bytes(JsonWriter *w, const char *str, size_t len) {
+    if (w->overflow || (size_t)(w->end - w->pos) < len) {
+        w->overflow = 1;
+        return;
+    }
+    memcpy(w->pos, str, len);
+    w->pos += len;
+}
+
+// Literal key/punctuation (length resolved at compile time)
+#define jw_lit(w, str) jw_bytes((w), (str), sizeof(str) - 1)
+
+static void jw_int(JsonWriter *w, long long value) {
+    char digits[24];
+    int n = 0;
+    unsigned long long mag = value < 0 ? 0ULL - (unsigned long long)value : (unsigned long long)value;
+
+    do {
+        digits[sizeof(digits) - 1 - n++] = (char)('0' + mag % 10);
+        mag /= 10;
+    } while (mag);
+    if (value < 0) digits[sizeof(digits) - 1 - n++] = '-';
+
+    jw_bytes(w, &digits[sizeof(digits) - n], (size_t)n);
+}
+
+// One-decimal fixed point, same as "%.1f" except that exact binary ties
+// (x.25, x.75) round away from zero and -0.0 prints as 0.0.
+// NaN/inf become 0.0 since they aren't valid JSON.
+static void jw_fixed1(JsonWriter *w, float value) {
+    if (value != value || value > 1e15f || value < -1e15f) {
+        value = 0.0f;
+    }
+
+    double scaled = (double)value * 10.0;
+    long long tenths = (long long)(scaled < 0 ? scaled - 0.5 : scaled + 0.5);
+    if (tenths < 0) {
+        jw_lit(w, "-");
+        tenths = -tenths;
+    }
+
+    jw_int(w, tenths / 10);
+    char frac[2] = { '.', (char)('0' + tenths % 10) };
+    jw_bytes(w, frac, 2);
+}
+
+// Emit the device JSON for the given sections (no NUL), returns its length
+// or -1 if it doesn't fit. "cmd" and "time" are always present.
+static int write_status_json_sections(const PcStatus *status, uint32_t sections,
+                                      char *buffer, size_t bufsize) {
+    JsonWriter w = { buffer, buffer + bufsize, 0 };
+
+    jw_lit(&w, "{");
+    if (sections & PCSTATS_SECTION_BOARD) {
+        jw_lit(&w, "\"board\":{\"temp\":");                jw_fixed1(&w, status->board.temp);
+        jw_lit(&w, ",\"rpm\":");                            jw_fixed1(&w, status->board.rpm);
+        jw_lit(&w, ",\"tick\":");                           jw_int(&w, status->board.tick);
+        jw_lit(&w, "},");
+    }
+    if (sections & PCSTATS_SECTION_CPU) {
+        jw_lit(&w, "\"cpu\":{\"temp\":");                  jw_fixed1(&w, status->cpu.temp);
+        jw_lit(&w, ",\"tempMax\":");                        jw_fixed1(&w, status->cpu.tempMax);
+        jw_lit(&w, ",\"load\":");                           jw_fixed1(&w, status->cpu.load);
+        jw_lit(&w, ",\"consume\":");                        jw_fixed1(&w, status->cpu.consume);
+        jw_lit(&w, ",\"tjMax\":");                          jw_int(&w, status->cpu.tjMax);
+        jw_lit(&w, ",\"core1DistanceToTjMax\":");           jw_fixed1(&w, status->cpu.core1DistanceToTjMax);
+        jw_lit(&w, ",\"core1Temp\":");                      jw_fixed1(&w, status->cpu.core1Temp);
+        jw_lit(&w, "},");
+    }
+    if (sections & PCSTATS_SECTION_GPU) {
+        jw_lit(&w, "\"gpu\":{\"temp\":");                  jw_fixed1(&w, status->gpu.temp);
+        jw_lit(&w, ",\"tempMax\":");                        jw_fixed1(&w, status->gpu.tempMax);
+        jw_lit(&w, ",\"load\":");                           jw_fixed1(&w, status->gpu.load);
+        jw_lit(&w, ",\"consume\":");                        jw_fixed1(&w, status->gpu.consume);
+        jw_lit(&w, ",\"rpm\":");                            jw_fixed1(&w, status->gpu.rpm);
+        jw_lit(&w, ",\"memUsed\":");                        jw_fixed1(&w, status->gpu.memUsed);
+        jw_lit(&w, ",\"memTotal\":");                       jw_fixed1(&w, status->gpu.memTotal);
+        jw_lit(&w, ",\"freq\":");                           jw_fixed1(&w, status->gpu.freq);
+        jw_lit(&w, "},");
+    }
+    if (sections & PCSTATS_SECTION_STORAGE) {
+        jw_lit(&w, "\"storage\":{\"temp\":");              jw_fixed1(&w, status->storage.temp);
+        jw_lit(&w, ",\"read\":");                           jw_fixed1(&w, status->storage.read);
+        jw_lit(&w, ",\"write\":");                          jw_fixed1(&w, status->storage.write);
+        jw_lit(&w, ",\"percent\":");                        jw_fixed1(&w, status->storage.percent);
+        jw_lit(&w, "},");
+    }
+    if (sections & PCSTATS_SECTION_MEMORY) {
+        jw_lit(&w, "\"memory\":{\"used\":");               jw_fixed1(&w, status->memory.used);
+        jw_lit(&w, ",\"avail\":");                          jw_fixed1(&w, status->memory.avail);
+        jw_lit(&w, ",\"percent\":");                        jw_fixed1(&w, status->memory.percent);
+        jw_lit(&w, "},");
+    }
+    if (sections & PCSTATS_SECTION_NETWORK) {
+        jw_lit(&w, "\"network\":{\"up\":");                jw_fixed1(&w, status->network.up);
+        jw_lit(&w, ",\"down\":");                           jw_fixed1(&w, status->network.down);
+        jw_lit(&w, "},");
+    }
+    jw_lit(&w, "\"cmd\":1230,\"time\":");                   jw_int(&w, status->time_stamp);
+    jw_lit(&w, "}");
+
+    return w.overflow ? -1 : (int)(w.pos - buffer);
+}
+
+static int write_status_json(const PcStatus *status, char *buffer, size_t bufsize) {
+    return write_status_json_sections(status, PCSTATS_SECTION_ALL, buffer, bufsize);
+}
+
+// Build JSON string (NUL-terminated), returns its length or -1 if it doesn't fit
 int build_json(PcStatus *status, char *buffer, size_t bufsize) {
-    return snprintf(buffer, bufsize,
-        "{"
-        "\"board\":{\"temp\":%.1f,\"rpm\":%.1f,\"tick\":%d},"
-        "\"cpu\":{\"temp\":%.1f,\"tempMax\":%.1f,\"load\":%.1f,\"consume\":%.1f,"
-                "\"tjMax\":%d,\"core1DistanceToTjMax\":%.1f,\"core1Temp\":%.1f},"
-        "\"gpu\":{\"temp\":%.1f,\"tempMax\":%.1f,\"load\":%.1f,\"consume\":%.1f,"
-                "\"rpm\":%.1f,\"memUsed\":%.1f,\"memTotal\":%.1f,\"freq\":%.1f},"
-        "\"storage\":{\"temp\":%.1f,\"read\":%.1f,\"write\":%.1f,\"percent\":%.1f},"
-        "\"memory\":{\"used\":%.1f,\"avail\":%.1f,\"percent\":%.1f},"
-        "\"network\":{\"up\":%.1f,\"down\":%.1f},"
-        "\"cmd\":1230,"
-        "\"time\":%ld"
-        "}",
-        status->board.temp, status->board.rpm, status->board.tick,
-        status->cpu.temp, status->cpu.tempMax, status->cpu.load, status->cpu.consume,
-        status->cpu.tjMax, status->cpu.core1DistanceToTjMax, status->cpu.core1Temp,
-        status->gpu.temp, status->gpu.tempMax, status->gpu.load, status->gpu.consume,
-        status->gpu.rpm, status->gpu.memUsed, status->gpu.memTotal, status->gpu.freq,
-        status->storage.temp, status->storage.read, status->storage.write, status->storage.percent,
-        status->memory.used, status->memory.avail, status->memory.percent,
-        status->network.up, status->network.down,
-        status->time_stamp
-    );
+    if (bufsize == 0) return -1;
+
+    int len = write_status_json(status, buffer, bufsize - 1);
+    if (len < 0) {
+        buffer[0] = '\0';
+        return -1;
+    }
+    buffer[len] = '\0';
+    return len;
+}
+
+// Frame JSON that was written at buffer + PCSTATS_PACKET_HEADER_LEN
+static int finish_packet(uint8_t *buffer, int json_len) {
+    if (json_len < 0 || json_len > 0xFFFF) return -1;
+
+    buffer[0] = 'p';
+    buffer[1] = 'c';
+    buffer[2] = 's';
+    buffer[3] = (json_len >> 8) & 0xFF;  // High byte
+    buffer[4] = json_len & 0xFF;          // Low byte
+
+    return PCSTATS_PACKET_HEADER_LEN + json_len;
+}
+
+// Build a complete stats packet: "pcs" + 2-byte length (big endian) + JSON
+int pcstats_build_packet(const PcStatus *status, uint8_t *buffer, size_t bufsize) {
+    if (bufsize < PCSTATS_PACKET_HEADER_LEN) return -1;
+
+    int json_len = write_status_json(status, (char *)buffer + PCSTATS_PACKET_HEADER_LEN,
+                                     bufsize - PCSTATS_PACKET_HEADER_LEN);
+    return finish_packet(buffer, json_len);
+}
+
+// ============================================================================
+// Binary Frame - fixed layout "pcb" packets, ~6x smaller than JSON
+// ============================================================================
+
+// CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF), bitwise: frames are tiny
+uint16_t pcstats_crc16(const uint8_t *data, size_t len) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+static uint8_t *put_le16(uint8_t *p, uint16_t value) {
+    p[0] = value & 0xFF;
+    p[1] = (value >> 8) & 0xFF;
+    return p + 2;
+}
+
+static uint8_t *put_le32(uint8_t *p, uint32_t value) {
+    p[0] = value & 0xFF;
+    p[1] = (value >> 8) & 0xFF;
+    p[2] = (value >> 16) & 0xFF;
+    p[3] = (value >> 24) & 0xFF;
+    return p + 4;
+}
+
+// value * scale rounded and saturated to int16 (NaN -> 0)
+static uint8_t *put_fixed16(uint8_t *p, float value, float scale) {
+    if (value != value) value = 0.0f;
+    float scaled = value * scale;
+    scaled += scaled < 0 ? -0.5f : 0.5f;
+    int16_t fixed = scaled >= 32767.0f ? INT16_MAX
+                  : scaled <= -32768.0f ? INT16_MIN
+                  : (int16_t)scaled;
+    return put_le16(p, (uint16_t)fixed);
+}
+
+// value * scale rounded and saturated to uint32 (NaN and negatives -> 0)
+static uint8_t *put_ufixed32(uint8_t *p, float value, float scale) {
+    if (!(value > 0.0f)) value = 0.0f;
+    double scaled = (double)value * scale + 0.5;
+    uint32_t fixed = scaled >= 4294967295.0 ? UINT32_MAX : (uint32_t)scaled;
+    return put_le32(p, fixed);
+}
+
+// Version 2 layout (little-endian), see PCSTATS_BINARY_* in pcstats.h:
+//   "pcb" | version u8 | payload length u8 | payload | crc16 over all before it
+// Payload: 22 int16 sensor fields in PcStatus order (tenths unless noted),
+// then storage.read/write and network.up/down as u32 tenths (fast SSDs and
+// 10GbE pass int16's 3276.7), then board.tick and time_stamp as u32.
+int pcstats_build_binary_packet(const PcStatus *status, uint8_t *buffer, size_t bufsize) {
+    if (bufsize < PCSTATS_BINARY_FRAME_LEN) return -1;
+
+    uint8_t *p = buffer;
+    *p++ = 'p';
+    *p++ = 'c';
+    *p++ = 'b';
+    *p++ = PCSTATS_BINARY_VERSION;
+    *p++ = PCSTATS_BINARY_PAYLOAD_LEN;
+
+    p = put_fixed16(p, status->board.temp, 10.0f);
+    p = put_fixed16(p, status->board.rpm, 1.0f);             // RPM
+    p = put_fixed16(p, status->cpu.temp, 10.0f);
+    p = put_fixed16(p, status->cpu.tempMax, 10.0f);
+    p = put_fixed16(p, status->cpu.load, 10.0f);
+    p = put_fixed16(p, status->cpu.consume, 10.0f);
+    p = put_fixed16(p, (float)status->cpu.tjMax, 1.0f);      // °C
+    p = put_fixed16(p, status->cpu.core1DistanceToTjMax, 10.0f);
+    p = put_fixed16(p, status->cpu.core1Temp, 10.0f);
+    p = put_fixed16(p, status->gpu.temp, 10.0f);
+    p = put_fixed16(p, status->gpu.tempMax, 10.0f);
+    p = put_fixed16(p, status->gpu.load, 10.0f);
+    p = put_fixed16(p, status->gpu.consume, 10.0f);
+    p = put_fixed16(p, status->gpu.rpm, 1.0f);               // RPM
+    p = put_fixed16(p, status->gpu.memUsed, 10.0f);
+    p = put_fixed16(p, status->gpu.memTotal, 10.0f);
+    p = put_fixed16(p, status->gpu.freq, 1.0f);              // MHz
+    p = put_fixed16(p, status->storage.temp, 10.0f);
+    p = put_fixed16(p, status->storage.percent, 10.0f);
+    p = put_fixed16(p, status->memory.used, 10.0f);
+    p = put_fixed16(p, status->memory.avail, 10.0f);
+    p = put_fixed16(p, status->memory.percent, 10.0f);
+    p = put_ufixed32(p, status->storage.read, 10.0f);      // MB/s
+    p = put_ufixed32(p, status->storage.write, 10.0f);     // MB/s
+    p = put_ufixed32(p, status->network.up, 10.0f);        // Mb/s
+    p = put_ufixed32(p, status->network.down, 10.0f);      // Mb/s
+    p = put_le32(p, (uint32_t)status->board.tick);
+    p = put_le32(p, (uint32_t)status->time_stamp);
+
+    p = put_le16(p, pcstats_crc16(buffer, (size_t)(p - buffer)));
+    return (int)(p - buffer);
+}
+
+void pcstats_parse_capabilities(const char *content, PcStatsCapabilities *caps) {
+    memset(caps, 0, sizeof(*caps));
+    const char *p = content;
+    while (*p) {
+        while (*p == ' ' || *p == '\t') p++;
+        const char *start = p;
+        while (*p && *p != ',') p++;
+        const char *end = p;
+        while (end > start && (end[-1] == ' ' || end[-1] == '\t')) end--;
+        size_t len = (size_t)(end - start);
+
+        if (len == 4 && memcmp(start, "pcsd", 4) == 0) {
+            caps->partial_json = 1;
+        } else if (len > 3 && len <= 5 && memcmp(start, "pcb", 3) == 0) {
+            int version = 0;
+            const char *digit = start + 3;
+            for (; digit < end && *digit >= '0' && *digit <= '9'; digit++) {
+                version = version * 10 + (*digit - '0');
+            }
+            if (digit == end && version >= 1 && version <= 31) {
+                caps->binary_versions |= 1u << version;
+            }
+        }
+        if (*p == ',') p++;
+    }
+    caps->binary = (caps->binary_versions >> PCSTATS_BINARY_VERSION) & 1;
+}
+
+// ============================================================================
+// Delta Packets - skip sends that would not change the display, or send
+// only the sections that changed when the firmware merges partial updates
+// ============================================================================
+
+// Per-field hysteresis: a field is dirty once it moved this far from the
+// value last sent. Roughly the smallest change the keypad display shows.
+typedef struct {
+    uint32_t section;
+    size_t offset;
+    float threshold;
+} DeltaField;
+
+#define DELTA_FIELD(section, field, threshold) \
+    { section, offsetof(PcStatus, field), threshold }
+
+static const DeltaField delta_fields[] = {
+    DELTA_FIELD(PCSTATS_SECTION_BOARD,   board.temp,             0.5f),   // °C
+    DELTA_FIELD(PCSTATS_SECTION_BOARD,   board.rpm,              50.0f),  // RPM
+    DELTA_FIELD(PCSTATS_SECTION_CPU,     cpu.temp,               0.5f),
+    DELTA_FIELD(PCSTATS_SECTION_CPU,     cpu.tempMax,            0.5f),
+    DELTA_FIELD(PCSTATS_SECTION_CPU,     cpu.load,               1.0f),   // %
+    DELTA_FIELD(PCSTATS_SECTION_CPU,     cpu.consume,            0.5f),   // W
+    DELTA_FIELD(PCSTATS_SECTION_GPU,     gpu.temp,               0.5f),
+    DELTA_FIELD(PCSTATS_SECTION_GPU,     gpu.tempMax,            0.5f),
+    DELTA_FIELD(PCSTATS_SECTION_GPU,     gpu.load,               1.0f),
+    DELTA_FIELD(PCSTATS_SECTION_GPU,     gpu.consume,            0.5f),
+    DELTA_FIELD(PCSTATS_SECTION_GPU,     gpu.rpm,                50.0f),
+    DELTA_FIELD(PCSTATS_SECTION_GPU,     gpu.memUsed,            0.1f),   // GB
+    DELTA_FIELD(PCSTATS_SECTION_GPU,     gpu.memTotal,           0.1f),
+    DELTA_FIELD(PCSTATS_SECTION_GPU,     gpu.freq,               25.0f),  // MHz
+    DELTA_FIELD(PCSTATS_SECTION_STORAGE, storage.temp,           0.5f),
+    DELTA_FIELD(PCSTATS_SECTION_STORAGE, storage.read,           0.5f),   // MB/s
+    DELTA_FIELD(PCSTATS_SECTION_STORAGE, storage.write,          0.5f),
+    DELTA_FIELD(PCSTATS_SECTION_STORAGE, storage.percent,        0.5f),
+    DELTA_FIELD(PCSTATS_SECTION_MEMORY,  memory.used,            0.1f),   // GB
+    DELTA_FIELD(PCSTATS_SECTION_MEMORY,  memory.avail,           0.1f),
+    DELTA_FIELD(PCSTATS_SECTION_MEMORY,  memory.percent,         0.5f),
+    DELTA_FIELD(PCSTATS_SECTION_NETWORK, network.up,             0.1f),   // Mb/s
+    DELTA_FIELD(PCSTATS_SECTION_NETWORK, network.down,           0.1f),
+};
+
+#define DELTA_NUM_FIELDS (sizeof(delta_fields) / sizeof(delta_fields[0]))
+
+// The clock shows minutes, so time alone only dirties the packet once a minute
+#define DELTA_TIME_THRESHOLD_S 60
+
+static float delta_field_value(const PcStatus *status, const DeltaField *field) {
+    float value;
+    memcpy(&value, (const char *)status + field->offset, sizeof(value));
+    return value;
+}
+
+void pcstats_delta_init(PcStatsDelta *delta, uint32_t keyframe_interval) {
+    memset(delta, 0, sizeof(*delta));
+    delta->keyframe_interval = keyframe_interval;
+    delta->max_skipped = PCSTATS_DELTA_DEFAULT_MAX_SKIPPED;
+    delta->threshold_scale = 1.0f;
+}
+
+void pcstats_delta_reset(PcStatsDelta *delta) {
+    delta->has_last_sent = 0;
+    delta->packets_since_keyframe = 0;
+    delta->skipped = 0;
+}
+
+uint32_t pcstats_delta_dirty_sections(const PcStatsDelta *delta, const PcStatus *status) {
+    if (!delta->has_last_sent) return PCSTATS_SECTION_ALL;
+
+    const PcStatus *last = &delta->last_sent;
+    uint32_t dirty = 0;
+
+    for (size_t i = 0; i < DELTA_NUM_FIELDS; i++) {
+        const DeltaField *field = &delta_fields[i];
+        if (dirty & field->section) continue;
+
+        float diff = delta_field_value(status, field) - delta_field_value(last, field);
+        if (diff < 0) diff = -diff;
+        if (diff > field->threshold * delta->threshold_scale ||
+            (delta->threshold_scale == 0.0f && diff != 0.0f)) {
+            dirty |= field->section;
+        }
+    }
+    if (status->cpu.tjMax != last->cpu.tjMax) {
+        dirty |= PCSTATS_SECTION_CPU;
+    }
+    return dirty;
+}
+
+uint32_t pcstats_delta_plan(PcStatsDelta *delta, const PcStatus *status, int flags) {
+    int partial = (flags & PCSTATS_PACKET_PARTIAL) != 0;
+    int binary = (flags & PCSTATS_PACKET_BINARY) != 0;
+
+    uint32_t dirty = pcstats_delta_dirty_sections(delta, status);
+    int time_due = delta->has_last_sent &&
+        (status->time_stamp - delta->last_sent.time_stamp >= DELTA_TIME_THRESHOLD_S ||
+         status->time_stamp < delta->last_sent.time_stamp);
+    int keyframe = !delta->has_last_sent ||
+        (delta->keyframe_interval > 0 && delta->packets_since_keyframe + 1 >= delta->keyframe_interval) ||
+        (delta->max_skipped > 0 && delta->skipped >= delta->max_skipped);
+
+    if (!keyframe && dirty == 0 && !time_due) {
+        delta->skipped++;
+        return 0;
+    }
+
+    // Without partial support any change means a full packet (binary frames
+    // are always complete, they are smaller than most partial JSON packets)
+    if (keyframe || !partial || binary) return PCSTATS_SECTION_ALL;
+    return dirty ? dirty : PCSTATS_SECTION_TIME;  // Only the minute rolled over
+}
+
+void pcstats_delta_mark_sent(PcStatsDelta *delta, const PcStatus *status, uint32_t sections) {
+    int keyframe = !delta->has_last_sent ||
+        (delta->keyframe_interval > 0 && delta->packets_since_keyframe + 1 >= delta->keyframe_interval) ||
+        (delta->max_skipped > 0 && delta->skipped >= delta->max_skipped);
+
+    // Remember what the display now shows: only the sections that went out
+    if (sections == PCSTATS_SECTION_ALL) {
+        delta->last_sent = *status;
+    } else {
+        if (sections & PCSTATS_SECTION_BOARD)   delta->last_sent.board = status->board;
+        if (sections & PCSTATS_SECTION_CPU)     delta->last_sent.cpu = status->cpu;
+        if (sections & PCSTATS_SECTION_GPU)     delta->last_sent.gpu = status->gpu;
+        if (sections & PCSTATS_SECTION_STORAGE) delta->last_sent.storage = status->storage;
+        if (sections & PCSTATS_SECTION_MEMORY)  delta->last_sent.memory = status->memory;
+        if (sections & PCSTATS_SECTION_NETWORK) delta->last_sent.network = status->network;
+        delta->last_sent.time_stamp = status->time_stamp;
+    }
+    delta->has_last_sent = 1;
+    delta->skipped = 0;
+    delta->packets_since_keyframe = keyframe ? 0 : delta->packets_since_keyframe + 1;
+    delta->last_sections = sections & PCSTATS_SECTION_ALL;
+}
+
+int pcstats_build_sections_packet(const PcStatus *status, uint32_t sections,
+                                  uint8_t *buffer, size_t bufsize) {
+    if (bufsize < PCSTATS_PACKET_HEADER_LEN) return -1;
+
+    int json_len = write_status_json_sections(status, sections,
+                                              (char *)buffer + PCSTATS_PACKET_HEADER_LEN,
+                                              bufsize - PCSTATS_PACKET_HEADER_LEN);
+    return finish_packet(buffer, json_len);
+}
+
+int pcstats_delta_build_packet(PcStatsDelta *delta, const PcStatus *status, int flags,
+                               uint8_t *buffer, size_t bufsize) {
+    if (bufsize < PCSTATS_PACKET_HEADER_LEN) return -1;
+
+    uint32_t sections = pcstats_delta_plan(delta, status, flags);
+    if (sections == 0) return 0;
+
+    int len = (flags & PCSTATS_PACKET_BINARY)
+        ? pcstats_build_binary_packet(status, buffer, bufsize)
+        : pcstats_build_sections_packet(status, sections, buffer, bufsize);
+    if (len < 0) return -1;
+
+    pcstats_delta_mark_sent(delta, status, sections);
+    return len;
 }
 
 // Open serial port
 int open_serial(const char *port, int baud) {
+    return open_serial_ex(port, baud, 0, NULL);
+}
+
+// Map to a termios constant, 0 if the rate needs IOSSIOSPEED
+static speed_t standard_speed(int baud) {
+    switch (baud) {
+        case 9600:   return B9600;
+        case 19200:  return B19200;
+        case 38400:  return B38400;
+        case 57600:  return B57600;
+        case 115200: return B115200;
+        case 230400: return B230400;
+        default:     return 0;
+    }
+}
+
+// Open serial port at any baud rate; rates without a termios constant are
+// set with IOSSIOSPEED. latency_us > 0 also sets the driver's receive
+// latency (IOSSDATALAT) so short replies aren't held back.
+int open_serial_ex(const char *port, int baud, uint32_t latency_us, int *applied_baud) {
+    if (applied_baud) *applied_baud = 0;
+    if (baud <= 0) baud = 115200;
+
     int fd = open(port, O_RDWR | O_NOCTTY | O_NONBLOCK);
     if (fd < 0) {
         perror("open serial port");
@@ -1091,19 +3277,10 @@ int open_serial(const char *port, int baud) {
     struct termios options;
     tcgetattr(fd, &options);
 
-    // Set baud rate
-    speed_t speed;
-    switch (baud) {
-        case 9600:   speed = B9600; break;
-        case 19200:  speed = B19200; break;
-        case 38400:  speed = B38400; break;
-        case 57600:  speed = B57600; break;
-        case 115200: speed = B115200; break;
-        case 230400: speed = B230400; break;
-        default:     speed = B115200; break;
-    }
-    cfsetispeed(&options, speed);
-    cfsetospeed(&options, speed);
+    // Set baud rate (placeholder for custom rates, replaced by IOSSIOSPEED below)
+    speed_t speed = standard_speed(baud);
+    cfsetispeed(&options, speed ? speed : B9600);
+    cfsetospeed(&options, speed ? speed : B9600);
 
     // 8N1, no flow control
     options.c_cflag &= ~PARENB;
@@ -1124,8 +3301,28 @@ int open_serial(const char *port, int baud) {
     options.c_cc[VTIME] = 10;
 
     tcsetattr(fd, TCSANOW, &options);
+
+    // IOSSIOSPEED must come after tcsetattr, which would reset it
+    if (!speed) {
+        speed_t custom = (speed_t)baud;
+        if (ioctl(fd, IOSSIOSPEED, &custom) == -1) {
+            perror("IOSSIOSPEED");
+        }
+    }
+    if (latency_us > 0) {
+        unsigned long latency = latency_us;
+        if (ioctl(fd, IOSSDATALAT, &latency) == -1) {
+            perror("IOSSDATALAT");
+        }
+    }
+
     tcflush(fd, TCIOFLUSH);
 
+    // Report what the driver actually runs at (speed_t is the numeric rate on macOS)
+    if (applied_baud && tcgetattr(fd, &options) == 0) {
+        *applied_baud = (int)cfgetospeed(&options);
+    }
+
     // Clear non-blocking
     int flags = fcntl(fd, F_GETFL, 0);
     fcntl(fd, F_SETFL, flags & ~O_NONBLOCK);
@@ -1134,88 +3331,1376 @@ int open_serial(const char *port, int baud) {
 }
 
 // Send PC status to device
-int send_pc_status(int fd, PcStatus *status) {
-    char json_buffer[2048];
-    int json_len = build_json(status, json_buffer, sizeof(json_buffer));
-
-    if (json_len < 0 || (size_t)json_len >= sizeof(json_buffer)) {
-        fprintf(stderr, "JSON buffer overflow\n");
+// Write all of buf, resuming after short writes. On a nonblocking fd waits
+// up to timeout_ms for the device to drain. Returns 0, or -1 on error/timeout.
+int serial_write_all(int fd, const uint8_t *buf, size_t len, int timeout_ms) {
+    while (len > 0) {
+        ssize_t n = write(fd, buf, len);
+        if (n > 0) {
+            buf += n;
+            len -= (size_t)n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && errno == EAGAIN) {
+            struct pollfd pfd = { .fd = fd, .events = POLLOUT };
+            if (poll(&pfd, 1, timeout_ms) > 0) continue;
+        }
         return -1;
     }
+    return 0;
+}
 
-    // Protocol: "pcs" + 2-byte length (big endian) + JSON
-    unsigned char header[5];
-    header[0] = 'p';
-    header[1] = 'c';
-    header[2] = 's';
-    header[3] = (json_len >> 8) & 0xFF;  // High byte
-    header[4] = json_len & 0xFF;          // Low byte
+int send_pc_status(int fd, PcStatus *status) {
+    uint8_t packet[PCSTATS_MAX_PACKET_LEN];
+    int packet_len = pcstats_build_packet(status, packet, sizeof(packet));
 
-    // Send header
-    if (write(fd, header, 5) != 5) {
-        perror("write header");
+    if (packet_len < 0) {
+        fprintf(stderr, "JSON buffer overflow\n");
         return -1;
     }
 
-    // Send JSON
-    if (write(fd, json_buffer, json_len) != json_len) {
-        perror("write json");
+    // Protocol: "pcs" + 2-byte length (big endian) + JSON, header built in place
+    uint64_t started = metrics_start();
+    int result = serial_write_all(fd, packet, (size_t)packet_len, 1000);
+    metrics_stop(PCSTATS_TIMER_SERIAL_SEND, started);
+    if (result != 0) {
+        // serial_write_all doesn't report how much went out before the error
+        metrics_count(PCSTATS_COUNTER_SERIAL_ERRORS, 1);
+        metrics_count(PCSTATS_COUNTER_SERIAL_BYTES_DROPPED, (uint64_t)packet_len);
+        perror("write packet");
         return -1;
     }
+    metrics_count(PCSTATS_COUNTER_SERIAL_BYTES_SENT, (uint64_t)packet_len);
 
     return 0;
 }
 
-// Collect all system stats
-void collect_stats(PcStatus *status) {
-    // Time - adjust for local timezone
-    // Device displays timestamp as UTC, so we send local time "as if" it were UTC
-    time_t now = time(NULL);
-    struct tm *local = localtime(&now);
-    status->time_stamp = now + local->tm_gmtoff - 3600;
+// Set or clear O_NONBLOCK (open_serial() returns a blocking fd)
+int serial_set_nonblocking(int fd, int enable) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0) return -1;
+    flags = enable ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK);
+    return fcntl(fd, F_SETFL, flags);
+}
+
+// ============================================================================
+// Serial Transmit Queue - nonblocking sends that never stall the caller
+// ============================================================================
+
+static uint64_t get_monotonic_ms(void);
+
+void serial_txq_init(SerialTxQueue *queue) {
+    memset(queue, 0, sizeof(*queue));
+}
 
-    // Update temperatures and power/frequency using native IOKit
-    if (use_native_temps) {
-        update_temperatures_native();
-        ior_sample();  // Update power and frequency
+int serial_txq_push(SerialTxQueue *queue, const uint8_t *data, size_t len) {
+    if (len == 0 || len > PCSTATS_MAX_PACKET_LEN) return -1;
+
+    int dropped = 0;
+    if (queue->count == PCSTATS_TXQ_SLOTS) {
+        // Drop the oldest frame that hasn't started going out; the head may be
+        // half written and must finish or the device loses framing
+        int victim = queue->slots[queue->head].offset > 0 ? 1 : 0;
+        metrics_count(PCSTATS_COUNTER_SERIAL_BYTES_DROPPED,
+                      queue->slots[(queue->head + victim) % PCSTATS_TXQ_SLOTS].len);
+        for (int k = victim; k < queue->count - 1; k++) {
+            int i = (queue->head + k) % PCSTATS_TXQ_SLOTS;
+            queue->slots[i] = queue->slots[(i + 1) % PCSTATS_TXQ_SLOTS];
+        }
+        queue->tail = (queue->tail + PCSTATS_TXQ_SLOTS - 1) % PCSTATS_TXQ_SLOTS;
+        queue->count--;
+        queue->dropped++;
+        dropped = 1;
     }
 
-    // Board - get fan RPM from SMC
-    FanInfo fans;
-    get_fan_info(&fans);
-    status->board.tick = get_uptime_seconds();
-    status->board.temp = smc_get_board_temperature();
-    status->board.rpm = (fans.count > 0) ? fans.rpm[0] : 0;  // System fan 1
+    SerialTxSlot *slot = &queue->slots[queue->tail];
+    memcpy(slot->data, data, len);
+    slot->len = (uint16_t)len;
+    slot->offset = 0;
+    queue->tail = (queue->tail + 1) % PCSTATS_TXQ_SLOTS;
+    queue->count++;
+    return dropped;
+}
 
-    // CPU
-    status->cpu.load = get_cpu_usage();
-    status->cpu.temp = get_cpu_temperature();
-    status->cpu.core1Temp = status->cpu.temp;
-    status->cpu.tempMax = 100.0f;  // Typical max
-    status->cpu.tjMax = 100;
-    status->cpu.core1DistanceToTjMax = status->cpu.tjMax - status->cpu.temp;
-    status->cpu.consume = get_cpu_power();  // Power in Watts from IOReport
+int serial_txq_flush(SerialTxQueue *queue, int fd) {
+    while (queue->count > 0) {
+        // Gather every queued frame into one writev
+        struct iovec iov[PCSTATS_TXQ_SLOTS];
+        int iovcnt = 0;
+        for (int i = 0, idx = queue->head; i < queue->count; i++, idx = (idx + 1) % PCSTATS_TXQ_SLOTS) {
+            SerialTxSlot *slot = &queue->slots[idx];
+            iov[iovcnt].iov_base = slot->data + slot->offset;
+            iov[iovcnt].iov_len = slot->len - slot->offset;
+            iovcnt++;
+        }
 
-    // GPU - get temp from SMC/HID, power/freq from IOReport
-    status->gpu.temp = get_gpu_temperature();
-    status->gpu.tempMax = 100.0f;
-    status->gpu.load = get_gpu_load();      // GPU usage % from IOReport
-    status->gpu.consume = get_gpu_power();  // Power in Watts from IOReport
-    status->gpu.rpm = (fans.count > 1) ? fans.rpm[1] : 0;  // System fan 2 (if available)
-    status->gpu.memUsed = 0;
-    status->gpu.memTotal = 0;
-    status->gpu.freq = get_gpu_freq();      // Frequency in MHz from IOReport
+        ssize_t n = writev(fd, iov, iovcnt);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN) break;  // Device is slow: keep the rest queued
+            metrics_count(PCSTATS_COUNTER_SERIAL_ERRORS, 1);
+            return -1;
+        }
+        metrics_count(PCSTATS_COUNTER_SERIAL_BYTES_SENT, (uint64_t)n);
+
+        // Retire fully written frames, remember where a partial one stopped
+        size_t written = (size_t)n;
+        while (written > 0 && queue->count > 0) {
+            SerialTxSlot *slot = &queue->slots[queue->head];
+            size_t remaining = slot->len - slot->offset;
+            if (written < remaining) {
+                slot->offset += (uint16_t)written;
+                break;
+            }
+            written -= remaining;
+            queue->head = (queue->head + 1) % PCSTATS_TXQ_SLOTS;
+            queue->count--;
+        }
+        if (n == 0) break;
+    }
 
-    // Storage
-    get_disk_usage(&status->storage);
+    size_t pending = 0;
+    for (int i = 0, idx = queue->head; i < queue->count; i++, idx = (idx + 1) % PCSTATS_TXQ_SLOTS) {
+        pending += queue->slots[idx].len - queue->slots[idx].offset;
+    }
+    return (int)pending;
+}
 
-    // Memory
-    get_memory_usage(&status->memory);
+int serial_txq_drain(SerialTxQueue *queue, int fd, int timeout_ms) {
+    uint64_t deadline = get_monotonic_ms() + (uint64_t)(timeout_ms > 0 ? timeout_ms : 0);
+    for (;;) {
+        int pending = serial_txq_flush(queue, fd);
+        if (pending <= 0) return pending;
 
-    // Network
-    get_network_throughput(&status->network);
+        uint64_t now = get_monotonic_ms();
+        if (now >= deadline) return -1;
+        struct pollfd pfd = { .fd = fd, .events = POLLOUT };
+        if (poll(&pfd, 1, (int)(deadline - now)) < 0 && errno != EINTR) return -1;
+    }
+}
 
-    status->cmd = 1230;
+int send_pc_status_queued(SerialTxQueue *queue, int fd, PcStatus *status) {
+    uint8_t packet[PCSTATS_MAX_PACKET_LEN];
+    int packet_len = pcstats_build_packet(status, packet, sizeof(packet));
+    if (packet_len < 0) return -1;
+
+    uint64_t started = metrics_start();
+    serial_txq_push(queue, packet, (size_t)packet_len);
+    int pending = serial_txq_flush(queue, fd);
+    metrics_stop(PCSTATS_TIMER_SERIAL_SEND, started);
+    return pending;
+}
+
+// ============================================================================
+// Collector Scheduler - each source has its own period, a tick only pays
+// for the sources that are due and reuses cached values for the rest
+// ============================================================================
+
+// A due check accepts ticks this early, so timer jitter doesn't push a
+// collector whose period equals the tick interval to every other tick
+#define COLLECTOR_SLACK_MS 100
+
+typedef struct {
+    _Atomic uint32_t period_ms;    // 0 = every tick
+    uint64_t last_ms;              // 0 = never sampled
+} CollectorSchedule;
+
+static CollectorSchedule collector_schedule[PCSTATS_COLLECTOR_COUNT] = {
+    [PCSTATS_COLLECTOR_TEMPS]   = { 2000, 0 },
+    [PCSTATS_COLLECTOR_FANS]    = { 5000, 0 },
+    [PCSTATS_COLLECTOR_POWER]   = { 0, 0 },
+    [PCSTATS_COLLECTOR_CPU]     = { 0, 0 },
+    [PCSTATS_COLLECTOR_MEMORY]  = { 2000, 0 },
+    [PCSTATS_COLLECTOR_NETWORK] = { 0, 0 },
+    [PCSTATS_COLLECTOR_DISK]    = { 60000, 0 },
+    [PCSTATS_COLLECTOR_DISK_IO] = { 0, 0 },
+    [PCSTATS_COLLECTOR_PROCESSES] = { 3000, 0 },
+};
+
+// Latest output of each collector, reused on ticks where it isn't due
+static FanInfo cached_fans;
+static float cached_board_temp = 0.0f;
+static float cached_cpu_load = 0.0f;
+static Memory cached_memory;
+static Network cached_network;
+static Storage cached_storage;
+static CpuCoreStats cached_cores;
+
+// Monotonic milliseconds (not affected by wall clock changes)
+static uint64_t get_monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+// Returns 1 (and records the sample time) if the collector should run this tick
+static int collector_due(PcCollector collector, uint64_t now_ms) {
+    CollectorSchedule *sched = &collector_schedule[collector];
+    uint32_t period = atomic_load_explicit(&sched->period_ms, memory_order_relaxed);
+
+    if (sched->last_ms != 0 && now_ms + COLLECTOR_SLACK_MS < sched->last_ms + period) {
+        return 0;
+    }
+    sched->last_ms = now_ms;
+    return 1;
+}
+
+void pcstats_set_collector_period(PcCollector collector, uint32_t period_ms) {
+    if ((unsigned)collector >= PCSTATS_COLLECTOR_COUNT) return;
+    atomic_store_explicit(&collector_schedule[collector].period_ms, period_ms, memory_order_relaxed);
+}
+
+uint32_t pcstats_get_collector_period(PcCollector collector) {
+    if ((unsigned)collector >= PCSTATS_COLLECTOR_COUNT) return 0;
+    return atomic_load_explicit(&collector_schedule[collector].period_ms, memory_order_relaxed);
+}
+
+// Collect all system stats (sources that are not due keep their last value)
+void collect_stats(PcStatus *status) {
+    collect_stats_ext(status, NULL);
+}
+
+// Copy the IOReport cluster residencies into the extended stats
+static void fill_cluster_stats(CpuCoreStats *cores) {
+    cores->cluster_count = cached_cluster_count;
+    for (int i = 0; i < cached_cluster_count; i++) {
+        memcpy(cores->cluster_name[i], cached_cluster_name[i], sizeof(cores->cluster_name[i]));
+        cores->cluster_freq[i] = cached_cluster_freq[i];
+        cores->cluster_load[i] = cached_cluster_load[i];
+    }
+}
+
+static _Atomic int ior_paused = 0;
+
+void pcstats_set_ioreport_paused(int paused) {
+    atomic_store_explicit(&ior_paused, paused ? 1 : 0, memory_order_relaxed);
+}
+
+// Record/replay (see "Record / Replay" below)
+static int replay_next(PcStatsReplayFrame *frame, uint64_t *now_ms);
+static void record_frame(const PcStatus *status, uint64_t now_ms);
+static _Atomic int record_active = 0;
+
+// Run the collectors that are due against the hardware
+static void collect_hardware(uint64_t now_ms) {
+    // Temperatures (SMC/HID) and motherboard sensors
+    if (collector_due(PCSTATS_COLLECTOR_TEMPS, now_ms)) {
+        if (use_native_temps) {
+            update_temperatures_native();
+        }
+        cached_board_temp = smc_get_board_temperature();
+    }
+
+    // Power/frequency from IOReport (energy is a delta over its own window).
+    // Released on the collecting thread, which owns the IOReport state.
+    if (atomic_load_explicit(&ior_paused, memory_order_relaxed)) {
+        if (ior_initialized) ior_release();
+    } else if (use_native_temps && collector_due(PCSTATS_COLLECTOR_POWER, now_ms)) {
+        ior_sample();
+    }
+
+    if (collector_due(PCSTATS_COLLECTOR_FANS, now_ms)) {
+        get_fan_info(&cached_fans);
+    }
+    if (collector_due(PCSTATS_COLLECTOR_CPU, now_ms)) {
+        uint64_t started = metrics_start();
+        cached_cpu_load = get_cpu_usage();
+        get_cpu_core_usage(&cached_cores);
+        metrics_stop(PCSTATS_TIMER_CPU, started);
+    }
+    if (collector_due(PCSTATS_COLLECTOR_DISK, now_ms)) {
+        uint64_t started = metrics_start();
+        get_disk_usage(&cached_storage);
+        metrics_stop(PCSTATS_TIMER_DISK_USAGE, started);
+    }
+    if (collector_due(PCSTATS_COLLECTOR_DISK_IO, now_ms)) {
+        uint64_t started = metrics_start();
+        get_disk_throughput(&cached_storage);
+        metrics_stop(PCSTATS_TIMER_DISK_IO, started);
+    }
+    if (collector_due(PCSTATS_COLLECTOR_MEMORY, now_ms)) {
+        uint64_t started = metrics_start();
+        get_memory_usage(&cached_memory);
+        get_gpu_memory(&cached_gpu_mem_used, &cached_gpu_mem_total);
+        metrics_stop(PCSTATS_TIMER_MEMORY, started);
+    }
+    if (collector_due(PCSTATS_COLLECTOR_NETWORK, now_ms)) {
+        get_network_throughput(&cached_network);
+    }
+
+    // Freed on the collecting thread, which owns the pid table
+    if (!atomic_load_explicit(&processes_enabled, memory_order_relaxed)) {
+        if (proc_table) processes_release();
+    } else if (collector_due(PCSTATS_COLLECTOR_PROCESSES, now_ms)) {
+        uint64_t started = metrics_start();
+        processes_sample();
+        metrics_stop(PCSTATS_TIMER_PROCESSES, started);
+    }
+}
+
+// Same schedule, taking each due collector's output from a recorded frame
+static void collect_replayed(const PcStatsReplayFrame *frame, uint64_t now_ms) {
+    if (collector_due(PCSTATS_COLLECTOR_TEMPS, now_ms)) {
+        cached_cpu_temp = frame->cpu_temp;
+        cached_gpu_temp = frame->gpu_temp;
+        cached_board_temp = frame->board_temp;
+    }
+    if (collector_due(PCSTATS_COLLECTOR_POWER, now_ms)) {
+        cached_cpu_power = frame->cpu_power;
+        cached_gpu_power = frame->gpu_power;
+        cached_gpu_freq = frame->gpu_freq;
+        cached_gpu_load = frame->gpu_load;
+        cached_cluster_count = frame->cores.cluster_count;
+        memcpy(cached_cluster_name, frame->cores.cluster_name, sizeof(cached_cluster_name));
+        memcpy(cached_cluster_freq, frame->cores.cluster_freq, sizeof(cached_cluster_freq));
+        memcpy(cached_cluster_load, frame->cores.cluster_load, sizeof(cached_cluster_load));
+    }
+    if (collector_due(PCSTATS_COLLECTOR_FANS, now_ms)) {
+        cached_fans = frame->fans;
+    }
+    if (collector_due(PCSTATS_COLLECTOR_CPU, now_ms)) {
+        cached_cpu_load = frame->cpu_load;
+        cached_cores = frame->cores;
+    }
+    if (collector_due(PCSTATS_COLLECTOR_DISK, now_ms)) {
+        cached_storage.percent = frame->storage.percent;
+    }
+    if (collector_due(PCSTATS_COLLECTOR_DISK_IO, now_ms)) {
+        cached_storage.read = frame->storage.read;
+        cached_storage.write = frame->storage.write;
+    }
+    if (collector_due(PCSTATS_COLLECTOR_MEMORY, now_ms)) {
+        cached_memory = frame->memory;
+        cached_memory_detail = frame->memory_detail;
+        cached_gpu_mem_used = frame->gpu_mem_used;
+        cached_gpu_mem_total = frame->gpu_mem_total;
+    }
+    if (collector_due(PCSTATS_COLLECTOR_NETWORK, now_ms)) {
+        cached_network = frame->network;
+        cached_network_detail = frame->network_detail;
+    }
+}
+
+void collect_stats_ext(PcStatus *status, PcStatusExt *ext) {
+    uint64_t now_ms = get_monotonic_ms();
+    uint64_t tick_started = metrics_start();
+    PcStatsReplayFrame frame;
+    int replaying = replay_next(&frame, &now_ms);
+
+    if (replaying) {
+        collect_replayed(&frame, now_ms);
+        status->time_stamp = frame.time_stamp;
+        status->board.tick = frame.uptime_seconds;
+    } else {
+        collect_hardware(now_ms);
+
+        // Time - adjust for local timezone
+        // Device displays timestamp as UTC, so we send local time "as if" it were UTC
+        time_t now = time(NULL);
+        struct tm *local = localtime(&now);
+        status->time_stamp = now + local->tm_gmtoff - 3600;
+        status->board.tick = get_uptime_seconds();
+    }
+
+    // Board - fan RPM from SMC
+    status->board.temp = cached_board_temp;
+    status->board.rpm = (cached_fans.count > 0) ? cached_fans.rpm[0] : 0;  // System fan 1
+
+    // CPU
+    status->cpu.load = cached_cpu_load;
+    status->cpu.temp = cached_cpu_temp;
+    status->cpu.core1Temp = status->cpu.temp;
+    status->cpu.tempMax = 100.0f;  // Typical max
+    status->cpu.tjMax = 100;
+    status->cpu.core1DistanceToTjMax = status->cpu.tjMax - status->cpu.temp;
+    status->cpu.consume = get_cpu_power();  // Power in Watts from IOReport
+
+    // GPU - get temp from SMC/HID, power/freq from IOReport
+    status->gpu.temp = cached_gpu_temp;
+    status->gpu.tempMax = 100.0f;
+    status->gpu.load = get_gpu_load();      // GPU usage % from IOReport
+    status->gpu.consume = get_gpu_power();  // Power in Watts from IOReport
+    status->gpu.rpm = (cached_fans.count > 1) ? cached_fans.rpm[1] : 0;  // System fan 2 (if available)
+    status->gpu.memUsed = cached_gpu_mem_used;
+    status->gpu.memTotal = cached_gpu_mem_total;
+    status->gpu.freq = get_gpu_freq();      // Frequency in MHz from IOReport
+
+    status->storage = cached_storage;
+    status->memory = cached_memory;
+    status->network = cached_network;
+
+    status->cmd = 1230;
+
+    if (ext) {
+        ext->cores = cached_cores;
+        fill_cluster_stats(&ext->cores);
+        get_network_detail(&ext->network);
+        get_memory_detail(&ext->memory);
+    }
+    if (!replaying && atomic_load_explicit(&record_active, memory_order_relaxed)) {
+        record_frame(status, now_ms);
+    }
+    metrics_stop(PCSTATS_TIMER_TICK, tick_started);
+}
+
+// ============================================================================
+// Record / Replay - collector outputs to and from a file
+// ============================================================================
+
+typedef struct {
+    uint32_t magic;         // PCSTATS_REPLAY_MAGIC
+    uint16_t version;       // PCSTATS_REPLAY_VERSION
+    uint16_t header_size;
+    uint32_t frame_size;    // sizeof(PcStatsReplayFrame) of the writer
+    uint32_t reserved;
+} ReplayFileHeader;
+
+static pthread_mutex_t record_mutex = PTHREAD_MUTEX_INITIALIZER;
+static FILE *record_file = NULL;
+static uint64_t record_start_ms = 0;
+
+// Replay state, guarded by replay_mutex; replay_active gates the lookup
+// so live sampling doesn't take the mutex
+static pthread_mutex_t replay_mutex = PTHREAD_MUTEX_INITIALIZER;
+static PcStatsReplayFrame *replay_frames = NULL;
+static int replay_count = 0;
+static int replay_index = 0;            // Next frame to serve
+static int replay_consumed = 0;
+static int replay_loop = 0;
+static uint64_t replay_epoch_ms = 0;    // Replay clock origin on the monotonic clock
+static uint64_t replay_loop_offset_ms = 0;
+static _Atomic int replay_active = 0;
+
+// Set when switching between live and replayed sampling; the collecting
+// thread clears last_ms itself since it owns the schedule
+static _Atomic int schedule_reset_pending = 0;
+
+int pcstats_record_start(const char *path) {
+    pthread_mutex_lock(&record_mutex);
+    if (record_file) {
+        pthread_mutex_unlock(&record_mutex);
+        return -1;
+    }
+
+    FILE *file = fopen(path, "wb");
+    ReplayFileHeader header = {
+        .magic = PCSTATS_REPLAY_MAGIC,
+        .version = PCSTATS_REPLAY_VERSION,
+        .header_size = sizeof(ReplayFileHeader),
+        .frame_size = sizeof(PcStatsReplayFrame),
+    };
+    if (!file || fwrite(&header, sizeof(header), 1, file) != 1) {
+        if (file) fclose(file);
+        pthread_mutex_unlock(&record_mutex);
+        return -1;
+    }
+
+    record_file = file;
+    record_start_ms = 0;
+    atomic_store_explicit(&record_active, 1, memory_order_relaxed);
+    pthread_mutex_unlock(&record_mutex);
+    return 0;
+}
+
+void pcstats_record_stop(void) {
+    pthread_mutex_lock(&record_mutex);
+    atomic_store_explicit(&record_active, 0, memory_order_relaxed);
+    if (record_file) {
+        fclose(record_file);
+        record_file = NULL;
+    }
+    pthread_mutex_unlock(&record_mutex);
+}
+
+// Append the collectors' current outputs (called after a live pass)
+static void record_frame(const PcStatus *status, uint64_t now_ms) {
+    PcStatsReplayFrame frame;
+    memset(&frame, 0, sizeof(frame));
+
+    pthread_mutex_lock(&record_mutex);
+    if (!record_file) {
+        pthread_mutex_unlock(&record_mutex);
+        return;
+    }
+    if (record_start_ms == 0) record_start_ms = now_ms;
+
+    frame.offset_ms = now_ms - record_start_ms;
+    frame.time_stamp = status->time_stamp;
+    frame.uptime_seconds = status->board.tick;
+    frame.cpu_temp = cached_cpu_temp;
+    frame.gpu_temp = cached_gpu_temp;
+    frame.board_temp = cached_board_temp;
+    frame.fans = cached_fans;
+    frame.cpu_power = cached_cpu_power;
+    frame.gpu_power = cached_gpu_power;
+    frame.gpu_freq = cached_gpu_freq;
+    frame.gpu_load = cached_gpu_load;
+    frame.gpu_mem_used = cached_gpu_mem_used;
+    frame.gpu_mem_total = cached_gpu_mem_total;
+    frame.cpu_load = cached_cpu_load;
+    frame.cores = cached_cores;
+    fill_cluster_stats(&frame.cores);
+    frame.memory = cached_memory;
+    frame.memory_detail = cached_memory_detail;
+    frame.network = cached_network;
+    frame.network_detail = cached_network_detail;
+    frame.storage = cached_storage;
+
+    // Out of space: stop instead of leaving torn frames behind
+    if (fwrite(&frame, sizeof(frame), 1, record_file) != 1) {
+        fclose(record_file);
+        record_file = NULL;
+        atomic_store_explicit(&record_active, 0, memory_order_relaxed);
+    }
+    pthread_mutex_unlock(&record_mutex);
+}
+
+// Swap in a new set of frames (NULL = back to live sampling), taking ownership
+static void replay_install(PcStatsReplayFrame *frames, int count, int loop) {
+    pthread_mutex_lock(&replay_mutex);
+    free(replay_frames);
+    replay_frames = frames;
+    replay_count = count;
+    replay_index = 0;
+    replay_consumed = 0;
+    replay_loop = loop;
+    replay_epoch_ms = get_monotonic_ms();
+    replay_loop_offset_ms = 0;
+    atomic_store_explicit(&schedule_reset_pending, 1, memory_order_relaxed);
+    atomic_store_explicit(&replay_active, frames != NULL, memory_order_release);
+    pthread_mutex_unlock(&replay_mutex);
+}
+
+int pcstats_replay_load(const PcStatsReplayFrame *frames, int count, int loop) {
+    if (!frames || count < 1) return -1;
+
+    PcStatsReplayFrame *copy = malloc(sizeof(PcStatsReplayFrame) * (size_t)count);
+    if (!copy) return -1;
+    memcpy(copy, frames, sizeof(PcStatsReplayFrame) * (size_t)count);
+
+    replay_install(copy, count, loop);
+    return count;
+}
+
+int pcstats_replay_open(const char *path, int loop) {
+    FILE *file = fopen(path, "rb");
+    if (!file) return -1;
+
+    ReplayFileHeader header;
+    long size = -1;
+    if (fread(&header, sizeof(header), 1, file) == 1 && fseek(file, 0, SEEK_END) == 0) {
+        size = ftell(file);
+    }
+    if (size < 0 || header.magic != PCSTATS_REPLAY_MAGIC || header.version != PCSTATS_REPLAY_VERSION ||
+        header.header_size < sizeof(header) || header.frame_size != sizeof(PcStatsReplayFrame) ||
+        size < (long)header.header_size) {
+        fclose(file);
+        return -1;
+    }
+
+    long count = (size - header.header_size) / (long)sizeof(PcStatsReplayFrame);
+    PcStatsReplayFrame *frames = count > 0 && count <= INT32_MAX
+        ? malloc(sizeof(PcStatsReplayFrame) * (size_t)count) : NULL;
+    if (!frames || fseek(file, header.header_size, SEEK_SET) != 0 ||
+        fread(frames, sizeof(PcStatsReplayFrame), (size_t)count, file) != (size_t)count) {
+        free(frames);
+        fclose(file);
+        return -1;
+    }
+    fclose(file);
+
+    replay_install(frames, (int)count, loop);
+    return (int)count;
+}
+
+void pcstats_replay_close(void) {
+    replay_install(NULL, 0, 0);
+}
+
+int pcstats_replay_position(void) {
+    pthread_mutex_lock(&replay_mutex);
+    int position = replay_frames ? replay_consumed : -1;
+    pthread_mutex_unlock(&replay_mutex);
+    return position;
+}
+
+// Next frame and its time on the replay clock; 0 when sampling live
+static int replay_next(PcStatsReplayFrame *frame, uint64_t *now_ms) {
+    if (atomic_exchange_explicit(&schedule_reset_pending, 0, memory_order_relaxed)) {
+        for (int i = 0; i < PCSTATS_COLLECTOR_COUNT; i++) {
+            collector_schedule[i].last_ms = 0;
+        }
+    }
+    if (!atomic_load_explicit(&replay_active, memory_order_acquire)) return 0;
+
+    pthread_mutex_lock(&replay_mutex);
+    if (!replay_frames) {
+        pthread_mutex_unlock(&replay_mutex);
+        return 0;
+    }
+    if (replay_index == replay_count) {
+        if (replay_loop) {
+            // Continue the clock past the last frame by one frame interval
+            uint64_t last = replay_frames[replay_count - 1].offset_ms;
+            uint64_t gap = replay_count > 1 ? last / (uint64_t)(replay_count - 1) : 1000;
+            replay_loop_offset_ms += last + (gap > 0 ? gap : 1000);
+            replay_index = 0;
+        } else {
+            replay_index = replay_count - 1;  // Hold the final frame
+        }
+    }
+    *frame = replay_frames[replay_index++];
+    replay_consumed++;
+    *now_ms = replay_epoch_ms + replay_loop_offset_ms + frame->offset_ms;
+    pthread_mutex_unlock(&replay_mutex);
+    return 1;
+}
+
+// ============================================================================
+// Snapshot - one sampling pass per tick, shared by every reader
+// ============================================================================
+
+// Last collected stats. Delta-based collectors (CPU ticks, network bytes,
+// IOReport energy) must only run once per tick, so the UI, JSON serializer
+// and serial sender all read this copy instead of calling collect_stats().
+//
+// Published through a double-buffered seqlock: the single writer fills the
+// slot readers are not pointed at, then flips snapshot_current. Readers copy
+// the current slot and only retry if the writer lapped them mid-copy, so a
+// read never waits on SMC/IOKit latency.
+typedef struct {
+    _Atomic uint32_t seq;   // Odd while the slot is being written
+    uint64_t sample_id;
+    PcStatus status;
+    PcStatusExt ext;
+} SnapshotSlot;
+
+static SnapshotSlot snapshot_slots[2];
+static _Atomic uint32_t snapshot_current = 0;
+static _Atomic uint64_t snapshot_count = 0;
+
+static void export_publish(uint64_t id, const PcStatus *status, const PcStatusExt *ext, int64_t time_ms);
+
+static uint64_t snapshot_publish(const PcStatus *status, const PcStatusExt *ext) {
+    uint32_t next = atomic_load_explicit(&snapshot_current, memory_order_relaxed) ^ 1;
+    SnapshotSlot *slot = &snapshot_slots[next];
+    uint64_t id = atomic_load_explicit(&snapshot_count, memory_order_relaxed) + 1;
+
+    uint32_t seq = atomic_load_explicit(&slot->seq, memory_order_relaxed);
+    atomic_store_explicit(&slot->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    memcpy(&slot->status, status, sizeof(PcStatus));
+    memcpy(&slot->ext, ext, sizeof(PcStatusExt));
+    slot->sample_id = id;
+
+    atomic_store_explicit(&slot->seq, seq + 2, memory_order_release);
+    atomic_store_explicit(&snapshot_current, next, memory_order_release);
+    atomic_store_explicit(&snapshot_count, id, memory_order_release);
+
+    int64_t now_ms = (int64_t)get_time_ms();
+    pcstats_history_record(status, now_ms);
+    export_publish(id, status, ext, now_ms);
+    return id;
+}
+
+// Copy the current snapshot, returns its sequence number (0 = never sampled)
+uint64_t pcstats_snapshot_get(PcStatus *out) {
+    return pcstats_snapshot_get_ext(out, NULL);
+}
+
+uint64_t pcstats_snapshot_get_ext(PcStatus *out, PcStatusExt *ext) {
+    if (atomic_load_explicit(&snapshot_count, memory_order_acquire) == 0) {
+        memset(out, 0, sizeof(PcStatus));
+        if (ext) memset(ext, 0, sizeof(PcStatusExt));
+        return 0;
+    }
+
+    for (;;) {
+        uint32_t idx = atomic_load_explicit(&snapshot_current, memory_order_acquire);
+        SnapshotSlot *slot = &snapshot_slots[idx];
+
+        uint32_t seq1 = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        if (seq1 & 1) continue;  // Writer lapped us onto this slot, pick again
+
+        memcpy(out, &slot->status, sizeof(PcStatus));
+        if (ext) memcpy(ext, &slot->ext, sizeof(PcStatusExt));
+        uint64_t id = slot->sample_id;
+
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&slot->seq, memory_order_relaxed) == seq1) {
+            return id;
+        }
+    }
+}
+
+// ============================================================================
+// History - struct-of-arrays rings per tier, rolled up incrementally
+// ============================================================================
+
+typedef struct {
+    int capacity;
+    int64_t bucket_ms;      // 0 = raw (every sample is a point)
+    int64_t *time_ms;       // [capacity]
+    uint32_t *samples;      // [capacity], NULL for raw
+    float *min;             // [PCSTATS_METRIC_COUNT][capacity]
+    float *max;             // Raw: all three point at the same values
+    float *avg;
+    int head;               // Next slot to write
+    int count;
+
+    // Bucket being filled; written to the ring once a later bucket starts
+    int64_t open_start;
+    uint32_t open_samples;
+    float open_min[PCSTATS_METRIC_COUNT];
+    float open_max[PCSTATS_METRIC_COUNT];
+    double open_sum[PCSTATS_METRIC_COUNT];
+} HistoryTier;
+
+#define HISTORY_ROLLUP_STORAGE(name, cap) \
+    static int64_t name##_time[cap]; \
+    static uint32_t name##_samples[cap]; \
+    static float name##_min[PCSTATS_METRIC_COUNT * (cap)]; \
+    static float name##_max[PCSTATS_METRIC_COUNT * (cap)]; \
+    static float name##_avg[PCSTATS_METRIC_COUNT * (cap)]
+
+static int64_t hist_raw_time[PCSTATS_HISTORY_RAW_CAPACITY];
+static float hist_raw_value[PCSTATS_METRIC_COUNT * PCSTATS_HISTORY_RAW_CAPACITY];
+HISTORY_ROLLUP_STORAGE(hist_minute, PCSTATS_HISTORY_MINUTE_CAPACITY);
+HISTORY_ROLLUP_STORAGE(hist_hour, PCSTATS_HISTORY_HOUR_CAPACITY);
+
+static HistoryTier history_tiers[PCSTATS_TIER_COUNT] = {
+    [PCSTATS_TIER_RAW] = {
+        .capacity = PCSTATS_HISTORY_RAW_CAPACITY, .bucket_ms = 0,
+        .time_ms = hist_raw_time, .samples = NULL,
+        .min = hist_raw_value, .max = hist_raw_value, .avg = hist_raw_value,
+    },
+    [PCSTATS_TIER_MINUTE] = {
+        .capacity = PCSTATS_HISTORY_MINUTE_CAPACITY, .bucket_ms = 60 * 1000,
+        .time_ms = hist_minute_time, .samples = hist_minute_samples,
+        .min = hist_minute_min, .max = hist_minute_max, .avg = hist_minute_avg,
+    },
+    [PCSTATS_TIER_HOUR] = {
+        .capacity = PCSTATS_HISTORY_HOUR_CAPACITY, .bucket_ms = 60 * 60 * 1000,
+        .time_ms = hist_hour_time, .samples = hist_hour_samples,
+        .min = hist_hour_min, .max = hist_hour_max, .avg = hist_hour_avg,
+    },
+};
+
+static pthread_mutex_t history_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void history_values(const PcStatus *s, float v[PCSTATS_METRIC_COUNT]) {
+    v[PCSTATS_METRIC_CPU_LOAD] = s->cpu.load;
+    v[PCSTATS_METRIC_CPU_TEMP] = s->cpu.temp;
+    v[PCSTATS_METRIC_CPU_POWER] = s->cpu.consume;
+    v[PCSTATS_METRIC_GPU_LOAD] = s->gpu.load;
+    v[PCSTATS_METRIC_GPU_TEMP] = s->gpu.temp;
+    v[PCSTATS_METRIC_GPU_POWER] = s->gpu.consume;
+    v[PCSTATS_METRIC_GPU_FREQ] = s->gpu.freq;
+    v[PCSTATS_METRIC_MEMORY_PERCENT] = s->memory.percent;
+    v[PCSTATS_METRIC_NET_UP] = s->network.up;
+    v[PCSTATS_METRIC_NET_DOWN] = s->network.down;
+    v[PCSTATS_METRIC_DISK_READ] = s->storage.read;
+    v[PCSTATS_METRIC_DISK_WRITE] = s->storage.write;
+    v[PCSTATS_METRIC_BOARD_TEMP] = s->board.temp;
+    v[PCSTATS_METRIC_FAN_RPM] = s->board.rpm;
+}
+
+// Claim the next ring slot, overwriting the oldest point when full
+static int history_push_slot(HistoryTier *t) {
+    int slot = t->head;
+    t->head = (t->head + 1) % t->capacity;
+    if (t->count < t->capacity) t->count++;
+    return slot;
+}
+
+static void history_close_bucket(HistoryTier *t) {
+    if (t->open_samples == 0) return;
+
+    int slot = history_push_slot(t);
+    t->time_ms[slot] = t->open_start;
+    t->samples[slot] = t->open_samples;
+    for (int m = 0; m < PCSTATS_METRIC_COUNT; m++) {
+        t->min[m * t->capacity + slot] = t->open_min[m];
+        t->max[m * t->capacity + slot] = t->open_max[m];
+        t->avg[m * t->capacity + slot] = (float)(t->open_sum[m] / t->open_samples);
+    }
+    t->open_samples = 0;
+}
+
+void pcstats_history_record(const PcStatus *status, int64_t time_ms) {
+    float v[PCSTATS_METRIC_COUNT];
+    history_values(status, v);
+
+    pthread_mutex_lock(&history_mutex);
+    for (int tier = 0; tier < PCSTATS_TIER_COUNT; tier++) {
+        HistoryTier *t = &history_tiers[tier];
+
+        if (t->bucket_ms == 0) {
+            int slot = history_push_slot(t);
+            t->time_ms[slot] = time_ms;
+            for (int m = 0; m < PCSTATS_METRIC_COUNT; m++) {
+                t->avg[m * t->capacity + slot] = v[m];
+            }
+            continue;
+        }
+
+        // A clock step backwards keeps filling the open bucket
+        int64_t start = time_ms - time_ms % t->bucket_ms;
+        if (t->open_samples > 0 && start > t->open_start) {
+            history_close_bucket(t);
+        }
+
+        if (t->open_samples == 0) {
+            t->open_start = start;
+            for (int m = 0; m < PCSTATS_METRIC_COUNT; m++) {
+                t->open_min[m] = v[m];
+                t->open_max[m] = v[m];
+                t->open_sum[m] = 0.0;
+            }
+        }
+
+        for (int m = 0; m < PCSTATS_METRIC_COUNT; m++) {
+            if (v[m] < t->open_min[m]) t->open_min[m] = v[m];
+            if (v[m] > t->open_max[m]) t->open_max[m] = v[m];
+            t->open_sum[m] += v[m];
+        }
+        t->open_samples++;
+    }
+    pthread_mutex_unlock(&history_mutex);
+}
+
+// Point i of a tier, oldest first; i == count is the open bucket (mutex held)
+static void history_point(const HistoryTier *t, int metric, int i, PcStatsHistoryPoint *p) {
+    if (i < t->count) {
+        int slot = (t->head - t->count + i + t->capacity) % t->capacity;
+        int idx = metric * t->capacity + slot;
+        p->time_ms = t->time_ms[slot];
+        p->min = t->min[idx];
+        p->max = t->max[idx];
+        p->avg = t->avg[idx];
+        p->samples = t->samples ? t->samples[slot] : 1;
+    } else {
+        p->time_ms = t->open_start;
+        p->min = t->open_min[metric];
+        p->max = t->open_max[metric];
+        p->avg = (float)(t->open_sum[metric] / t->open_samples);
+        p->samples = t->open_samples;
+    }
+}
+
+// Index range [first, end) of points overlapping the window (mutex held).
+// A bucket overlaps if it ends after since_ms.
+static int history_window(const HistoryTier *t, int64_t since_ms, int max_points, int *first) {
+    int end = t->count + (t->open_samples > 0 ? 1 : 0);
+    int i = end;
+    while (i > 0 && (max_points < 0 || end - i < max_points)) {
+        int prev = i - 1;
+        int64_t time_ms = prev < t->count
+            ? t->time_ms[(t->head - t->count + prev + t->capacity) % t->capacity]
+            : t->open_start;
+        int64_t span = t->bucket_ms > 0 ? t->bucket_ms : 1;
+        if (time_ms + span <= since_ms) break;
+        i = prev;
+    }
+    *first = i;
+    return end;
+}
+
+int pcstats_history_copy(PcStatsTier tier, PcStatsMetric metric, int64_t since_ms,
+                         PcStatsHistoryPoint *out, int max_points) {
+    if (tier < 0 || tier >= PCSTATS_TIER_COUNT || metric < 0 || metric >= PCSTATS_METRIC_COUNT ||
+        !out || max_points <= 0) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&history_mutex);
+    const HistoryTier *t = &history_tiers[tier];
+    int first;
+    int end = history_window(t, since_ms, max_points, &first);
+    for (int i = first; i < end; i++) {
+        history_point(t, metric, i, &out[i - first]);
+    }
+    pthread_mutex_unlock(&history_mutex);
+    return end - first;
+}
+
+int pcstats_history_summary(PcStatsTier tier, PcStatsMetric metric, int64_t since_ms,
+                            PcStatsHistoryPoint *out) {
+    if (!out) return 0;
+    memset(out, 0, sizeof(*out));
+    if (tier < 0 || tier >= PCSTATS_TIER_COUNT || metric < 0 || metric >= PCSTATS_METRIC_COUNT) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&history_mutex);
+    const HistoryTier *t = &history_tiers[tier];
+    int first;
+    int end = history_window(t, since_ms, -1, &first);
+    double weighted = 0.0;
+    for (int i = first; i < end; i++) {
+        PcStatsHistoryPoint p;
+        history_point(t, metric, i, &p);
+        if (i == first) {
+            out->time_ms = p.time_ms;
+            out->min = p.min;
+            out->max = p.max;
+        }
+        if (p.min < out->min) out->min = p.min;
+        if (p.max > out->max) out->max = p.max;
+        weighted += (double)p.avg * p.samples;
+        out->samples += p.samples;
+    }
+    if (out->samples > 0) out->avg = (float)(weighted / out->samples);
+    pthread_mutex_unlock(&history_mutex);
+    return end - first;
+}
+
+void pcstats_history_reset(void) {
+    pthread_mutex_lock(&history_mutex);
+    for (int tier = 0; tier < PCSTATS_TIER_COUNT; tier++) {
+        history_tiers[tier].head = 0;
+        history_tiers[tier].count = 0;
+        history_tiers[tier].open_samples = 0;
+    }
+    pthread_mutex_unlock(&history_mutex);
+}
+
+// ============================================================================
+// Export - memory-mapped snapshot and Prometheus endpoint
+// ============================================================================
+
+static pthread_mutex_t export_mutex = PTHREAD_MUTEX_INITIALIZER;
+static PcStatsExportRegion *export_region = NULL;  // Guarded by export_mutex
+
+int pcstats_export_shm_open(const char *path) {
+    if (!path) return -1;
+
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) return -1;
+    if (ftruncate(fd, sizeof(PcStatsExportRegion)) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    void *map = mmap(NULL, sizeof(PcStatsExportRegion), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);  // The mapping keeps the file referenced
+    if (map == MAP_FAILED) return -1;
+
+    PcStatsExportRegion *region = map;
+    memset(region, 0, sizeof(*region));
+    region->magic = PCSTATS_EXPORT_MAGIC;
+    region->version = PCSTATS_EXPORT_VERSION;
+    region->header_size = (uint16_t)offsetof(PcStatsExportRegion, status);
+    region->status_size = sizeof(PcStatus);
+    region->ext_size = sizeof(PcStatusExt);
+    region->writer_pid = getpid();
+
+    pthread_mutex_lock(&export_mutex);
+    PcStatsExportRegion *old = export_region;
+    export_region = region;
+    pthread_mutex_unlock(&export_mutex);
+
+    if (old) munmap(old, sizeof(PcStatsExportRegion));
+    return 0;
+}
+
+void pcstats_export_shm_close(void) {
+    pthread_mutex_lock(&export_mutex);
+    PcStatsExportRegion *region = export_region;
+    export_region = NULL;
+    if (region) {
+        atomic_store_explicit((_Atomic uint32_t *)&region->seq, 0, memory_order_release);
+        region->sample_id = 0;
+    }
+    pthread_mutex_unlock(&export_mutex);
+
+    if (region) munmap(region, sizeof(PcStatsExportRegion));
+}
+
+// Called from snapshot_publish (single writer)
+static void export_publish(uint64_t id, const PcStatus *status, const PcStatusExt *ext, int64_t time_ms) {
+    pthread_mutex_lock(&export_mutex);
+    PcStatsExportRegion *region = export_region;
+    if (region) {
+        _Atomic uint32_t *seq = (_Atomic uint32_t *)&region->seq;
+        uint32_t s = atomic_load_explicit(seq, memory_order_relaxed);
+        atomic_store_explicit(seq, s + 1, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+
+        region->sample_id = id;
+        region->time_ms = time_ms;
+        memcpy(&region->status, status, sizeof(PcStatus));
+        memcpy(&region->ext, ext, sizeof(PcStatusExt));
+
+        atomic_store_explicit(seq, s + 2, memory_order_release);
+    }
+    pthread_mutex_unlock(&export_mutex);
+}
+
+uint64_t pcstats_export_read(const PcStatsExportRegion *region, PcStatus *status, PcStatusExt *ext) {
+    if (!region || region->magic != PCSTATS_EXPORT_MAGIC ||
+        region->version != PCSTATS_EXPORT_VERSION ||
+        region->status_size != sizeof(PcStatus) || region->ext_size != sizeof(PcStatusExt)) {
+        return 0;
+    }
+
+    _Atomic uint32_t *seq = (_Atomic uint32_t *)&region->seq;
+    for (int attempt = 0; attempt < 100; attempt++) {
+        uint32_t seq1 = atomic_load_explicit(seq, memory_order_acquire);
+        if (seq1 == 0) return 0;  // Nothing published yet
+        if (seq1 & 1) continue;   // Writer inside
+
+        if (status) memcpy(status, &region->status, sizeof(PcStatus));
+        if (ext) memcpy(ext, &region->ext, sizeof(PcStatusExt));
+        uint64_t id = region->sample_id;
+
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(seq, memory_order_relaxed) == seq1) return id;
+    }
+    return 0;
+}
+
+// Prometheus gauges taken straight from PcStatus
+typedef struct {
+    const char *name;
+    const char *help;
+    size_t offset;
+} ExportGauge;
+
+#define EXPORT_GAUGE(name, field, help) { "nexmacro_" name, help, offsetof(PcStatus, field) }
+
+static const ExportGauge export_gauges[] = {
+    EXPORT_GAUGE("board_temperature_celsius", board.temp,      "Board temperature"),
+    EXPORT_GAUGE("fan_rpm",                   board.rpm,       "Fan speed"),
+    EXPORT_GAUGE("cpu_temperature_celsius",   cpu.temp,        "CPU temperature"),
+    EXPORT_GAUGE("cpu_load_percent",          cpu.load,        "CPU load"),
+    EXPORT_GAUGE("cpu_power_watts",           cpu.consume,     "CPU power"),
+    EXPORT_GAUGE("gpu_temperature_celsius",   gpu.temp,        "GPU temperature"),
+    EXPORT_GAUGE("gpu_load_percent",          gpu.load,        "GPU load"),
+    EXPORT_GAUGE("gpu_power_watts",           gpu.consume,     "GPU power"),
+    EXPORT_GAUGE("gpu_frequency_mhz",         gpu.freq,        "GPU frequency"),
+    EXPORT_GAUGE("disk_read_mbytes_per_sec",  storage.read,    "Disk read throughput"),
+    EXPORT_GAUGE("disk_write_mbytes_per_sec", storage.write,   "Disk write throughput"),
+    EXPORT_GAUGE("disk_used_percent",         storage.percent, "Disk usage"),
+    EXPORT_GAUGE("memory_used_gbytes",        memory.used,     "Memory used"),
+    EXPORT_GAUGE("memory_available_gbytes",   memory.avail,    "Memory available"),
+    EXPORT_GAUGE("memory_used_percent",       memory.percent,  "Memory usage"),
+    EXPORT_GAUGE("network_up_mbits_per_sec",  network.up,      "Network upload throughput"),
+    EXPORT_GAUGE("network_down_mbits_per_sec", network.down,   "Network download throughput"),
+};
+
+#define EXPORT_NUM_GAUGES (sizeof(export_gauges) / sizeof(export_gauges[0]))
+
+// Append formatted text; returns 0 once the buffer is full
+static int export_append(char *buf, size_t size, size_t *len, const char *fmt, ...)
+    __attribute__((format(printf, 4, 5)));
+
+static int export_append(char *buf, size_t size, size_t *len, const char *fmt, ...) {
+    if (*len >= size) return 0;
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(buf + *len, size - *len, fmt, args);
+    va_end(args);
+    if (n < 0 || (size_t)n >= size - *len) {
+        *len = size;
+        return 0;
+    }
+    *len += (size_t)n;
+    return 1;
+}
+
+int pcstats_export_prometheus(char *buf, size_t size) {
+    if (!buf || size == 0) return -1;
+
+    PcStatus status;
+    PcStatusExt ext;
+    uint64_t id = pcstats_snapshot_get_ext(&status, &ext);
+
+    size_t len = 0;
+    int ok = export_append(buf, size, &len,
+        "# HELP nexmacro_sample_id Snapshot sequence number\n"
+        "# TYPE nexmacro_sample_id counter\n"
+        "nexmacro_sample_id %llu\n", (unsigned long long)id);
+
+    for (size_t i = 0; ok && i < EXPORT_NUM_GAUGES; i++) {
+        float value;
+        memcpy(&value, (const char *)&status + export_gauges[i].offset, sizeof(value));
+        ok = export_append(buf, size, &len, "# HELP %s %s\n# TYPE %s gauge\n%s %g\n",
+                           export_gauges[i].name, export_gauges[i].help,
+                           export_gauges[i].name, export_gauges[i].name, value);
+    }
+
+    int cores = ext.cores.core_count < PCSTATS_MAX_CORES ? ext.cores.core_count : PCSTATS_MAX_CORES;
+    if (ok && cores > 0) {
+        ok = export_append(buf, size, &len,
+            "# HELP nexmacro_cpu_core_load_percent Per-core CPU load\n"
+            "# TYPE nexmacro_cpu_core_load_percent gauge\n");
+    }
+    for (int i = 0; ok && i < cores; i++) {
+        ok = export_append(buf, size, &len, "nexmacro_cpu_core_load_percent{core=\"%d\"} %g\n",
+                           i, ext.cores.core_load[i]);
+    }
+
+    int ifaces = ext.network.interface_count < PCSTATS_MAX_INTERFACES
+        ? ext.network.interface_count : PCSTATS_MAX_INTERFACES;
+    if (ok && ifaces > 0) {
+        ok = export_append(buf, size, &len,
+            "# HELP nexmacro_network_receive_bytes_total Bytes received per interface\n"
+            "# TYPE nexmacro_network_receive_bytes_total counter\n");
+    }
+    for (int i = 0; ok && i < ifaces; i++) {
+        const InterfaceStats *iface = &ext.network.interfaces[i];
+        ok = export_append(buf, size, &len, "nexmacro_network_receive_bytes_total{interface=\"%.16s\"} %llu\n",
+                           iface->name, (unsigned long long)iface->bytes_in);
+    }
+    if (ok && ifaces > 0) {
+        ok = export_append(buf, size, &len,
+            "# HELP nexmacro_network_transmit_bytes_total Bytes sent per interface\n"
+            "# TYPE nexmacro_network_transmit_bytes_total counter\n");
+    }
+    for (int i = 0; ok && i < ifaces; i++) {
+        const InterfaceStats *iface = &ext.network.interfaces[i];
+        ok = export_append(buf, size, &len, "nexmacro_network_transmit_bytes_total{interface=\"%.16s\"} %llu\n",
+                           iface->name, (unsigned long long)iface->bytes_out);
+    }
+
+    return ok ? (int)len : -1;
+}
+
+// One-scrape-per-connection server thread
+#define EXPORT_SCRAPE_BUF 16384
+
+static pthread_t export_socket_thread;
+static int export_listen_fd = -1;
+static int export_wake_pipe[2] = {-1, -1};
+static char export_socket_path[sizeof(((struct sockaddr_un *)0)->sun_path)];
+static _Atomic int export_socket_active = 0;
+
+static void export_serve_client(int fd, char *body) {
+    // Give an HTTP client a moment to send its request line
+    char request[512];
+    ssize_t n = 0;
+    struct pollfd pfd = { .fd = fd, .events = POLLIN };
+    if (poll(&pfd, 1, 100) > 0) {
+        n = read(fd, request, sizeof(request) - 1);
+    }
+    int http = n >= 4 && memcmp(request, "GET ", 4) == 0;
+
+    int body_len = pcstats_export_prometheus(body, EXPORT_SCRAPE_BUF);
+    if (body_len < 0) body_len = 0;
+
+    if (http) {
+        char header[160];
+        int header_len = snprintf(header, sizeof(header),
+            "HTTP/1.0 200 OK\r\n"
+            "Content-Type: text/plain; version=0.0.4\r\n"
+            "Content-Length: %d\r\n\r\n", body_len);
+        serial_write_all(fd, (const uint8_t *)header, (size_t)header_len, 1000);
+    }
+    serial_write_all(fd, (const uint8_t *)body, (size_t)body_len, 1000);
+}
+
+static void *export_socket_main(void *arg) {
+    (void)arg;
+    pthread_setname_np("pcstats.export");
+
+    static char body[EXPORT_SCRAPE_BUF];
+    for (;;) {
+        struct pollfd fds[2] = {
+            { .fd = export_listen_fd, .events = POLLIN },
+            { .fd = export_wake_pipe[0], .events = POLLIN },
+        };
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (fds[1].revents) break;  // Stop requested
+
+        int client = accept(export_listen_fd, NULL, NULL);
+        if (client < 0) continue;
+        // A stalled reader must not hold up later scrapes
+        int nosigpipe = 1;
+        struct timeval timeout = { .tv_sec = 1 };
+        setsockopt(client, SOL_SOCKET, SO_NOSIGPIPE, &nosigpipe, sizeof(nosigpipe));
+        setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        export_serve_client(client, body);
+        close(client);
+    }
+    return NULL;
+}
+
+int pcstats_export_socket_start(const char *path) {
+    if (!path || atomic_load(&export_socket_active)) return -1;
+
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    if (strlen(path) >= sizeof(addr.sun_path)) return -1;
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+
+    unlink(path);  // Stale socket from a previous run
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(fd, 8) != 0 ||
+        pipe(export_wake_pipe) != 0) {
+        close(fd);
+        unlink(path);
+        return -1;
+    }
+
+    export_listen_fd = fd;
+    snprintf(export_socket_path, sizeof(export_socket_path), "%s", path);
+    if (pthread_create(&export_socket_thread, NULL, export_socket_main, NULL) != 0) {
+        close(export_wake_pipe[0]);
+        close(export_wake_pipe[1]);
+        close(fd);
+        unlink(path);
+        export_listen_fd = -1;
+        return -1;
+    }
+    atomic_store(&export_socket_active, 1);
+    return 0;
+}
+
+void pcstats_export_socket_stop(void) {
+    if (!atomic_load(&export_socket_active)) return;
+
+    char wake = 1;
+    write(export_wake_pipe[1], &wake, 1);
+    pthread_join(export_socket_thread, NULL);
+
+    close(export_wake_pipe[0]);
+    close(export_wake_pipe[1]);
+    close(export_listen_fd);
+    unlink(export_socket_path);
+    export_listen_fd = -1;
+    atomic_store(&export_socket_active, 0);
+}
+
+// ============================================================================
+// Background Sampler - a dedicated thread that owns all collector state
+// ============================================================================
+
+static pthread_t sampler_thread;
+static pthread_mutex_t sampler_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t sampler_cond = PTHREAD_COND_INITIALIZER;
+static _Atomic int sampler_active = 0;         // Thread exists (readable without the mutex)
+static int sampler_stop_requested = 0;         // Guarded by sampler_mutex
+static int sampler_wake_requested = 0;         // Guarded by sampler_mutex
+static uint32_t sampler_interval_ms = 3000;    // Guarded by sampler_mutex
+static pcstats_sample_callback sampler_callback = NULL;
+static void *sampler_callback_ctx = NULL;
+
+static void *sampler_main(void *arg) {
+    (void)arg;
+    pthread_set_qos_class_self_np(QOS_CLASS_UTILITY, 0);
+    pthread_setname_np("pcstats.sampler");
+
+    pcstats_init();
+
+    PcStatus status;
+    PcStatusExt ext;
+    pthread_mutex_lock(&sampler_mutex);
+    while (!sampler_stop_requested) {
+        pthread_mutex_unlock(&sampler_mutex);
+
+        uint64_t sampled_ms = get_monotonic_ms();
+        collect_stats_ext(&status, &ext);
+        uint64_t id = snapshot_publish(&status, &ext);
+        if (sampler_callback) {
+            sampler_callback(id, sampler_callback_ctx);
+        }
+
+        pthread_mutex_lock(&sampler_mutex);
+        // Sleep until interval after this sample started, or until stop/trigger.
+        // An interval change only moves the deadline: the wait is recomputed
+        // from the current interval after every wakeup.
+        while (!sampler_stop_requested && !sampler_wake_requested) {
+            uint64_t elapsed_ms = get_monotonic_ms() - sampled_ms;
+            if (elapsed_ms >= sampler_interval_ms) break;  // Time for the next sample
+
+            uint32_t remaining_ms = sampler_interval_ms - (uint32_t)elapsed_ms;
+            struct timespec wait = {
+                .tv_sec = remaining_ms / 1000,
+                .tv_nsec = (long)(remaining_ms % 1000) * 1000000L
+            };
+            pthread_cond_timedwait_relative_np(&sampler_cond, &sampler_mutex, &wait);
+        }
+        sampler_wake_requested = 0;
+    }
+    pthread_mutex_unlock(&sampler_mutex);
+    return NULL;
+}
+
+// Start the background sampler (returns 0 on success, -1 if already running or on error)
+int pcstats_sampler_start(uint32_t interval_ms, pcstats_sample_callback callback, void *ctx) {
+    if (atomic_load(&sampler_active)) return -1;
+
+    pthread_mutex_lock(&sampler_mutex);
+    sampler_interval_ms = interval_ms > 0 ? interval_ms : 1;
+    sampler_stop_requested = 0;
+    sampler_wake_requested = 0;
+    sampler_callback = callback;
+    sampler_callback_ctx = ctx;
+    pthread_mutex_unlock(&sampler_mutex);
+
+    if (pthread_create(&sampler_thread, NULL, sampler_main, NULL) != 0) {
+        return -1;
+    }
+    atomic_store(&sampler_active, 1);
+    return 0;
+}
+
+// Stop the sampler and wait for it to exit (no callbacks run after this returns)
+void pcstats_sampler_stop(void) {
+    if (!atomic_load(&sampler_active)) return;
+
+    pthread_mutex_lock(&sampler_mutex);
+    sampler_stop_requested = 1;
+    pthread_cond_signal(&sampler_cond);
+    pthread_mutex_unlock(&sampler_mutex);
+
+    pthread_join(sampler_thread, NULL);
+    atomic_store(&sampler_active, 0);
+    sampler_callback = NULL;
+    sampler_callback_ctx = NULL;
+}
+
+// Change the sampling interval (takes effect from the next tick)
+// Moves the pending deadline without taking an extra sample: a sample only
+// a few ms after the last one would give near-zero-window load/IOReport deltas.
+void pcstats_sampler_set_interval(uint32_t interval_ms) {
+    pthread_mutex_lock(&sampler_mutex);
+    sampler_interval_ms = interval_ms > 0 ? interval_ms : 1;
+    pthread_cond_signal(&sampler_cond);  // Re-evaluate the deadline
+    pthread_mutex_unlock(&sampler_mutex);
+}
+
+// Take a sample now instead of waiting for the next tick
+void pcstats_sampler_trigger(void) {
+    pthread_mutex_lock(&sampler_mutex);
+    sampler_wake_requested = 1;
+    pthread_cond_signal(&sampler_cond);
+    pthread_mutex_unlock(&sampler_mutex);
+}
+
+int pcstats_sampler_is_running(void) {
+    return atomic_load(&sampler_active);
+}
+
+// Run one sampling pass and publish it as the current snapshot.
+// While the background sampler runs it owns the collectors, so this only
+// returns the latest sequence number.
+uint64_t pcstats_sample(void) {
+    if (atomic_load(&sampler_active)) {
+        return atomic_load_explicit(&snapshot_count, memory_order_acquire);
+    }
+
+    PcStatus status;
+    PcStatusExt ext;
+    collect_stats_ext(&status, &ext);
+    return snapshot_publish(&status, &ext);
 }
 
 void print_stats(PcStatus *status) {
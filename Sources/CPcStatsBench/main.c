@@ -0,0 +1,364 @@
+/*
+ * main.c - CPcStats micro-benchmarks
+ *
+ *   swift run -c release CPcStatsBench                   # live collectors + encoders
+ *   swift run -c release CPcStatsBench --no-hardware     # synthetic replay only (CI)
+ *   swift run -c release CPcStatsBench --record FILE     # capture a replay file
+ *   swift run -c release CPcStatsBench --replay FILE     # encoders on recorded data
+ *
+ * Reports ns/op and heap allocations/op. Allocations are counted by hooking
+ * the default malloc zone, so memory CoreFoundation takes from other zones
+ * is not included.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <malloc/malloc.h>
+#include <mach/mach.h>
+#include <mach/mach_time.h>
+
+#include "pcstats.h"
+
+// ============================================================================
+// Allocation Counter
+// ============================================================================
+
+static _Atomic uint64_t alloc_count = 0;
+static void *(*zone_malloc)(malloc_zone_t *, size_t);
+static void *(*zone_calloc)(malloc_zone_t *, size_t, size_t);
+static void *(*zone_realloc)(malloc_zone_t *, void *, size_t);
+static void *(*zone_memalign)(malloc_zone_t *, size_t, size_t);
+
+static void *counting_malloc(malloc_zone_t *zone, size_t size) {
+    atomic_fetch_add_explicit(&alloc_count, 1, memory_order_relaxed);
+    return zone_malloc(zone, size);
+}
+
+static void *counting_calloc(malloc_zone_t *zone, size_t count, size_t size) {
+    atomic_fetch_add_explicit(&alloc_count, 1, memory_order_relaxed);
+    return zone_calloc(zone, count, size);
+}
+
+static void *counting_realloc(malloc_zone_t *zone, void *ptr, size_t size) {
+    atomic_fetch_add_explicit(&alloc_count, 1, memory_order_relaxed);
+    return zone_realloc(zone, ptr, size);
+}
+
+static void *counting_memalign(malloc_zone_t *zone, size_t alignment, size_t size) {
+    atomic_fetch_add_explicit(&alloc_count, 1, memory_order_relaxed);
+    return zone_memalign(zone, alignment, size);
+}
+
+// Returns 0 if the default zone's entry points could be replaced
+static int alloc_counter_install(void) {
+    malloc_zone_t *zone = malloc_default_zone();
+    vm_address_t start = trunc_page((vm_address_t)zone);
+    vm_size_t size = round_page((vm_address_t)zone + sizeof(*zone)) - start;
+
+    // The zone struct is mapped read-only after malloc initializes
+    if (vm_protect(mach_task_self(), start, size, 0, VM_PROT_READ | VM_PROT_WRITE) != KERN_SUCCESS) {
+        return -1;
+    }
+    zone_malloc = zone->malloc;
+    zone_calloc = zone->calloc;
+    zone_realloc = zone->realloc;
+    zone->malloc = counting_malloc;
+    zone->calloc = counting_calloc;
+    zone->realloc = counting_realloc;
+    if (zone->version >= 5 && zone->memalign) {
+        zone_memalign = zone->memalign;
+        zone->memalign = counting_memalign;
+    }
+    vm_protect(mach_task_self(), start, size, 0, VM_PROT_READ);
+    return 0;
+}
+
+// ============================================================================
+// Runner
+// ============================================================================
+
+static mach_timebase_info_data_t timebase;
+static int alloc_counting = 0;
+
+typedef void (*bench_fn)(void *ctx);
+
+static uint64_t ticks_to_ns(uint64_t ticks) {
+    return ticks * timebase.numer / timebase.denom;
+}
+
+static void print_header(const char *title) {
+    printf("\n%-28s %12s %12s\n", title, "ns/op", "allocs/op");
+}
+
+static void print_result(const char *name, double ns_per_op, double allocs_per_op) {
+    if (alloc_counting) {
+        printf("%-28s %12.0f %12.2f\n", name, ns_per_op, allocs_per_op);
+    } else {
+        printf("%-28s %12.0f %12s\n", name, ns_per_op, "-");
+    }
+}
+
+static void bench(const char *name, int iterations, bench_fn fn, void *ctx) {
+    // Warm caches and lazy initialization outside the measurement
+    for (int i = 0; i < iterations / 10 + 1; i++) fn(ctx);
+
+    uint64_t allocs = atomic_load_explicit(&alloc_count, memory_order_relaxed);
+    uint64_t start = mach_absolute_time();
+    for (int i = 0; i < iterations; i++) fn(ctx);
+    uint64_t elapsed = mach_absolute_time() - start;
+    allocs = atomic_load_explicit(&alloc_count, memory_order_relaxed) - allocs;
+
+    print_result(name, (double)ticks_to_ns(elapsed) / iterations, (double)allocs / iterations);
+}
+
+// ============================================================================
+// Benchmarks
+// ============================================================================
+
+typedef struct {
+    PcStatus statuses[64];  // Replayed samples, cycled through by the encoders
+    int count;
+    int next;
+    PcStatsDelta delta;
+    uint8_t packet[PCSTATS_MAX_PACKET_LEN];
+    char json[PCSTATS_MAX_PACKET_LEN];
+} EncodeContext;
+
+static const PcStatus *next_status(EncodeContext *ctx) {
+    const PcStatus *status = &ctx->statuses[ctx->next];
+    ctx->next = (ctx->next + 1) % ctx->count;
+    return status;
+}
+
+static void bench_collect(void *ctx) {
+    PcStatus status;
+    collect_stats(&status);
+}
+
+static void bench_collect_ext(void *ctx) {
+    PcStatus status;
+    PcStatusExt ext;
+    collect_stats_ext(&status, &ext);
+}
+
+static void bench_build_json(void *ctx) {
+    EncodeContext *c = ctx;
+    PcStatus status = *next_status(c);
+    build_json(&status, c->json, sizeof(c->json));
+}
+
+static void bench_build_packet(void *ctx) {
+    EncodeContext *c = ctx;
+    pcstats_build_packet(next_status(c), c->packet, sizeof(c->packet));
+}
+
+static void bench_build_binary(void *ctx) {
+    EncodeContext *c = ctx;
+    pcstats_build_binary_packet(next_status(c), c->packet, sizeof(c->packet));
+}
+
+static void bench_dirty_sections(void *ctx) {
+    EncodeContext *c = ctx;
+    volatile uint32_t sections = pcstats_delta_dirty_sections(&c->delta, next_status(c));
+    (void)sections;
+}
+
+static void bench_delta_partial(void *ctx) {
+    EncodeContext *c = ctx;
+    pcstats_delta_build_packet(&c->delta, next_status(c), PCSTATS_PACKET_PARTIAL,
+                               c->packet, sizeof(c->packet));
+}
+
+// Every collector due on every tick, so each pass measures all of them
+static void make_all_collectors_due(void) {
+    for (int i = 0; i < PCSTATS_COLLECTOR_COUNT; i++) {
+        pcstats_set_collector_period((PcCollector)i, 0);
+    }
+}
+
+static void run_live(int iterations) {
+    uint32_t periods[PCSTATS_COLLECTOR_COUNT];
+    for (int i = 0; i < PCSTATS_COLLECTOR_COUNT; i++) {
+        periods[i] = pcstats_get_collector_period((PcCollector)i);
+    }
+
+    pcstats_init();
+    pcstats_enable_temps(1);
+    make_all_collectors_due();
+
+    print_header("Live");
+    bench("collect_stats", iterations, bench_collect, NULL);
+    bench("collect_stats_ext", iterations, bench_collect_ext, NULL);
+
+    // Per-collector split, from the library's own instrumentation
+    pcstats_metrics_reset();
+    pcstats_metrics_enable(1);
+    for (int i = 0; i < iterations; i++) bench_collect(NULL);
+    pcstats_metrics_enable(0);
+
+    PcStatsMetrics metrics;
+    pcstats_get_metrics(&metrics);
+    printf("\n%-28s %12s %12s %12s %8s\n", "Collector", "mean ns", "p50 ns", "p99 ns", "calls");
+    for (int i = 0; i < PCSTATS_TIMER_COUNT; i++) {
+        const PcStatsTimerStats *t = &metrics.timers[i];
+        if (t->count == 0) continue;
+        printf("%-28s %12llu %12llu %12llu %8llu\n", pcstats_metrics_timer_name((PcStatsTimer)i),
+               (unsigned long long)(t->total_ns / t->count), (unsigned long long)t->p50_ns,
+               (unsigned long long)t->p99_ns, (unsigned long long)t->count);
+    }
+    for (int i = 0; i < PCSTATS_COUNTER_COUNT; i++) {
+        if (metrics.counters[i] == 0) continue;
+        printf("%-28s %12.1f/pass\n", pcstats_metrics_counter_name((PcStatsCounter)i),
+               (double)metrics.counters[i] / iterations);
+    }
+
+    for (int i = 0; i < PCSTATS_COLLECTOR_COUNT; i++) {
+        pcstats_set_collector_period((PcCollector)i, periods[i]);
+    }
+}
+
+// Plausible, slowly varying readings for runs without hardware or a recording
+static void make_synthetic_frames(PcStatsReplayFrame *frames, int count) {
+    memset(frames, 0, sizeof(PcStatsReplayFrame) * (size_t)count);
+    for (int i = 0; i < count; i++) {
+        PcStatsReplayFrame *f = &frames[i];
+        float wave = (float)(i % 16) / 16.0f;
+
+        f->offset_ms = (uint64_t)i * 3000;
+        f->time_stamp = 1700000000 + i * 3;
+        f->uptime_seconds = 3600 + i * 3;
+        f->cpu_temp = 45.0f + 20.0f * wave;
+        f->gpu_temp = 40.0f + 15.0f * wave;
+        f->board_temp = 35.0f;
+        f->fans.count = 1;
+        f->fans.rpm[0] = 1200.0f + 800.0f * wave;
+        f->cpu_power = 4.0f + 12.0f * wave;
+        f->gpu_power = 1.0f + 6.0f * wave;
+        f->gpu_freq = 400.0f + 900.0f * wave;
+        f->gpu_load = 60.0f * wave;
+        f->gpu_mem_used = 2.0f + 4.0f * wave;
+        f->gpu_mem_total = 10.7f;
+        f->cpu_load = 10.0f + 70.0f * wave;
+        f->cores.core_count = 8;
+        for (int c = 0; c < 8; c++) f->cores.core_load[c] = f->cpu_load;
+        f->memory.used = 9.5f + wave;
+        f->memory.avail = 6.5f - wave;
+        f->memory.percent = f->memory.used / 16.0f * 100.0f;
+        f->network.up = 0.5f * wave;
+        f->network.down = 12.0f * wave;
+        f->storage.percent = 62.0f;
+        f->storage.read = 3.0f * wave;
+        f->storage.write = 1.5f * wave;
+    }
+}
+
+static void run_replay(int iterations) {
+    static EncodeContext ctx;
+    memset(&ctx, 0, sizeof(ctx));
+
+    // Replay with the default schedule to capture what the encoders see
+    for (int i = 0; i < 64; i++) {
+        collect_stats(&ctx.statuses[i]);
+    }
+    ctx.count = 64;
+    pcstats_delta_init(&ctx.delta, PCSTATS_DELTA_DEFAULT_KEYFRAME);
+    pcstats_delta_build_packet(&ctx.delta, &ctx.statuses[0], 0, ctx.packet, sizeof(ctx.packet));
+
+    print_header("Replay");
+    bench("collect_stats (replayed)", iterations, bench_collect, NULL);
+    bench("build_json", iterations, bench_build_json, &ctx);
+    bench("pcstats_build_packet", iterations, bench_build_packet, &ctx);
+    bench("pcstats_build_binary_packet", iterations, bench_build_binary, &ctx);
+    bench("delta_dirty_sections", iterations, bench_dirty_sections, &ctx);
+    bench("delta_build_packet partial", iterations, bench_delta_partial, &ctx);
+}
+
+static int record(const char *path, int samples, int interval_ms) {
+    pcstats_init();
+    pcstats_enable_temps(1);
+    if (pcstats_record_start(path) != 0) {
+        fprintf(stderr, "Cannot write %s\n", path);
+        return 1;
+    }
+    for (int i = 0; i < samples; i++) {
+        PcStatus status;
+        collect_stats(&status);
+        fprintf(stderr, "\rRecorded %d/%d", i + 1, samples);
+        usleep((useconds_t)interval_ms * 1000);
+    }
+    pcstats_record_stop();
+    fprintf(stderr, "\n");
+    return 0;
+}
+
+static void print_usage(const char *argv0) {
+    fprintf(stderr,
+            "Usage: %s [-n iterations] [--no-hardware] [--replay FILE]\n"
+            "       %s --record FILE [-s samples] [-i interval_ms]\n",
+            argv0, argv0);
+}
+
+int main(int argc, char **argv) {
+    int iterations = 10000;
+    int live = 1;
+    int samples = 100;
+    int interval_ms = 3000;
+    const char *replay_path = NULL;
+    const char *record_path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            iterations = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--no-hardware") == 0) {
+            live = 0;
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replay_path = argv[++i];
+        } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            record_path = argv[++i];
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            samples = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-i") == 0 && i + 1 < argc) {
+            interval_ms = atoi(argv[++i]);
+        } else {
+            print_usage(argv[0]);
+            return 2;
+        }
+    }
+    if (iterations < 1 || samples < 1 || interval_ms < 0) {
+        print_usage(argv[0]);
+        return 2;
+    }
+
+    if (record_path) {
+        return record(record_path, samples, interval_ms);
+    }
+
+    mach_timebase_info(&timebase);
+    alloc_counting = alloc_counter_install() == 0;
+
+    // Hardware collectors are slow (SMC/IOReport round trips): fewer passes
+    if (live && !replay_path) {
+        int passes = iterations / 100 > 0 ? iterations / 100 : 1;
+        run_live(passes);
+    }
+
+    int frames;
+    if (replay_path) {
+        frames = pcstats_replay_open(replay_path, 1);
+        if (frames < 0) {
+            fprintf(stderr, "Cannot replay %s\n", replay_path);
+            return 1;
+        }
+    } else {
+        static PcStatsReplayFrame synthetic[256];
+        make_synthetic_frames(synthetic, 256);
+        frames = pcstats_replay_load(synthetic, 256, 1);
+    }
+    printf("\n%d replay frames%s\n", frames, replay_path ? "" : " (synthetic)");
+    run_replay(iterations);
+    pcstats_replay_close();
+    return 0;
+}
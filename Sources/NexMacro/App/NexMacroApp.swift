@@ -46,6 +46,15 @@ class AppDelegate: NSObject, NSApplicationDelegate {
         updaterController = SPUStandardUpdaterController(startingUpdater: true, updaterDelegate: nil, userDriverDelegate: nil)
     }
 
+    func applicationShouldTerminate(_ sender: NSApplication) -> NSApplication.TerminateReply {
+        // Let coalesced configuration edits reach disk before quitting
+        Task {
+            await DeviceManager.shared.saveConfigurations()
+            sender.reply(toApplicationShouldTerminate: true)
+        }
+        return .terminateLater
+    }
+
     func checkForUpdates() {
         updaterController?.checkForUpdates(nil)
     }
@@ -180,6 +189,23 @@ struct MenuBarView: View {
                 .foregroundStyle(.secondary)
 
             StatsGridView(stats: deviceManager.statsCollector.currentStats)
+
+            let collector = deviceManager.statsCollector
+            HStack(spacing: 12) {
+                SparklineView(label: "CPU", values: collector.cpuLoadHistory, maxValue: 100)
+                SparklineView(label: "Power", values: collector.cpuPowerHistory)
+            }
+            .help("Last \(Int(StatsCollector.sparklineWindow / 60)) minutes")
+
+            // Settings > Show top processes
+            if collector.topProcessesEnabled {
+                TopProcessesView(title: "Top CPU", processes: collector.topCPUProcesses) {
+                    String(format: "%.0f%%", $0.cpuPercent)
+                }
+                TopProcessesView(title: "Top GPU", processes: collector.topGPUProcesses) {
+                    String(format: "%.0f%%", $0.gpuPercent)
+                }
+            }
         }
     }
 
@@ -206,10 +232,18 @@ struct MenuBarView: View {
             if debugExpanded {
                 DebugView(
                     stats: deviceManager.statsCollector.currentStats,
-                    device: deviceManager.connectedDevice,
+                    connection: deviceManager.connections.first,
+                    connectedCount: deviceManager.connections.count,
                     discoveredCount: deviceManager.discoveredDevices.count,
-                    isSending: deviceManager.isSendingStats
+                    isSending: deviceManager.isSendingStats,
+                    keyLatency: deviceManager.keyLatency,
+                    metrics: deviceManager.statsCollector.metrics,
+                    sensors: deviceManager.statsCollector.sensors,
+                    sensorTable: deviceManager.statsCollector.sensorTable,
+                    samplingInterval: deviceManager.statsCollector.samplingInterval
                 )
+                .onAppear { deviceManager.statsCollector.sensorsEnabled = true }
+                .onDisappear { deviceManager.statsCollector.sensorsEnabled = false }
             }
         }
     }
@@ -288,25 +322,39 @@ struct MenuBarView: View {
 
 struct DebugView: View {
     let stats: PcStats
-    let device: NexDevice?
+    let connection: DeviceConnection?
+    let connectedCount: Int
     let discoveredCount: Int
     let isSending: Bool
+    let keyLatency: KeyLatencyStats
+    let metrics: CollectorMetrics?
+    let sensors: [TemperatureSensor]
+    let sensorTable: String
+    let samplingInterval: TimeInterval
 
     var body: some View {
         VStack(alignment: .leading, spacing: 4) {
             // Connection Info
             Group {
                 DebugRow(label: "Ports Found", value: "\(discoveredCount)")
-                if let device = device {
+                DebugRow(label: "Devices", value: "\(connectedCount)")
+                if let connection {
+                    let device = connection.device
                     DebugRow(label: "Port", value: device.portPath)
                     DebugRow(label: "Device ID", value: device.deviceId ?? "—")
                     DebugRow(label: "Type", value: device.deviceType?.rawValue ?? "—")
                     DebugRow(label: "Firmware", value: device.firmwareVersion.map { "v\($0)" } ?? "—")
                     DebugRow(label: "Authenticated", value: device.isAuthenticated ? "Yes" : "No")
+                    DebugRow(label: "Stats Format", value: connection.statsFormat.displayName)
+                    DebugRow(label: "Dropped", value: "\(connection.service.droppedStatsPackets)")
                 } else {
                     DebugRow(label: "Port", value: "Not connected")
                 }
                 DebugRow(label: "Sending", value: isSending ? "Active" : "Stopped")
+                DebugRow(label: "Interval", value: String(format: "%.1fs", samplingInterval))
+                if keyLatency.count > 0 {
+                    DebugRow(label: "Key Latency", value: String(format: "%.1f / %.1f / %.1f ms", keyLatency.lastMs, keyLatency.averageMs, keyLatency.maxMs))
+                }
             }
 
             Divider()
@@ -321,24 +369,74 @@ struct DebugView: View {
                 DebugRow(label: "CPU Temp", value: String(format: "%.2f°C", stats.cpuTemp))
                 DebugRow(label: "CPU Load", value: String(format: "%.2f%%", stats.cpuLoad))
                 DebugRow(label: "CPU Power", value: String(format: "%.2fW", stats.cpuPower))
+                DebugRow(label: "CPU Peak (1h)", value: String(format: "%.2fW", stats.cpuPowerPeakLastHour))
+                ForEach(stats.clusters, id: \.name) { cluster in
+                    DebugRow(label: cluster.name, value: String(format: "%.0f MHz  %.1f%%", cluster.freqMHz, cluster.load))
+                }
+                if !stats.coreLoads.isEmpty {
+                    CoreLoadBarsView(loads: stats.coreLoads, efficiencyCoreCount: stats.efficiencyCoreCount)
+                }
 
                 DebugRow(label: "GPU Temp", value: String(format: "%.2f°C", stats.gpuTemp))
                 DebugRow(label: "GPU Load", value: String(format: "%.2f%%", stats.gpuLoad))
                 DebugRow(label: "GPU Power", value: String(format: "%.2fW", stats.gpuPower))
                 DebugRow(label: "GPU Freq", value: String(format: "%.0f MHz", stats.gpuFreqMHz))
+                DebugRow(label: "GPU Memory", value: String(format: "%.1f / %.1f GB", stats.gpuMemUsed, stats.gpuMemTotal))
 
                 DebugRow(label: "Board Temp", value: String(format: "%.2f°C", stats.boardTemp))
                 DebugRow(label: "Fan RPM", value: String(format: "%.0f", stats.boardFanRPM))
 
                 DebugRow(label: "Memory", value: String(format: "%.2f / %.2f GB", stats.memoryUsedGB, stats.memoryUsedGB + stats.memoryAvailGB))
+                DebugRow(label: "Compressed", value: String(format: "%.2f GB (wired %.2f)", stats.memoryCompressedGB, stats.memoryWiredGB))
+                DebugRow(label: "Swap", value: String(format: "%.2f / %.2f GB", stats.swapUsedGB, stats.swapTotalGB))
+                DebugRow(label: "Pressure", value: stats.memoryPressure.rawValue)
                 DebugRow(label: "Disk", value: String(format: "%.1f%%", stats.storagePercent))
+                DebugRow(label: "Disk R/W", value: String(format: "%.1f / %.1f MB/s", stats.storageRead, stats.storageWrite))
 
                 DebugRow(label: "Net Up", value: String(format: "%.3f Mb/s", stats.networkUpMbps))
                 DebugRow(label: "Net Down", value: String(format: "%.3f Mb/s", stats.networkDownMbps))
+                ForEach(stats.networkInterfaces, id: \.name) { iface in
+                    DebugRow(label: iface.name, value: String(format: "↑%.2f ↓%.2f Mb/s", iface.upMbps, iface.downMbps))
+                }
 
                 DebugRow(label: "Uptime", value: stats.uptimeFormatted)
                 DebugRow(label: "Timestamp", value: "\(stats.timestamp)")
             }
+
+            if !sensors.isEmpty {
+                Divider()
+                    .padding(.vertical, 2)
+
+                // SMC keys behind the temperature averages
+                Group {
+                    Text("Sensors (\(sensorTable))")
+                        .font(.caption2)
+                        .foregroundStyle(.tertiary)
+
+                    ForEach(sensors) { sensor in
+                        DebugRow(label: "\(sensor.key) \(sensor.kindName)", value: String(format: "%.1f°C", sensor.celsius))
+                    }
+                }
+            }
+
+            if let metrics {
+                Divider()
+                    .padding(.vertical, 2)
+
+                // Collector instrumentation (Settings > Record collector timings)
+                Group {
+                    Text("Timing p50 / p99 / max ms")
+                        .font(.caption2)
+                        .foregroundStyle(.tertiary)
+
+                    ForEach(metrics.timings.filter { $0.count > 0 }) { timing in
+                        DebugRow(label: timing.name, value: String(format: "%.2f / %.2f / %.2f", timing.p50Ms, timing.p99Ms, timing.maxMs))
+                    }
+                    ForEach(metrics.counters.filter { $0.value > 0 }) { counter in
+                        DebugRow(label: counter.name, value: "\(counter.value)")
+                    }
+                }
+            }
         }
         .padding(8)
         .background(.quaternary.opacity(0.3), in: RoundedRectangle(cornerRadius: 6))
@@ -362,6 +460,59 @@ struct DebugRow: View {
     }
 }
 
+/// One bar per logical CPU, so a single pegged core stands out from the average
+struct CoreLoadBarsView: View {
+    let loads: [Float]
+    let efficiencyCoreCount: Int
+
+    var body: some View {
+        HStack(alignment: .bottom, spacing: 1) {
+            ForEach(Array(loads.enumerated()), id: \.offset) { index, load in
+                RoundedRectangle(cornerRadius: 1)
+                    .fill(index < efficiencyCoreCount ? Color.green : Color.blue)
+                    .frame(width: 5, height: max(1, CGFloat(load) / 100 * 20))
+            }
+        }
+        .frame(height: 20, alignment: .bottom)
+    }
+}
+
+/// Recent values of one metric as a line; scaled to `maxValue`, or to the
+/// largest value shown when there is none
+struct SparklineView: View {
+    let label: String
+    let values: [Float]
+    var maxValue: Float?
+
+    var body: some View {
+        HStack(spacing: 4) {
+            Text(label)
+                .font(.caption2)
+                .foregroundStyle(.tertiary)
+
+            GeometryReader { geometry in
+                let top = max(maxValue ?? values.max() ?? 0, 0.001)
+                let step = geometry.size.width / CGFloat(max(values.count - 1, 1))
+                Path { path in
+                    for (index, value) in values.enumerated() {
+                        let point = CGPoint(
+                            x: CGFloat(index) * step,
+                            y: geometry.size.height * (1 - CGFloat(min(max(value / top, 0), 1)))
+                        )
+                        if index == 0 {
+                            path.move(to: point)
+                        } else {
+                            path.addLine(to: point)
+                        }
+                    }
+                }
+                .stroke(Color.accentColor, lineWidth: 1)
+            }
+            .frame(height: 16)
+        }
+    }
+}
+
 // MARK: - Stats Grid
 
 struct StatsGridView: View {
@@ -393,6 +544,37 @@ struct StatsGridView: View {
     }
 }
 
+/// Busiest processes from the last pass, one line each
+struct TopProcessesView: View {
+    let title: String
+    let processes: [ProcessUsage]
+    let value: (ProcessUsage) -> String
+
+    var body: some View {
+        VStack(alignment: .leading, spacing: 2) {
+            Text(title)
+                .font(.caption2)
+                .foregroundStyle(.tertiary)
+
+            if processes.isEmpty {
+                Text("Idle")
+                    .foregroundStyle(.secondary)
+            }
+            ForEach(processes) { process in
+                HStack {
+                    Text(process.name)
+                        .lineLimit(1)
+                        .truncationMode(.middle)
+                    Spacer()
+                    Text(value(process))
+                        .fontWeight(.medium)
+                }
+            }
+        }
+        .font(.system(.caption, design: .monospaced))
+    }
+}
+
 struct StatCell: View {
     let label: String
     let value: String
@@ -455,6 +637,14 @@ struct GeneralSettingsView: View {
     @Environment(DeviceManager.self) private var deviceManager
     @AppStorage("statsSendInterval") private var statsSendInterval: Double = 3.0
     @AppStorage("showTempInMenuBar") private var showTempInMenuBar = true
+    @AppStorage("adaptiveSampling") private var adaptiveSampling = true
+    @AppStorage("networkInterfaces") private var networkInterfaces = ""
+    @AppStorage("exportStats") private var exportStats = false
+    @AppStorage("collectorMetrics") private var collectorMetrics = false
+    @AppStorage("topProcesses") private var topProcesses = false
+    @AppStorage("textInputMode") private var textInputMode = TextInputMode.perCharacter.rawValue
+    @AppStorage("textInputDelayMs") private var textInputDelayMs = 5
+    @AppStorage("textPasteThreshold") private var textPasteThreshold = 0
     @State private var showingAppMappings = false
     @State private var launchAtLogin = LoginItemManager.shared.isEnabled
 
@@ -475,8 +665,64 @@ struct GeneralSettingsView: View {
                 Slider(value: $statsSendInterval, in: 1...10, step: 1) {
                     Text("Update Interval: \(Int(statsSendInterval))s")
                 }
+                .onChange(of: statsSendInterval) { _, newValue in
+                    deviceManager.statsSendInterval = newValue
+                }
+
+                Toggle("Adapt interval to activity", isOn: $adaptiveSampling)
+                    .onChange(of: adaptiveSampling) { _, newValue in
+                        deviceManager.statsCollector.adaptiveSampling = newValue
+                    }
+                Text("Samples every 0.5 s while load or temperature change quickly, and less often when stable, locked, asleep or on battery.")
+                    .font(.caption)
+                    .foregroundStyle(.secondary)
 
                 Toggle("Show temperature in menu bar", isOn: $showTempInMenuBar)
+
+                TextField("Network interfaces", text: $networkInterfaces, prompt: Text("All (e.g. en0, en1)"))
+                    .onChange(of: networkInterfaces) { _, newValue in
+                        deviceManager.statsCollector.networkInterfaces = Self.interfaceList(newValue)
+                    }
+
+                Toggle("Share stats with other apps", isOn: $exportStats)
+                    .onChange(of: exportStats) { _, newValue in
+                        deviceManager.statsCollector.exportEnabled = newValue
+                    }
+                if exportStats, let socket = HardwareMonitor.exportSocketURL {
+                    Text("Prometheus: \(socket.path)")
+                        .font(.caption)
+                        .foregroundStyle(.secondary)
+                        .textSelection(.enabled)
+                }
+
+                Toggle("Record collector timings", isOn: $collectorMetrics)
+                    .onChange(of: collectorMetrics) { _, newValue in
+                        deviceManager.statsCollector.metricsEnabled = newValue
+                    }
+
+                Toggle("Show top processes", isOn: $topProcesses)
+                    .onChange(of: topProcesses) { _, newValue in
+                        deviceManager.statsCollector.topProcessesEnabled = newValue
+                    }
+            }
+
+            Section("Type Text") {
+                Picker("Typing", selection: $textInputMode) {
+                    ForEach(TextInputMode.allCases, id: \.rawValue) { mode in
+                        Text(mode.displayName).tag(mode.rawValue)
+                    }
+                }
+
+                Stepper("Delay between events: \(textInputDelayMs) ms", value: $textInputDelayMs, in: 0...50)
+
+                Toggle("Paste long text via clipboard", isOn: Binding(
+                    get: { textPasteThreshold > 0 },
+                    set: { textPasteThreshold = $0 ? 500 : 0 }
+                ))
+
+                if textPasteThreshold > 0 {
+                    Stepper("Paste from \(textPasteThreshold) characters", value: $textPasteThreshold, in: 50...10000, step: 50)
+                }
             }
 
             Section("Dynamic Profiles") {
@@ -517,6 +763,11 @@ struct GeneralSettingsView: View {
                 .environment(deviceManager)
         }
     }
+
+    /// Split "en0, en1" into interface names
+    static func interfaceList(_ text: String) -> [String] {
+        text.split(whereSeparator: { $0 == "," || $0 == " " }).map(String.init)
+    }
 }
 
 // MARK: - App Mappings Sheet
@@ -525,8 +776,15 @@ struct AppMappingsSheet: View {
     @Environment(DeviceManager.self) private var deviceManager
     @Environment(\.dismiss) private var dismiss
     @State private var selectedApp: String = ""
+    @State private var customPattern: String = ""
     @State private var selectedProfile: Int = 1
 
+    /// A typed bundle ID or pattern takes precedence over the picker
+    private var newMappingKey: String {
+        let pattern = customPattern.trimmingCharacters(in: .whitespaces)
+        return pattern.isEmpty ? selectedApp : pattern
+    }
+
     var body: some View {
         VStack(spacing: 16) {
             Text("App Profile Mappings")
@@ -539,15 +797,15 @@ struct AppMappingsSheet: View {
                         .font(.subheadline)
                         .foregroundStyle(.secondary)
 
-                    ForEach(Array(deviceManager.appProfileSwitcher.appProfileMappings), id: \.key) { bundleId, profileId in
+                    ForEach(deviceManager.appProfileSwitcher.appProfileMappings) { mapping in
                         HStack {
-                            Text(appName(for: bundleId))
+                            Text(appName(for: mapping.key))
                                 .lineLimit(1)
                             Spacer()
-                            Text("Profile \(profileId)")
+                            Text("Profile \(mapping.profileId)")
                                 .foregroundStyle(.secondary)
                             Button {
-                                deviceManager.removeAppProfileMapping(appBundleId: bundleId)
+                                deviceManager.removeAppProfileMapping(appBundleId: mapping.key)
                             } label: {
                                 Image(systemName: "trash")
                                     .foregroundStyle(.red)
@@ -577,6 +835,9 @@ struct AppMappingsSheet: View {
                 }
                 .pickerStyle(.menu)
 
+                TextField("Or bundle ID / pattern (com.jetbrains.*)", text: $customPattern)
+                    .textFieldStyle(.roundedBorder)
+
                 Picker("Profile", selection: $selectedProfile) {
                     ForEach(1...5, id: \.self) { id in
                         Text("Profile \(id)").tag(id)
@@ -585,11 +846,12 @@ struct AppMappingsSheet: View {
                 .pickerStyle(.segmented)
 
                 Button("Add Mapping") {
-                    guard !selectedApp.isEmpty else { return }
-                    deviceManager.setAppProfileMapping(appBundleId: selectedApp, profileId: selectedProfile)
+                    guard !newMappingKey.isEmpty else { return }
+                    deviceManager.setAppProfileMapping(appBundleId: newMappingKey, profileId: selectedProfile)
                     selectedApp = ""
+                    customPattern = ""
                 }
-                .disabled(selectedApp.isEmpty)
+                .disabled(newMappingKey.isEmpty)
             }
 
             Spacer()
@@ -615,27 +877,17 @@ struct DeviceInfoView: View {
 
     var body: some View {
         Form {
-            Section("Connection") {
-                if let device = deviceManager.connectedDevice {
-                    LabeledContent("Name", value: device.name)
-                    LabeledContent("Port", value: device.portPath)
-                    LabeledContent("Status", value: device.connectionState.description)
-
-                    if let id = device.deviceId {
-                        LabeledContent("Device ID", value: id)
-                    }
-                    if let version = device.firmwareVersion {
-                        LabeledContent("Firmware", value: "v\(version)")
-                    }
-                    if let type = device.deviceType {
-                        LabeledContent("Type", value: type.displayName)
-                    }
-                } else {
+            if deviceManager.connections.isEmpty {
+                Section("Connection") {
                     Text("No device connected")
                         .foregroundStyle(.secondary)
                 }
             }
 
+            ForEach(deviceManager.connections) { connection in
+                DeviceConnectionSection(connection: connection)
+            }
+
             Section("Actions") {
                 Button("Reconnect") {
                     Task {
@@ -653,8 +905,7 @@ struct DeviceInfoView: View {
             Section("Configuration") {
                 Button("Reset to Defaults") {
                     Task {
-                        try? await ConfigurationStorage.shared.deleteAllConfigurations()
-                        await deviceManager.loadConfigurations()
+                        await deviceManager.resetConfigurations()
                     }
                 }
                 .foregroundStyle(.red)
@@ -669,6 +920,43 @@ struct DeviceInfoView: View {
     }
 }
 
+/// One connected device: identity plus its own stats format and interval
+struct DeviceConnectionSection: View {
+    @Bindable var connection: DeviceConnection
+
+    var body: some View {
+        let device = connection.device
+        Section(device.name) {
+            LabeledContent("Port", value: device.portPath)
+            LabeledContent("Status", value: device.connectionState.description)
+
+            if let id = device.deviceId {
+                LabeledContent("Device ID", value: id)
+            }
+            if let version = device.firmwareVersion {
+                LabeledContent("Firmware", value: "v\(version)")
+            }
+            if let type = device.deviceType {
+                LabeledContent("Type", value: type.displayName)
+            }
+
+            Picker("Stats Format", selection: $connection.preferredFormat) {
+                Text("Automatic (\(connection.statsFormat.displayName))").tag(StatsFormat?.none)
+                ForEach(connection.supportedFormats, id: \.self) { format in
+                    Text(format.displayName).tag(StatsFormat?.some(format))
+                }
+            }
+
+            Picker("Send Every", selection: $connection.statsInterval) {
+                Text("Sample").tag(TimeInterval(0))
+                ForEach([2.0, 5.0, 10.0, 30.0], id: \.self) { seconds in
+                    Text("\(Int(seconds))s").tag(seconds)
+                }
+            }
+        }
+    }
+}
+
 #Preview("Menu Bar") {
     MenuBarView()
         .environment(DeviceManager())
@@ -12,6 +12,10 @@ final class NexDevice: Identifiable {
     var firmwareVersion: Int?
     var isConnected: Bool
     var isAuthenticated: Bool
+    /// Firmware merges stats packets that only contain changed sections
+    var supportsPartialStats = false
+    /// Firmware accepts the binary "pcb" stats frame (negotiated, JSON otherwise)
+    var supportsBinaryStats = false
 
     /// Device types based on decompiled nexmacro code
     enum DeviceType: String, Sendable {
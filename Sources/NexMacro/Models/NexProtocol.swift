@@ -1,5 +1,6 @@
 import Foundation
 import CommonCrypto
+import CPcStats
 
 /// NexMacro device communication protocol
 /// Based on decompiled EezBotFun_Config Windows application
@@ -7,6 +8,7 @@ enum NexProtocol {
     // MARK: - Magic Headers
     static let commandHeader = "ebf"  // Commands to device
     static let statsHeader = "pcs"     // PC stats to device
+    static let binaryStatsHeader = "pcb"  // Binary PC stats to device (negotiated)
 
     // MARK: - Commands (ebf protocol)
     enum Command: Character {
@@ -30,6 +32,7 @@ enum NexProtocol {
         case setBrightTheme = "h"
         case clearPairedDongle = "i"
         case rgbMode = "j"
+        case queryCapabilities = "l"
         case restoreLastVersion = "z"
     }
 
@@ -44,6 +47,7 @@ enum NexProtocol {
         case deviceId = "f"
         case authenticate = "g"
         case keyDown = "k"
+        case capabilities = "p"
     }
 
     // MARK: - Command Construction
@@ -124,19 +128,29 @@ enum NexProtocol {
 
     // MARK: - PC Stats Protocol
 
-    /// Build PC stats packet
-    /// Format: "pcs" + 2-byte length (big endian) + JSON
-    static func buildStatsPacket(json: String) -> Data {
-        let jsonData = Data(json.utf8)
-        let length = jsonData.count
+    // Packets are framed by the C encoder: "pcs" + 2-byte length (big endian) + JSON
+    // (pcstats_build_packet); DeviceConnection sends them via StatsPacketCache.
 
-        var packet = Data()
-        packet.append(contentsOf: statsHeader.utf8)
-        packet.append(UInt8((length >> 8) & 0xFF))  // High byte
-        packet.append(UInt8(length & 0xFF))          // Low byte
-        packet.append(jsonData)
+    // MARK: - Stats Capabilities
 
-        return packet
+    /// Stats formats the firmware accepts besides full "pcs" JSON.
+    /// Reply to `queryCapabilities` is "p=" + comma-separated tokens, e.g. "p=pcb2,pcsd":
+    /// "pcbN" = binary stats frame version N, "pcsd" = partial (dirty-section) JSON.
+    /// Firmware that doesn't know the command never replies and stays on JSON.
+    struct StatsCapabilities: Equatable, Sendable {
+        var binaryVersions: Set<Int> = []
+        var partialJSON = false
+    }
+
+    /// Parse the tokens after "p=" (pcstats_parse_capabilities)
+    static func parseCapabilities(_ content: String) -> StatsCapabilities {
+        var parsed = PcStatsCapabilities()
+        pcstats_parse_capabilities(content, &parsed)
+
+        var caps = StatsCapabilities()
+        caps.binaryVersions = Set((1...31).filter { parsed.binary_versions & (1 << UInt32($0)) != 0 })
+        caps.partialJSON = parsed.partial_json != 0
+        return caps
     }
 
     // MARK: - Response Parsing
@@ -177,6 +191,38 @@ enum NexProtocol {
         return ParsedResponse(type: nil, content: trimmed, profileId: nil, keyId: nil)
     }
 
+    /// Parse a key down notification ("ebf.k.<profileId>.<keyId>") straight
+    /// from the line bytes, without building a String. Returns nil for other lines.
+    static func parseKeyDown(_ line: UnsafeBufferPointer<UInt8>) -> (profileId: Int, keyId: Int)? {
+        let prefix: StaticString = "ebf.k."
+        let prefixLength = prefix.utf8CodeUnitCount
+        guard line.count > prefixLength else { return nil }
+        for i in 0..<prefixLength where line[i] != prefix.utf8Start[i] {
+            return nil
+        }
+
+        var fields = [0, 0]
+        var field = 0
+        var digits = 0
+        for byte in line[prefixLength...] {
+            switch byte {
+            case 0x30...0x39:  // 0-9
+                guard digits < 6 else { return nil }
+                fields[field] = fields[field] * 10 + Int(byte - 0x30)
+                digits += 1
+            case 0x2E:  // "." separates profile and key; anything after the key is ignored
+                guard digits > 0 else { return nil }
+                if field == 1 { return (fields[0], fields[1]) }
+                field += 1
+                digits = 0
+            default:
+                return nil
+            }
+        }
+        guard field == 1, digits > 0 else { return nil }
+        return (fields[0], fields[1])
+    }
+
     // MARK: - Authentication
 
     /// Generate HMAC-SHA256 authentication response
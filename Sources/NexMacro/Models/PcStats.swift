@@ -14,8 +14,15 @@ final class PcStats {
     var cpuTempMax: Float = 100
     var cpuLoad: Float = 0
     var cpuPower: Float = 0
+    var cpuPowerPeakLastHour: Float = 0
     var cpuTjMax: Int = 100
 
+    // Per-core load (kernel order, E-cores first on Apple Silicon) and clusters
+    var coreLoads: [Float] = []
+    var perfCoreCount: Int = 0
+    var efficiencyCoreCount: Int = 0
+    var clusters: [CpuClusterStats] = []
+
     // GPU
     var gpuTemp: Float = 0
     var gpuTempMax: Float = 100
@@ -36,10 +43,16 @@ final class PcStats {
     var memoryUsedGB: Float = 0
     var memoryAvailGB: Float = 0
     var memoryPercent: Float = 0
+    var memoryWiredGB: Float = 0
+    var memoryCompressedGB: Float = 0
+    var swapUsedGB: Float = 0
+    var swapTotalGB: Float = 0
+    var memoryPressure: MemoryPressure = .normal
 
     // Network
     var networkUpMbps: Float = 0
     var networkDownMbps: Float = 0
+    var networkInterfaces: [NetworkInterfaceStats] = []
 
     // Timestamp
     var timestamp: Int64 = 0
@@ -0,0 +1,487 @@
+import Foundation
+import AppKit
+import Carbon.HIToolbox
+
+/// A key's actions resolved ahead of time: key codes, flags, points and
+/// URLs are parsed once when the configuration is saved or loaded, so a
+/// press only replays the steps. Invalid configurations fail to compile.
+///
+/// Plans hold pre-built CGEvents and are replayed by `ActionExecutor` only,
+/// one press at a time, so sharing them across threads is safe.
+struct ActionPlan: @unchecked Sendable {
+    enum Step {
+        case key(KeyStroke)
+        case text(TextPayload, enter: KeyStroke?)
+        case media(Int32)
+        case delay(nanoseconds: UInt64)
+        case launchApp(String)
+        case openURL(URL)
+        case openFolder(String)
+        case script(String)
+        case mouseClick(CGMouseButton, clicks: Int)
+        case mouseMove(CGPoint, drag: Bool)
+        case changeProfile(Int)
+    }
+
+    let steps: [Step]
+
+    static let empty = ActionPlan(steps: [])
+
+    var isEmpty: Bool { steps.isEmpty }
+
+    /// Compile actions, failing on the first one that cannot be executed
+    static func compile(_ actions: [KeyAction]) throws -> ActionPlan {
+        let source = CGEventSource(stateID: .hidSystemState)
+        var steps: [Step] = []
+        for (index, action) in actions.enumerated() {
+            steps.append(try compile(action, index: index, source: source))
+        }
+        return ActionPlan(steps: steps)
+    }
+
+    /// Compile actions, dropping (and logging) the ones that cannot be executed.
+    /// Used for stored profiles, which may predate validation.
+    static func compileSkippingInvalid(_ actions: [KeyAction]) -> ActionPlan {
+        let (plan, errors) = compileCollectingErrors(actions)
+        for error in errors {
+            print("ActionPlan: Skipping invalid action: \(error.localizedDescription)")
+        }
+        return plan
+    }
+
+    /// Compile the valid actions and report why each of the others was dropped
+    static func compileCollectingErrors(_ actions: [KeyAction]) -> (plan: ActionPlan, errors: [ActionPlanError]) {
+        let source = CGEventSource(stateID: .hidSystemState)
+        var steps: [Step] = []
+        var errors: [ActionPlanError] = []
+        for (index, action) in actions.enumerated() {
+            do {
+                steps.append(try compile(action, index: index, source: source))
+            } catch let error as ActionPlanError {
+                errors.append(error)
+            } catch {
+                errors.append(ActionPlanError(index: index, type: action.type, parameter: action.parameter,
+                                              reason: error.localizedDescription))
+            }
+        }
+        return (ActionPlan(steps: steps), errors)
+    }
+
+    private static func compile(_ action: KeyAction, index: Int, source: CGEventSource?) throws -> Step {
+        func invalid(_ reason: String) -> ActionPlanError {
+            ActionPlanError(index: index, type: action.type, parameter: action.parameter, reason: reason)
+        }
+
+        let parameter = action.parameter.trimmingCharacters(in: .whitespaces)
+
+        switch action.type {
+        case .shortcut:
+            var modifiers: CGEventFlags = []
+            var keyCode: CGKeyCode?
+            for part in parameter.uppercased().split(separator: " ").map(String.init) {
+                switch part {
+                case "CONTROL", "CTRL":
+                    modifiers.insert(.maskControl)
+                case "SHIFT":
+                    modifiers.insert(.maskShift)
+                case "ALT", "OPTION":
+                    modifiers.insert(.maskAlternate)
+                case "COMMAND", "CMD", "WINDOWS", "WIN":
+                    modifiers.insert(.maskCommand)
+                default:
+                    // This is the main key
+                    guard let code = KeyCodes.named(part) else {
+                        throw invalid("Unknown key \"\(part)\"")
+                    }
+                    keyCode = code
+                }
+            }
+            guard let keyCode else {
+                throw invalid("No key in shortcut")
+            }
+            return .key(KeyStroke(keyCode, flags: modifiers, source: source))
+
+        case .textInput:
+            var text = action.parameter
+            var enter: KeyStroke?
+            if text.uppercased().hasSuffix(" ENTER") {
+                text = String(text.dropLast(6))
+                enter = KeyStroke(CGKeyCode(kVK_Return), source: source)
+            }
+            return .text(TextPayload(text, source: source), enter: enter)
+
+        case .mediaControl:
+            switch parameter.uppercased() {
+            case "MK_PP": return .media(NX_KEYTYPE_PLAY)
+            case "MK_NEXT": return .media(NX_KEYTYPE_NEXT)
+            case "MK_PREV": return .media(NX_KEYTYPE_PREVIOUS)
+            // macOS doesn't have a dedicated stop key, use play/pause
+            case "MK_STOP": return .media(NX_KEYTYPE_PLAY)
+            case "MK_MUTE": return .media(NX_KEYTYPE_MUTE)
+            case "MK_VOLUP": return .media(NX_KEYTYPE_SOUND_UP)
+            case "MK_VOLDOWN": return .media(NX_KEYTYPE_SOUND_DOWN)
+            default: throw invalid("Unknown media control")
+            }
+
+        case .delay:
+            guard let ms = UInt64(parameter) else {
+                throw invalid("Delay must be a whole number of milliseconds")
+            }
+            return .delay(nanoseconds: ms * 1_000_000)
+
+        case .launchApp:
+            guard !parameter.isEmpty else { throw invalid("No application given") }
+            return .launchApp(parameter)
+
+        case .accessWebsite:
+            // Add https:// if no scheme
+            let urlString = parameter.contains("://") ? parameter : "https://\(parameter)"
+            guard !parameter.isEmpty, let url = URL(string: urlString) else {
+                throw invalid("Invalid URL")
+            }
+            return .openURL(url)
+
+        case .openFolder:
+            guard !parameter.isEmpty else { throw invalid("No folder given") }
+            return .openFolder(URL(fileURLWithPath: parameter).path)
+
+        case .command:
+            guard !parameter.isEmpty else { throw invalid("No command given") }
+            // Run in Terminal
+            return .script("""
+            tell application "Terminal"
+                activate
+                do script "\(parameter.replacingOccurrences(of: "\"", with: "\\\""))"
+            end tell
+            """)
+
+        case .mouseClick:
+            switch MouseClickType(rawValue: parameter.uppercased()) {
+            case .leftClick: return .mouseClick(.left, clicks: 1)
+            case .doubleClick: return .mouseClick(.left, clicks: 2)
+            case .rightClick: return .mouseClick(.right, clicks: 1)
+            case nil: throw invalid("Unknown mouse click type")
+            }
+
+        case .mouseMove:
+            let parts = parameter.uppercased().split(separator: " ").map(String.init)
+            guard parts.count >= 2,
+                  let x = Int(parts[0]),
+                  let y = Int(parts[1]) else {
+                throw invalid("Expected \"X Y\" or \"X Y DRAG\"")
+            }
+            let drag = parts.count >= 3 && parts[2] == "DRAG"
+            return .mouseMove(CGPoint(x: x, y: y), drag: drag)
+
+        case .functionKey:
+            guard let keyCode = KeyCodes.functionKey(parameter.uppercased()) else {
+                throw invalid("Unknown function key")
+            }
+            return .key(KeyStroke(keyCode, source: source))
+
+        case .changeProfile:
+            guard let profileId = Int(parameter), (1...5).contains(profileId) else {
+                throw invalid("Profile must be 1-5")
+            }
+            return .changeProfile(profileId)
+
+        case .controlAction:
+            switch ControlActionType(rawValue: parameter.uppercased()) {
+            case .calculator:
+                return .launchApp("/System/Applications/Calculator.app")
+            case .browser:
+                return .launchApp("/Applications/Safari.app")
+            case .email:
+                return .launchApp("/System/Applications/Mail.app")
+            case .search:
+                // Spotlight search
+                return .key(KeyStroke(CGKeyCode(kVK_Space), flags: .maskCommand, source: source))
+            case .home:
+                return .key(KeyStroke(CGKeyCode(kVK_ANSI_H), flags: [.maskCommand, .maskShift], source: source))
+            case .back:
+                return .key(KeyStroke(CGKeyCode(kVK_LeftArrow), flags: .maskCommand, source: source))
+            case .forward:
+                return .key(KeyStroke(CGKeyCode(kVK_RightArrow), flags: .maskCommand, source: source))
+            case .stop:
+                return .key(KeyStroke(CGKeyCode(kVK_ANSI_Period), flags: .maskCommand, source: source))
+            case .refresh:
+                return .key(KeyStroke(CGKeyCode(kVK_ANSI_R), flags: .maskCommand, source: source))
+            case .bookmarks:
+                return .key(KeyStroke(CGKeyCode(kVK_ANSI_B), flags: [.maskCommand, .maskAlternate], source: source))
+            case nil:
+                throw invalid("Unknown control action")
+            }
+        }
+    }
+}
+
+/// Why a key action could not be compiled
+struct ActionPlanError: Error, LocalizedError {
+    let index: Int
+    let type: KeyActionType
+    let parameter: String
+    let reason: String
+
+    var errorDescription: String? {
+        "\(type.displayName) (action \(index + 1), \"\(parameter)\"): \(reason)"
+    }
+}
+
+/// Text for a Type Text action, pre-split for batched injection
+struct TextPayload {
+    /// Most UTF-16 units a single keyboard event carries (longer strings are truncated)
+    static let maxChunkLength = 20
+
+    let text: String
+    /// `text` in chunks of at most `maxChunkLength` units, never splitting a surrogate pair
+    let chunks: [[UniChar]]
+    /// Cmd+V, for the clipboard strategy
+    let paste: KeyStroke
+
+    init(_ text: String, source: CGEventSource?) {
+        self.text = text
+        var chunks: [[UniChar]] = []
+        var chunk: [UniChar] = []
+        for scalar in text.unicodeScalars {
+            let units = Array(String(scalar).utf16)
+            if chunk.count + units.count > Self.maxChunkLength {
+                chunks.append(chunk)
+                chunk.removeAll(keepingCapacity: true)
+            }
+            chunk.append(contentsOf: units)
+        }
+        if !chunk.isEmpty {
+            chunks.append(chunk)
+        }
+        self.chunks = chunks
+        paste = KeyStroke(CGKeyCode(kVK_ANSI_V), flags: .maskCommand, source: source)
+    }
+}
+
+/// How Type Text actions are injected
+enum TextInputMode: String, CaseIterable {
+    case perCharacter
+    case batched
+
+    var displayName: String {
+        switch self {
+        case .perCharacter: return "Per character"
+        case .batched: return "Batched"
+        }
+    }
+}
+
+/// Type Text options from settings; read on each press so changes apply immediately
+struct TextInputSettings {
+    /// Per character by default, as before batching existed; batched is opt-in
+    var mode: TextInputMode = .perCharacter
+    /// Pause between events (per character or per chunk)
+    var delayMs = 5
+    /// Paste text at least this many characters long via the clipboard (0 = never)
+    var pasteThreshold = 0
+
+    static var current: TextInputSettings {
+        let defaults = UserDefaults.standard
+        var settings = TextInputSettings()
+        if let mode = defaults.string(forKey: "textInputMode").flatMap(TextInputMode.init) {
+            settings.mode = mode
+        }
+        if defaults.object(forKey: "textInputDelayMs") != nil {
+            settings.delayMs = max(0, defaults.integer(forKey: "textInputDelayMs"))
+        }
+        settings.pasteThreshold = max(0, defaults.integer(forKey: "textPasteThreshold"))
+        return settings
+    }
+}
+
+/// Key down/up events for one key, built once and re-posted on every press
+final class KeyStroke {
+    let keyCode: CGKeyCode
+    let flags: CGEventFlags
+    private let down: CGEvent?
+    private let up: CGEvent?
+
+    init(_ keyCode: CGKeyCode, flags: CGEventFlags = [], source: CGEventSource?) {
+        self.keyCode = keyCode
+        self.flags = flags
+        down = CGEvent(keyboardEventSource: source, virtualKey: keyCode, keyDown: true)
+        up = CGEvent(keyboardEventSource: source, virtualKey: keyCode, keyDown: false)
+        down?.flags = flags
+        up?.flags = flags
+    }
+
+    func postDown() {
+        post(down)
+    }
+
+    func postUp() {
+        post(up)
+    }
+
+    private func post(_ event: CGEvent?) {
+        guard let event else { return }
+        // Re-posted events keep their creation time otherwise
+        event.timestamp = CGEventTimestamp(clock_gettime_nsec_np(CLOCK_UPTIME_RAW))
+        event.post(tap: .cghidEventTap)
+    }
+}
+
+// MARK: - Key Code Mapping
+
+enum KeyCodes {
+    static func named(_ key: String) -> CGKeyCode? {
+        // Single character keys
+        if key.count == 1 {
+            return character(Character(key))
+        }
+
+        // Named keys
+        switch key.uppercased() {
+        case "RETURN", "ENTER": return CGKeyCode(kVK_Return)
+        case "TAB": return CGKeyCode(kVK_Tab)
+        case "SPACE": return CGKeyCode(kVK_Space)
+        case "DELETE", "BACKSPACE": return CGKeyCode(kVK_Delete)
+        case "ESCAPE", "ESC": return CGKeyCode(kVK_Escape)
+        case "UP": return CGKeyCode(kVK_UpArrow)
+        case "DOWN": return CGKeyCode(kVK_DownArrow)
+        case "LEFT": return CGKeyCode(kVK_LeftArrow)
+        case "RIGHT": return CGKeyCode(kVK_RightArrow)
+        case "HOME": return CGKeyCode(kVK_Home)
+        case "END": return CGKeyCode(kVK_End)
+        case "PAGEUP": return CGKeyCode(kVK_PageUp)
+        case "PAGEDOWN": return CGKeyCode(kVK_PageDown)
+        case "F1": return CGKeyCode(kVK_F1)
+        case "F2": return CGKeyCode(kVK_F2)
+        case "F3": return CGKeyCode(kVK_F3)
+        case "F4": return CGKeyCode(kVK_F4)
+        case "F5": return CGKeyCode(kVK_F5)
+        case "F6": return CGKeyCode(kVK_F6)
+        case "F7": return CGKeyCode(kVK_F7)
+        case "F8": return CGKeyCode(kVK_F8)
+        case "F9": return CGKeyCode(kVK_F9)
+        case "F10": return CGKeyCode(kVK_F10)
+        case "F11": return CGKeyCode(kVK_F11)
+        case "F12": return CGKeyCode(kVK_F12)
+        default:
+            return nil
+        }
+    }
+
+    static func character(_ char: Character) -> CGKeyCode? {
+        let c = char.uppercased().first ?? char
+        switch c {
+        case "A": return CGKeyCode(kVK_ANSI_A)
+        case "B": return CGKeyCode(kVK_ANSI_B)
+        case "C": return CGKeyCode(kVK_ANSI_C)
+        case "D": return CGKeyCode(kVK_ANSI_D)
+        case "E": return CGKeyCode(kVK_ANSI_E)
+        case "F": return CGKeyCode(kVK_ANSI_F)
+        case "G": return CGKeyCode(kVK_ANSI_G)
+        case "H": return CGKeyCode(kVK_ANSI_H)
+        case "I": return CGKeyCode(kVK_ANSI_I)
+        case "J": return CGKeyCode(kVK_ANSI_J)
+        case "K": return CGKeyCode(kVK_ANSI_K)
+        case "L": return CGKeyCode(kVK_ANSI_L)
+        case "M": return CGKeyCode(kVK_ANSI_M)
+        case "N": return CGKeyCode(kVK_ANSI_N)
+        case "O": return CGKeyCode(kVK_ANSI_O)
+        case "P": return CGKeyCode(kVK_ANSI_P)
+        case "Q": return CGKeyCode(kVK_ANSI_Q)
+        case "R": return CGKeyCode(kVK_ANSI_R)
+        case "S": return CGKeyCode(kVK_ANSI_S)
+        case "T": return CGKeyCode(kVK_ANSI_T)
+        case "U": return CGKeyCode(kVK_ANSI_U)
+        case "V": return CGKeyCode(kVK_ANSI_V)
+        case "W": return CGKeyCode(kVK_ANSI_W)
+        case "X": return CGKeyCode(kVK_ANSI_X)
+        case "Y": return CGKeyCode(kVK_ANSI_Y)
+        case "Z": return CGKeyCode(kVK_ANSI_Z)
+        case "0": return CGKeyCode(kVK_ANSI_0)
+        case "1": return CGKeyCode(kVK_ANSI_1)
+        case "2": return CGKeyCode(kVK_ANSI_2)
+        case "3": return CGKeyCode(kVK_ANSI_3)
+        case "4": return CGKeyCode(kVK_ANSI_4)
+        case "5": return CGKeyCode(kVK_ANSI_5)
+        case "6": return CGKeyCode(kVK_ANSI_6)
+        case "7": return CGKeyCode(kVK_ANSI_7)
+        case "8": return CGKeyCode(kVK_ANSI_8)
+        case "9": return CGKeyCode(kVK_ANSI_9)
+        case "-": return CGKeyCode(kVK_ANSI_Minus)
+        case "=": return CGKeyCode(kVK_ANSI_Equal)
+        case "[": return CGKeyCode(kVK_ANSI_LeftBracket)
+        case "]": return CGKeyCode(kVK_ANSI_RightBracket)
+        case ";": return CGKeyCode(kVK_ANSI_Semicolon)
+        case "'": return CGKeyCode(kVK_ANSI_Quote)
+        case "\\": return CGKeyCode(kVK_ANSI_Backslash)
+        case ",": return CGKeyCode(kVK_ANSI_Comma)
+        case ".": return CGKeyCode(kVK_ANSI_Period)
+        case "/": return CGKeyCode(kVK_ANSI_Slash)
+        case "`": return CGKeyCode(kVK_ANSI_Grave)
+        default: return nil
+        }
+    }
+
+    static func functionKey(_ key: String) -> CGKeyCode? {
+        switch key {
+        case "F1": return CGKeyCode(kVK_F1)
+        case "F2": return CGKeyCode(kVK_F2)
+        case "F3": return CGKeyCode(kVK_F3)
+        case "F4": return CGKeyCode(kVK_F4)
+        case "F5": return CGKeyCode(kVK_F5)
+        case "F6": return CGKeyCode(kVK_F6)
+        case "F7": return CGKeyCode(kVK_F7)
+        case "F8": return CGKeyCode(kVK_F8)
+        case "F9": return CGKeyCode(kVK_F9)
+        case "F10": return CGKeyCode(kVK_F10)
+        case "F11": return CGKeyCode(kVK_F11)
+        case "F12": return CGKeyCode(kVK_F12)
+        case "F13": return CGKeyCode(kVK_F13)
+        case "F14": return CGKeyCode(kVK_F14)
+        case "F15": return CGKeyCode(kVK_F15)
+        case "TAB": return CGKeyCode(kVK_Tab)
+        case "SPACE": return CGKeyCode(kVK_Space)
+        case "ENTER", "RETURN": return CGKeyCode(kVK_Return)
+        case "BACKSPACE", "DELETE": return CGKeyCode(kVK_Delete)
+        case "FORWARDDELETE": return CGKeyCode(kVK_ForwardDelete)
+        case "HOME": return CGKeyCode(kVK_Home)
+        case "END": return CGKeyCode(kVK_End)
+        case "PAGEUP": return CGKeyCode(kVK_PageUp)
+        case "PAGEDOWN": return CGKeyCode(kVK_PageDown)
+        case "UP": return CGKeyCode(kVK_UpArrow)
+        case "DOWN": return CGKeyCode(kVK_DownArrow)
+        case "LEFT": return CGKeyCode(kVK_LeftArrow)
+        case "RIGHT": return CGKeyCode(kVK_RightArrow)
+        case "ESCAPE", "ESC": return CGKeyCode(kVK_Escape)
+        case "NUMLOCK": return CGKeyCode(kVK_ANSI_KeypadClear)
+        case "KP_0": return CGKeyCode(kVK_ANSI_Keypad0)
+        case "KP_1": return CGKeyCode(kVK_ANSI_Keypad1)
+        case "KP_2": return CGKeyCode(kVK_ANSI_Keypad2)
+        case "KP_3": return CGKeyCode(kVK_ANSI_Keypad3)
+        case "KP_4": return CGKeyCode(kVK_ANSI_Keypad4)
+        case "KP_5": return CGKeyCode(kVK_ANSI_Keypad5)
+        case "KP_6": return CGKeyCode(kVK_ANSI_Keypad6)
+        case "KP_7": return CGKeyCode(kVK_ANSI_Keypad7)
+        case "KP_8": return CGKeyCode(kVK_ANSI_Keypad8)
+        case "KP_9": return CGKeyCode(kVK_ANSI_Keypad9)
+        case "KP_ENTER": return CGKeyCode(kVK_ANSI_KeypadEnter)
+        case "KP_DOT", "KP_DECIMAL": return CGKeyCode(kVK_ANSI_KeypadDecimal)
+        case "KP_PLUS": return CGKeyCode(kVK_ANSI_KeypadPlus)
+        case "KP_MINUS": return CGKeyCode(kVK_ANSI_KeypadMinus)
+        case "KP_ASTERISK", "KP_MULTIPLY": return CGKeyCode(kVK_ANSI_KeypadMultiply)
+        case "KP_SLASH", "KP_DIVIDE": return CGKeyCode(kVK_ANSI_KeypadDivide)
+        case "KP_EQUAL": return CGKeyCode(kVK_ANSI_KeypadEquals)
+        case "PRINTSCREEN": return CGKeyCode(kVK_F13)  // macOS uses F13 for print screen
+        case "INSERT": return CGKeyCode(kVK_Help)  // macOS uses Help key
+        default: return nil
+        }
+    }
+}
+
+// MARK: - Media Key Constants
+// These are from IOKit/hidsystem/ev_keymap.h
+let NX_KEYTYPE_PLAY: Int32 = 16
+let NX_KEYTYPE_NEXT: Int32 = 17
+let NX_KEYTYPE_PREVIOUS: Int32 = 18
+let NX_KEYTYPE_MUTE: Int32 = 7
+let NX_KEYTYPE_SOUND_UP: Int32 = 0
+let NX_KEYTYPE_SOUND_DOWN: Int32 = 1
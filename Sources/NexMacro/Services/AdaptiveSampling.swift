@@ -0,0 +1,173 @@
+import AppKit
+import Foundation
+import IOKit.ps
+
+/// What the machine is doing, as far as sampling cost is concerned
+struct SamplingConditions: Equatable, Sendable {
+    var displayAsleep = false
+    var sessionLocked = false
+    var onBattery = false
+
+    /// Nobody is looking at the Mac's screen
+    var isIdle: Bool {
+        displayAsleep || sessionLocked
+    }
+}
+
+/// Picks the interval until the next sampling pass: fast while load or
+/// temperature is moving, backing off while they are stable or the machine
+/// is idle, and slower across the board on battery.
+struct AdaptiveSamplingPolicy: Sendable {
+    /// Interval while values are changing quickly
+    var fastInterval: TimeInterval = 0.5
+    /// Configured interval (Settings > Update Interval)
+    var baseInterval: TimeInterval = 3
+    /// Longest backoff, also used while the display sleeps or the session is locked
+    var idleInterval: TimeInterval = 30
+
+    /// Change per second that switches to `fastInterval`
+    var fastLoadRate: Float = 10      // Percentage points
+    var fastTempRate: Float = 1.5     // °C
+
+    /// Change per sample below which a sample counts as stable
+    var stableLoadDelta: Float = 2
+    var stableTempDelta: Float = 0.5
+
+    /// Stable samples before backing off; the interval then doubles every `backoffStep` samples
+    var stableSamplesBeforeBackoff = 10
+    var backoffStep = 5
+
+    /// Fast samples taken after the last quick change
+    var fastHoldSamples = 6
+
+    private var previous: (load: Float, temp: Float, time: TimeInterval)?
+    private var stableSamples = 0
+    private var fastSamplesLeft = 0
+
+    /// Forget the trend (after waking, or when the schedule changes underneath)
+    mutating func reset() {
+        previous = nil
+        stableSamples = 0
+        fastSamplesLeft = 0
+    }
+
+    /// Feed one sample and get the interval until the next one
+    mutating func nextInterval(load: Float, temp: Float, at time: TimeInterval,
+                               conditions: SamplingConditions) -> TimeInterval {
+        if conditions.isIdle {
+            reset()
+            return idleInterval
+        }
+
+        if let previous, time > previous.time {
+            let loadDelta = abs(load - previous.load)
+            let tempDelta = abs(temp - previous.temp)
+            let elapsed = Float(time - previous.time)
+
+            if loadDelta / elapsed >= fastLoadRate || tempDelta / elapsed >= fastTempRate {
+                fastSamplesLeft = fastHoldSamples
+                stableSamples = 0
+            } else if loadDelta < stableLoadDelta && tempDelta < stableTempDelta {
+                stableSamples += 1
+            } else {
+                stableSamples = 0
+            }
+        }
+        previous = (load, temp, time)
+
+        var interval = baseInterval
+        if fastSamplesLeft > 0 {
+            fastSamplesLeft -= 1
+            interval = fastInterval
+        } else if stableSamples >= stableSamplesBeforeBackoff {
+            let steps = (stableSamples - stableSamplesBeforeBackoff) / backoffStep + 1
+            interval = baseInterval * pow(2, Double(min(steps, 10)))
+        }
+
+        if conditions.onBattery {
+            interval *= 2
+        }
+        return min(max(interval, fastInterval), idleInterval)
+    }
+
+    /// Interval to use right away when conditions change between samples
+    func interval(for conditions: SamplingConditions) -> TimeInterval {
+        if conditions.isIdle {
+            return idleInterval
+        }
+        return min(conditions.onBattery ? baseInterval * 2 : baseInterval, idleInterval)
+    }
+}
+
+/// Watches display sleep, screen lock and the power source
+@MainActor
+final class SystemActivityMonitor {
+    private(set) var conditions = SamplingConditions()
+
+    /// Called on the main actor whenever `conditions` changes
+    var onChange: ((SamplingConditions) -> Void)?
+
+    private var observers: [(NotificationCenter, NSObjectProtocol)] = []
+    private var powerSource: CFRunLoopSource?
+
+    init() {
+        let workspace = NSWorkspace.shared.notificationCenter
+        observe(workspace, NSWorkspace.screensDidSleepNotification) { $0.displayAsleep = true }
+        observe(workspace, NSWorkspace.screensDidWakeNotification) { $0.displayAsleep = false }
+        observe(workspace, NSWorkspace.sessionDidResignActiveNotification) { $0.sessionLocked = true }
+        observe(workspace, NSWorkspace.sessionDidBecomeActiveNotification) { $0.sessionLocked = false }
+
+        let distributed = DistributedNotificationCenter.default()
+        observe(distributed, Notification.Name("com.apple.screenIsLocked")) { $0.sessionLocked = true }
+        observe(distributed, Notification.Name("com.apple.screenIsUnlocked")) { $0.sessionLocked = false }
+
+        conditions.onBattery = Self.isOnBattery()
+        let context = Unmanaged.passUnretained(self).toOpaque()
+        if let source = IOPSNotificationCreateRunLoopSource({ context in
+            guard let context else { return }
+            let monitor = Unmanaged<SystemActivityMonitor>.fromOpaque(context).takeUnretainedValue()
+            // Delivered on the main run loop, where the source is scheduled
+            MainActor.assumeIsolated {
+                monitor.update { $0.onBattery = SystemActivityMonitor.isOnBattery() }
+            }
+        }, context)?.takeRetainedValue() {
+            CFRunLoopAddSource(CFRunLoopGetMain(), source, .defaultMode)
+            powerSource = source
+        }
+    }
+
+    deinit {
+        for (center, observer) in observers {
+            center.removeObserver(observer)
+        }
+        if let powerSource {
+            CFRunLoopRemoveSource(CFRunLoopGetMain(), powerSource, .defaultMode)
+        }
+    }
+
+    private func observe(_ center: NotificationCenter, _ name: Notification.Name,
+                         _ change: @escaping (inout SamplingConditions) -> Void) {
+        let observer = center.addObserver(forName: name, object: nil, queue: .main) { [weak self] _ in
+            MainActor.assumeIsolated {
+                self?.update(change)
+            }
+        }
+        observers.append((center, observer))
+    }
+
+    private func update(_ change: (inout SamplingConditions) -> Void) {
+        var updated = conditions
+        change(&updated)
+        guard updated != conditions else { return }
+        conditions = updated
+        onChange?(updated)
+    }
+
+    private static func isOnBattery() -> Bool {
+        guard let info = IOPSCopyPowerSourcesInfo()?.takeRetainedValue(),
+              let type = IOPSGetProvidingPowerSourceType(info)?.takeUnretainedValue() else {
+            return false
+        }
+        return (type as String) == kIOPSBatteryPowerValue
+    }
+}
@@ -1,6 +1,71 @@
 import Foundation
 import AppKit
 
+/// Bundle ID → profile lookup compiled from the mappings whenever they change.
+/// Keys are exact bundle IDs or patterns: "com.jetbrains.*" matches by prefix,
+/// other "*"s match any run of characters ("com.microsoft.*Office*").
+/// Exact IDs win, then the longest prefix, then patterns in mapping order.
+/// Matching ignores case; of two keys that differ only in case the later wins.
+struct AppProfileIndex: Sendable {
+    private var exact: [String: Int] = [:]
+    private var prefixes: [(prefix: String, profileId: Int)] = []
+    private var patterns: [(parts: [Substring], profileId: Int)] = []
+
+    init(mappings: [(key: String, profileId: Int)] = []) {
+        for (key, profileId) in mappings {
+            let key = key.lowercased()
+            guard key.contains("*") else {
+                exact[key] = profileId
+                continue
+            }
+            let body = key.dropLast()
+            if key.hasSuffix("*") && !body.contains("*") {
+                prefixes.removeAll { $0.prefix == body }
+                prefixes.append((String(body), profileId))
+            } else {
+                let parts = key.split(separator: "*", omittingEmptySubsequences: false)
+                patterns.removeAll { $0.parts == parts }
+                patterns.append((parts, profileId))
+            }
+        }
+        prefixes.sort { $0.prefix.count > $1.prefix.count }
+    }
+
+    /// Profile for an app, nil if nothing matches
+    func profileId(for bundleId: String) -> Int? {
+        let bundleId = bundleId.lowercased()
+        if let profileId = exact[bundleId] {
+            return profileId
+        }
+        if let rule = prefixes.first(where: { bundleId.hasPrefix($0.prefix) }) {
+            return rule.profileId
+        }
+        return patterns.first { Self.matches(bundleId, $0.parts) }?.profileId
+    }
+
+    /// Glob match of the parts between "*"s
+    private static func matches(_ text: String, _ parts: [Substring]) -> Bool {
+        guard let first = parts.first, let last = parts.last, parts.count > 1,
+              text.hasPrefix(first), text.count >= first.count + last.count else {
+            return false
+        }
+        var rest = text.dropFirst(first.count)
+        for part in parts.dropFirst().dropLast() where !part.isEmpty {
+            guard let range = rest.range(of: part) else { return false }
+            rest = rest[range.upperBound...]
+        }
+        return rest.hasSuffix(last)
+    }
+}
+
+/// One app (or pattern) to profile mapping
+struct AppProfileMapping: Equatable, Identifiable, Sendable {
+    var key: String
+    var profileId: Int
+
+    var id: String { key.lowercased() }
+}
+
 /// Monitors frontmost application and switches profiles automatically
 @MainActor
 final class AppProfileSwitcher {
@@ -8,14 +73,33 @@ final class AppProfileSwitcher {
     private var isEnabled = false
     private weak var deviceManager: DeviceManager?
 
-    /// App bundle ID to profile ID mapping
-    private(set) var appProfileMappings: [String: Int] = [:]
+    /// App bundle ID (or pattern, see `AppProfileIndex`) to profile ID mappings,
+    /// in the order added; keys are unique ignoring case
+    private(set) var appProfileMappings: [AppProfileMapping] = [] {
+        didSet {
+            rebuildIndex()
+            saveMappings()
+        }
+    }
+
+    /// Compiled from `appProfileMappings`, plus the apps already resolved with it
+    private var index = AppProfileIndex()
+    private var resolved: [String: Int] = [:]
 
     /// Default profile when no mapping matches
-    var defaultProfileId: Int = 1
+    var defaultProfileId: Int = 1 {
+        didSet { resolved.removeAll() }
+    }
+
+    /// Quiet time before acting on an activation, so a Cmd-Tab burst only
+    /// switches to the app it ends on
+    var debounceInterval: TimeInterval = 0.15
+
+    private var pendingSwitch: Task<Void, Never>?
 
     init(deviceManager: DeviceManager) {
         self.deviceManager = deviceManager
+        loadMappings()
     }
 
     // MARK: - Start/Stop
@@ -33,8 +117,8 @@ final class AppProfileSwitcher {
                   let app = notification.userInfo?[NSWorkspace.applicationUserInfoKey] as? NSRunningApplication else {
                 return
             }
-            Task { @MainActor in
-                self.switchProfileForApp(app)
+            MainActor.assumeIsolated {
+                self.scheduleSwitch(for: app)
             }
         }
 
@@ -49,6 +133,8 @@ final class AppProfileSwitcher {
 
     /// Stop monitoring
     func stop() {
+        pendingSwitch?.cancel()
+        pendingSwitch = nil
         if let observer = observer {
             NSWorkspace.shared.notificationCenter.removeObserver(observer)
             self.observer = nil
@@ -59,15 +145,27 @@ final class AppProfileSwitcher {
 
     // MARK: - Profile Mappings
 
-    /// Set profile mapping for an app
+    /// Set profile mapping for an app. A key equal ignoring case replaces the
+    /// existing mapping in place, so its pattern keeps its precedence.
     func setMapping(appBundleId: String, profileId: Int) {
-        appProfileMappings[appBundleId] = profileId
+        let mapping = AppProfileMapping(key: appBundleId, profileId: profileId)
+        if let index = mappingIndex(appBundleId) {
+            appProfileMappings[index] = mapping
+        } else {
+            appProfileMappings.append(mapping)
+        }
         print("AppProfileSwitcher: Mapped \(appBundleId) -> Profile \(profileId)")
     }
 
     /// Remove profile mapping for an app
     func removeMapping(appBundleId: String) {
-        appProfileMappings.removeValue(forKey: appBundleId)
+        if let index = mappingIndex(appBundleId) {
+            appProfileMappings.remove(at: index)
+        }
+    }
+
+    private func mappingIndex(_ key: String) -> Int? {
+        appProfileMappings.firstIndex { $0.key.caseInsensitiveCompare(key) == .orderedSame }
     }
 
     /// Clear all mappings
@@ -77,20 +175,67 @@ final class AppProfileSwitcher {
 
     // MARK: - Private
 
-    private func switchProfileForApp(_ app: NSRunningApplication) {
+    private func rebuildIndex() {
+        index = AppProfileIndex(mappings: appProfileMappings.map { (key: $0.key, profileId: $0.profileId) })
+        resolved.removeAll()
+    }
+
+    /// Persisted as an array so pattern order survives relaunches
+    private static let mappingsKey = "appProfileMappings"
+
+    private func loadMappings() {
+        guard let stored = UserDefaults.standard.array(forKey: Self.mappingsKey) as? [[String: Any]] else { return }
+        var mappings: [AppProfileMapping] = []
+        for entry in stored {
+            guard let key = entry["key"] as? String, let profileId = entry["profile"] as? Int,
+                  !mappings.contains(where: { $0.key.caseInsensitiveCompare(key) == .orderedSame }) else {
+                continue
+            }
+            mappings.append(AppProfileMapping(key: key, profileId: profileId))
+        }
+        appProfileMappings = mappings
+    }
+
+    private func saveMappings() {
+        let stored = appProfileMappings.map { ["key": $0.key, "profile": $0.profileId] as [String: Any] }
+        UserDefaults.standard.set(stored, forKey: Self.mappingsKey)
+    }
+
+    /// Profile for an app bundle ID (one hash lookup once the app has been seen)
+    func profileId(for bundleId: String) -> Int {
+        if let profileId = resolved[bundleId] {
+            return profileId
+        }
+        let profileId = index.profileId(for: bundleId) ?? defaultProfileId
+        resolved[bundleId] = profileId
+        return profileId
+    }
+
+    private func scheduleSwitch(for app: NSRunningApplication) {
         guard let bundleId = app.bundleIdentifier else { return }
+        let name = app.localizedName ?? bundleId
 
-        let targetProfileId: Int
-        if let mappedProfile = appProfileMappings[bundleId] {
-            targetProfileId = mappedProfile
-        } else {
-            targetProfileId = defaultProfileId
+        pendingSwitch?.cancel()
+        let delay = UInt64(debounceInterval * 1_000_000_000)
+        pendingSwitch = Task { [weak self] in
+            try? await Task.sleep(nanoseconds: delay)
+            guard !Task.isCancelled else { return }
+            self?.switchProfile(bundleId: bundleId, name: name)
         }
+    }
+
+    private func switchProfileForApp(_ app: NSRunningApplication) {
+        guard let bundleId = app.bundleIdentifier else { return }
+        switchProfile(bundleId: bundleId, name: app.localizedName ?? bundleId)
+    }
+
+    private func switchProfile(bundleId: String, name: String) {
+        let targetProfileId = profileId(for: bundleId)
 
         // Only switch if different from current
         guard targetProfileId != deviceManager?.activeProfileId else { return }
 
-        print("AppProfileSwitcher: App '\(app.localizedName ?? bundleId)' activated -> Profile \(targetProfileId)")
+        print("AppProfileSwitcher: App '\(name)' activated -> Profile \(targetProfileId)")
 
         deviceManager?.setActiveProfile(targetProfileId)
         deviceManager?.changeProfile(to: targetProfileId)
@@ -131,8 +276,13 @@ extension AppProfileSwitcher {
         ("Microsoft PowerPoint", "com.microsoft.Powerpoint"),
     ]
 
+    private static let bundleIdsByName: [String: String] = Dictionary(
+        commonApps.map { ($0.name.lowercased(), $0.bundleId) },
+        uniquingKeysWith: { first, _ in first }
+    )
+
     /// Get bundle ID for a common app name
     static func bundleId(for appName: String) -> String? {
-        commonApps.first { $0.name.lowercased() == appName.lowercased() }?.bundleId
+        bundleIdsByName[appName.lowercased()]
     }
 }
@@ -26,51 +26,91 @@ actor ConfigurationStorage {
 
     // MARK: - Profile Management
 
+    /// Profiles per device folder, read on first use
+    private var profileCache: [String: [Profile]] = [:]
+
+    /// Each profile lives in its own file, so an edit rewrites only that profile
+    private func profileFile(id: Int, in directory: URL) -> URL {
+        directory.appendingPathComponent("profile-\(id).json")
+    }
+
     /// Save all profiles for a device
     func saveProfiles(_ profiles: [Profile], deviceId: String?) async throws {
+        try writeProfiles(profiles, deviceId: deviceId)
+    }
+
+    /// Save only the given profiles, one atomic file each; others are left untouched
+    func writeProfiles(_ profiles: [Profile], deviceId: String?) throws {
         let directory = deviceDirectory(deviceId: deviceId)
-        try await ensureDirectoryExists(at: directory)
+        try createDirectory(at: directory)
 
         let encoder = JSONEncoder()
         encoder.outputFormatting = [.prettyPrinted, .sortedKeys]
 
-        // Save all profiles in a single file
-        let profilesFile = directory.appendingPathComponent("profiles.json")
-        let data = try encoder.encode(profiles)
-        try data.write(to: profilesFile, options: .atomic)
+        // Only devices already loaded are cached; the rest read the files on first use
+        var cached = profileCache[deviceId ?? "default"]
+        for profile in profiles {
+            let data = try encoder.encode(profile)
+            try data.write(to: profileFile(id: profile.id, in: directory), options: .atomic)
+
+            if let index = cached?.firstIndex(where: { $0.id == profile.id }) {
+                cached?[index] = profile
+            } else {
+                cached?.append(profile)
+            }
+        }
+        profileCache[deviceId ?? "default"] = cached?.sorted { $0.id < $1.id }
 
-        print("ConfigurationStorage: Saved \(profiles.count) profiles to \(profilesFile.path)")
+        print("ConfigurationStorage: Saved \(profiles.map(\.id)) to \(directory.path)")
     }
 
     /// Load all profiles for a device
+    /// Profiles that were never edited have no file and come from the defaults.
     func loadProfiles(deviceId: String?) async throws -> [Profile] {
-        let directory = deviceDirectory(deviceId: deviceId)
-        let profilesFile = directory.appendingPathComponent("profiles.json")
-
-        guard FileManager.default.fileExists(atPath: profilesFile.path) else {
-            print("ConfigurationStorage: No profiles file found, using defaults")
-            return createDefaultProfiles()
+        if let cached = profileCache[deviceId ?? "default"] {
+            return cached
         }
 
-        let data = try Data(contentsOf: profilesFile)
+        let directory = deviceDirectory(deviceId: deviceId)
         let decoder = JSONDecoder()
-        let profiles = try decoder.decode([Profile].self, from: data)
+        var profiles = createDefaultProfiles()
+
+        let files = (try? FileManager.default.contentsOfDirectory(at: directory, includingPropertiesForKeys: nil)) ?? []
+        let profileFiles = files.filter { $0.lastPathComponent.hasPrefix("profile-") && $0.pathExtension == "json" }
+        let legacyFile = directory.appendingPathComponent("profiles.json")
+
+        var stored: [Profile] = []
+        if !profileFiles.isEmpty {
+            for file in profileFiles {
+                stored.append(try decoder.decode(Profile.self, from: Data(contentsOf: file)))
+            }
+        } else if FileManager.default.fileExists(atPath: legacyFile.path) {
+            // Older versions kept every profile in one file: split it once
+            stored = try decoder.decode([Profile].self, from: Data(contentsOf: legacyFile))
+            try writeProfiles(stored, deviceId: deviceId)
+            try FileManager.default.removeItem(at: legacyFile)
+            print("ConfigurationStorage: Migrated \(legacyFile.path)")
+        } else {
+            print("ConfigurationStorage: No profile files found, using defaults")
+        }
+
+        for profile in stored {
+            if let index = profiles.firstIndex(where: { $0.id == profile.id }) {
+                profiles[index] = profile
+            } else {
+                profiles.append(profile)
+            }
+        }
+        profiles.sort { $0.id < $1.id }
+        profileCache[deviceId ?? "default"] = profiles
 
-        print("ConfigurationStorage: Loaded \(profiles.count) profiles from \(profilesFile.path)")
+        print("ConfigurationStorage: Loaded \(stored.count) stored profiles from \(directory.path)")
         return profiles
     }
 
     /// Save a single profile
     func saveProfile(_ profile: Profile, deviceId: String?) async throws {
-        var profiles = try await loadProfiles(deviceId: deviceId)
-
-        if let index = profiles.firstIndex(where: { $0.id == profile.id }) {
-            profiles[index] = profile
-        } else {
-            profiles.append(profile)
-        }
-
-        try await saveProfiles(profiles, deviceId: deviceId)
+        try writeProfiles([profile], deviceId: deviceId)
     }
 
     // MARK: - App Settings
@@ -159,6 +199,10 @@ actor ConfigurationStorage {
     // MARK: - Helpers
 
     private func ensureDirectoryExists(at url: URL) async throws {
+        try createDirectory(at: url)
+    }
+
+    private func createDirectory(at url: URL) throws {
         if !FileManager.default.fileExists(atPath: url.path) {
             try FileManager.default.createDirectory(at: url, withIntermediateDirectories: true)
             print("ConfigurationStorage: Created directory at \(url.path)")
@@ -174,6 +218,7 @@ actor ConfigurationStorage {
     func deleteAllConfigurations() async throws {
         if FileManager.default.fileExists(atPath: baseDirectory.path) {
             try FileManager.default.removeItem(at: baseDirectory)
+            profileCache.removeAll()
             print("ConfigurationStorage: Deleted all configurations")
         }
     }
@@ -0,0 +1,104 @@
+import Foundation
+
+/// Write-behind front for `ConfigurationStorage`: edits are collected on the
+/// main actor and written once per window, only for the profiles that changed.
+/// A burst of edits in the key editor becomes one small write instead of a
+/// rewrite of every profile per keystroke.
+@MainActor
+final class ConfigurationWriter {
+    /// Edits made within this window of the first one go out together
+    var delay: Duration = .milliseconds(750)
+
+    /// Latest unsaved value of each edited profile, per device folder
+    private var pendingProfiles: [String?: [Int: Profile]] = [:]
+    private var pendingSettings: ConfigurationStorage.AppSettings?
+    private var writeTask: Task<Void, Never>?
+
+    /// Whether anything is waiting to be written
+    var hasPendingChanges: Bool {
+        !pendingProfiles.isEmpty || pendingSettings != nil
+    }
+
+    /// Queue a profile; a later edit of the same profile replaces it
+    func profileChanged(_ profile: Profile, deviceId: String?) {
+        pendingProfiles[deviceId, default: [:]][profile.id] = profile
+        scheduleWrite()
+    }
+
+    /// Queue settings; only the latest value is written
+    func settingsChanged(_ settings: ConfigurationStorage.AppSettings) {
+        pendingSettings = settings
+        scheduleWrite()
+    }
+
+    /// Write everything now (quit, reset, export)
+    func flush() async {
+        writeTask?.cancel()
+        writeTask = nil
+        await writePending()
+    }
+
+    /// Drop queued edits and wait out a write already in flight (reset)
+    func discard() async {
+        writeTask?.cancel()
+        writeTask = nil
+        pendingProfiles.removeAll()
+        pendingSettings = nil
+        while let activeWrite {
+            await activeWrite.value
+        }
+    }
+
+    private func scheduleWrite() {
+        guard writeTask == nil else { return }  // Joins the open window
+        writeTask = Task { [weak self, delay] in
+            try? await Task.sleep(for: delay)
+            guard !Task.isCancelled, let self else { return }
+            self.writeTask = nil
+            await self.writePending()
+        }
+    }
+
+    /// The write in progress; writes run one after another
+    private var activeWrite: Task<Void, Never>?
+
+    private func writePending() async {
+        while let activeWrite {
+            await activeWrite.value
+        }
+        guard hasPendingChanges else { return }
+
+        let write = Task {
+            await drain()
+            activeWrite = nil
+        }
+        activeWrite = write
+        await write.value
+    }
+
+    /// Edits made while a write is in flight are picked up by the next pass
+    private func drain() async {
+        while hasPendingChanges {
+            let profiles = pendingProfiles
+            let settings = pendingSettings
+            pendingProfiles.removeAll()
+            pendingSettings = nil
+
+            for (deviceId, changed) in profiles {
+                let sorted = changed.values.sorted { $0.id < $1.id }
+                do {
+                    try await ConfigurationStorage.shared.writeProfiles(sorted, deviceId: deviceId)
+                } catch {
+                    print("ConfigurationWriter: Error saving profiles: \(error)")
+                }
+            }
+            if let settings {
+                do {
+                    try await ConfigurationStorage.shared.saveSettings(settings)
+                } catch {
+                    print("ConfigurationWriter: Error saving settings: \(error)")
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,109 @@
+import Foundation
+
+/// One connected keypad: its port, change detection and stats settings.
+/// Every connection is fed from the same sampling pass and packet cache;
+/// each writes through its own queue, so a slow device only drops its own packets.
+@MainActor
+@Observable
+final class DeviceConnection: Identifiable {
+    let device: NexDevice
+    let service = SerialPortService()
+
+    nonisolated var id: String { portPath }
+    nonisolated let portPath: String
+
+    /// Whether stats are being sent to this device
+    var isSendingStats = false
+
+    /// Profile the device was last switched to or reported in a key press
+    /// (nil until known, so the first change always goes out)
+    var deviceProfileId: Int?
+
+    /// Minimum time between stats packets (0 = every sampling tick)
+    var statsInterval: TimeInterval = 0 {
+        didSet { saveSettings() }
+    }
+
+    /// Format chosen in Settings (nil = the most compact one the firmware accepts)
+    var preferredFormat: StatsFormat? {
+        didSet { saveSettings() }
+    }
+
+    /// Formats the firmware accepts, JSON always
+    var supportedFormats: [StatsFormat] {
+        var formats: [StatsFormat] = [.json]
+        if device.supportsPartialStats { formats.append(.delta) }
+        if device.supportsBinaryStats { formats.append(.binary) }
+        return formats
+    }
+
+    /// Format stats actually go out in
+    var statsFormat: StatsFormat {
+        let supported = supportedFormats
+        if let preferredFormat, supported.contains(preferredFormat) {
+            return preferredFormat
+        }
+        return supported.last ?? .json
+    }
+
+    /// Whether the device is connected and ready
+    var isReady: Bool {
+        device.connectionState == .authenticated || device.connectionState == .connected
+    }
+
+    @ObservationIgnored private let encoder = StatsDeltaEncoder()
+    @ObservationIgnored private var lastFormat: StatsFormat?
+    @ObservationIgnored private var lastSent: TimeInterval?
+
+    init(device: NexDevice) {
+        self.device = device
+        self.portPath = device.portPath
+        loadSettings()
+    }
+
+    /// Next packet goes out on the first tick and is a complete keyframe
+    func resetStats() {
+        encoder.reset()
+        lastSent = nil
+    }
+
+    /// Queue this tick's packet if the device is due and something visible changed
+    func sendStats(from cache: StatsPacketCache, at time: TimeInterval) {
+        guard isSendingStats, isReady else { return }
+        if let lastSent, time - lastSent < statsInterval - 0.05 {
+            return  // Not due yet: a late tick still counts as on time
+        }
+
+        let format = statsFormat
+        if format != lastFormat {
+            encoder.reset()  // The firmware can't merge across formats
+            lastFormat = format
+        } else if service.takeStatsFrameLost() {
+            encoder.reset()  // The port dropped an unwritten frame: send everything
+        }
+        guard let packet = encoder.nextPacket(format: format, from: cache) else {
+            return  // Nothing visible changed since the last packet
+        }
+        lastSent = time
+        service.enqueueStats(packet: packet)
+    }
+
+    // MARK: - Settings
+
+    /// Per-port settings: the same keypad stays in the same USB port
+    private var settingsKey: String { "deviceStats.\(portPath)" }
+
+    private func loadSettings() {
+        guard let settings = UserDefaults.standard.dictionary(forKey: settingsKey) else { return }
+        statsInterval = settings["interval"] as? Double ?? 0
+        preferredFormat = (settings["format"] as? String).flatMap(StatsFormat.init(rawValue:))
+    }
+
+    private func saveSettings() {
+        var settings: [String: Any] = ["interval": statsInterval]
+        if let preferredFormat {
+            settings["format"] = preferredFormat.rawValue
+        }
+        UserDefaults.standard.set(settings, forKey: settingsKey)
+    }
+}
@@ -14,14 +14,32 @@ final class DeviceManager {
     /// Discovered devices
     private(set) var discoveredDevices: [DiscoveredDevice] = []
 
-    /// Currently connected device
-    private(set) var connectedDevice: NexDevice?
+    /// Connected devices, in connection order; all share one sampling pass
+    private(set) var connections: [DeviceConnection] = [] {
+        didSet {
+            // Only the devices' displays need power/frequency; stop paying for IOReport without one
+            statsCollector.powerSamplingEnabled = !connections.isEmpty
+        }
+    }
+
+    /// First connected device (profiles, device info and commands use this one)
+    var connectedDevice: NexDevice? {
+        connections.first?.device
+    }
+
+    /// All connected devices
+    var connectedDevices: [NexDevice] {
+        connections.map(\.device)
+    }
 
     /// Stats collector
     let statsCollector = StatsCollector()
 
-    /// Serial port service
-    private let serialService = SerialPortService()
+    /// Port discovery (each connection has its own serial service)
+    private let portScanner = SerialPortService()
+
+    /// Ports that didn't answer the probe; not reopened until they are replugged
+    private var silentPorts: Set<String> = []
 
     /// App-based profile switcher (initialized lazily)
     private var _appProfileSwitcher: AppProfileSwitcher?
@@ -38,20 +56,43 @@ final class DeviceManager {
     /// Current profile configurations (5 profiles, 8 keys each)
     private(set) var profiles: [Profile] = (1...5).map { Profile(id: $0) }
 
+    /// Off-main key press path; holds the profiles' compiled action plans
+    private let keyDispatcher = KeyDispatcher()
+
+    /// Why stored actions were left out of their key's plan, from the same
+    /// compile that built the plans (only keys with invalid actions)
+    private(set) var actionErrors: [KeySlot: [ActionPlanError]] = [:]
+
+    /// Press-to-event latency of device key presses
+    var keyLatency: KeyLatencyStats {
+        keyDispatcher.latencyStats
+    }
+
     /// Whether profiles have been loaded from storage
     private var profilesLoaded = false
 
+    /// Coalesces profile and settings edits into per-profile writes
+    private let configWriter = ConfigurationWriter()
+
+    /// Device folder the profiles were loaded from and are saved to
+    private var profilesDeviceId: String?
+
     /// Current active profile ID
     private(set) var activeProfileId: Int = 1
 
-    /// Stats sending timer
-    private var statsSendTimer: Timer?
+    /// Stats send interval in seconds (stats are sent on every sampling tick)
+    var statsSendInterval: TimeInterval {
+        get { statsCollector.updateInterval }
+        set { statsCollector.updateInterval = newValue }
+    }
 
-    /// Stats send interval in seconds
-    var statsSendInterval: TimeInterval = 3.0
+    /// Whether stats are being sent to any device
+    var isSendingStats: Bool {
+        connections.contains { $0.isSendingStats }
+    }
 
-    /// Whether stats are being sent to device
-    private(set) var isSendingStats = false
+    /// Snapshot and complete packets for the current tick, shared by all connections
+    private let packetCache = StatsPacketCache()
 
     // MARK: - Device State
 
@@ -62,42 +103,86 @@ final class DeviceManager {
 
     /// Whether a device is connected and ready
     var isReady: Bool {
-        connectedDevice?.connectionState == .authenticated ||
-        connectedDevice?.connectionState == .connected
+        connections.contains { $0.isReady }
+    }
+
+    /// Connected devices that accept commands
+    private var readyConnections: [DeviceConnection] {
+        connections.filter(\.isReady)
     }
 
     // MARK: - Initialization
 
     init() {
-        setupSerialCallbacks()
+        actionErrors = keyDispatcher.load(profiles: profiles)
+        observePorts()
+
+        // Send on the collector's tick so the device gets the same snapshot the UI shows
+        statsCollector.onSample = { [weak self] in
+            await self?.sendCurrentStats()
+        }
+
+        let defaults = UserDefaults.standard
+        if defaults.object(forKey: "statsSendInterval") != nil {
+            statsCollector.updateInterval = defaults.double(forKey: "statsSendInterval")
+        }
+        if defaults.object(forKey: "adaptiveSampling") != nil {
+            statsCollector.adaptiveSampling = defaults.bool(forKey: "adaptiveSampling")
+        }
+        statsCollector.powerSamplingEnabled = false  // No device until autoConnect
+
+        if let interfaces = UserDefaults.standard.string(forKey: "networkInterfaces") {
+            statsCollector.networkInterfaces = GeneralSettingsView.interfaceList(interfaces)
+        }
+        statsCollector.exportEnabled = UserDefaults.standard.bool(forKey: "exportStats")
+        statsCollector.metricsEnabled = UserDefaults.standard.bool(forKey: "collectorMetrics")
+        statsCollector.topProcessesEnabled = UserDefaults.standard.bool(forKey: "topProcesses")
     }
 
-    private func setupSerialCallbacks() {
-        serialService.setResponseHandler { [weak self] response in
-            Task { @MainActor [weak self] in
-                self?.handleDeviceResponse(response)
+    private func setupSerialCallbacks(for connection: DeviceConnection) {
+        let service = connection.service
+        service.setResponseHandler { [weak self, weak connection] response in
+            Task { @MainActor [weak self, weak connection] in
+                guard let connection else { return }
+                self?.handleDeviceResponse(response, from: connection)
             }
         }
 
-        serialService.setConnectionHandler { [weak self] connected in
-            Task { @MainActor [weak self] in
-                if !connected {
-                    self?.handleDisconnection()
+        // Runs on the serial callback: dispatch first, log afterwards on the main actor
+        let keyDispatcher = keyDispatcher
+        service.setKeyPressHandler { [weak connection] profileId, keyId in
+            let dispatched = keyDispatcher.dispatch(profileId: profileId, keyId: keyId)
+            Task { @MainActor [weak connection] in
+                connection?.deviceProfileId = profileId
+                print("Key pressed: profile \(profileId), key \(keyId)")
+                if !dispatched {
+                    print("DeviceManager: No actions configured for profile \(profileId), key \(keyId)")
                 }
             }
         }
 
+        service.setConnectionHandler { [weak self, weak connection] connected in
+            Task { @MainActor [weak self, weak connection] in
+                if !connected, let connection {
+                    self?.handleDisconnection(of: connection)
+                }
+            }
+        }
+    }
+
+    private func observePorts() {
         // Observe port changes - auto-connect when new device is plugged in
-        serialService.startObservingPorts { [weak self] _ in
+        portScanner.startObservingPorts { [weak self] _ in
             Task { @MainActor [weak self] in
                 await self?.autoConnect()
             }
         } onRemove: { [weak self] port in
             let portPath = port.path
             Task { @MainActor [weak self] in
-                if self?.connectedDevice?.portPath == portPath {
-                    self?.handleDisconnection()
+                if let connection = self?.connections.first(where: { $0.portPath == portPath }) {
+                    self?.handleDisconnection(of: connection)
                 }
+                self?.silentPorts.remove(portPath)
                 self?.scanForDevices()
             }
         }
@@ -107,42 +192,60 @@ final class DeviceManager {
 
     /// Scan for available devices
     func scanForDevices() {
-        discoveredDevices = serialService.findNexMacroDevices()
+        discoveredDevices = portScanner.findNexMacroDevices()
     }
 
-    /// Auto-connect to the first available NexMacro device
+    /// Auto-connect to every available NexMacro device not connected yet.
+    /// Ports with the NexMacro USB IDs go first; other USB serial ports (FTDI,
+    /// CP210x and CH340 bridges, or IDs the registry didn't report) are probed
+    /// too, and a port that stays silent isn't reopened until it is replugged.
     func autoConnect() async {
-        // Don't auto-connect if already connected
-        guard connectedDevice == nil else { return }
-
         scanForDevices()
 
-        // Connect to first available device (stats auto-start on authentication)
-        if let device = discoveredDevices.first {
+        // Stats auto-start on authentication
+        let connected = Set(connections.map(\.portPath))
+        let candidates = discoveredDevices.filter(\.isNexMacro) + discoveredDevices.filter { !$0.isNexMacro }
+        for device in candidates where !connected.contains(device.portPath) && !silentPorts.contains(device.portPath) {
             await connect(to: device)
+            dropIfSilent(portPath: device.portPath)
+        }
+    }
+
+    /// Close an auto-connected port that never answers the type query: any
+    /// USB serial port is a candidate, and other gadgets shouldn't stay open
+    private func dropIfSilent(portPath: String) {
+        Task { [weak self] in
+            try? await Task.sleep(nanoseconds: 3_000_000_000)
+            guard let self,
+                  let connection = self.connections.first(where: { $0.portPath == portPath }),
+                  connection.device.deviceType == nil else { return }
+            print("DeviceManager: \(portPath) did not answer, closing it")
+            self.silentPorts.insert(portPath)
+            self.disconnect(connection)
         }
     }
 
     // MARK: - Connection
 
-    /// Connect to a device
+    /// Connect to a device (replaces an existing connection on the same port)
     func connect(to device: DiscoveredDevice) async {
-        // Disconnect existing if any
-        if connectedDevice != nil {
-            disconnect()
+        if let existing = connections.first(where: { $0.portPath == device.portPath }) {
+            disconnect(existing)
         }
 
         let nexDevice = NexDevice(portPath: device.portPath, name: device.name)
         nexDevice.connectionState = .connecting
-        connectedDevice = nexDevice
+        let connection = DeviceConnection(device: nexDevice)
+        setupSerialCallbacks(for: connection)
+        connections.append(connection)
 
         do {
-            try await serialService.connect(to: device.portPath)
+            try await connection.service.connect(to: device.portPath)
             nexDevice.connectionState = .connected
             nexDevice.isConnected = true
 
             // Query device info
-            await queryDeviceInfo()
+            await queryDeviceInfo(connection)
 
         } catch {
             nexDevice.connectionState = .error(error.localizedDescription)
@@ -150,22 +253,27 @@ final class DeviceManager {
         }
     }
 
-    /// Disconnect from current device
+    /// Disconnect from all devices
     func disconnect() {
-        stopSendingStats()
-        serialService.disconnect()
-        connectedDevice?.connectionState = .disconnected
-        connectedDevice?.isConnected = false
-        connectedDevice = nil
+        for connection in connections {
+            disconnect(connection)
+        }
+    }
+
+    /// Disconnect from one device
+    func disconnect(_ connection: DeviceConnection) {
+        connection.isSendingStats = false
+        connection.service.disconnect()
+        handleDisconnection(of: connection)
     }
 
     // MARK: - Device Communication
 
     /// Query device type and version
-    private func queryDeviceInfo() async {
+    private func queryDeviceInfo(_ connection: DeviceConnection) async {
         do {
             // Query device type first
-            try serialService.sendCommand(.queryType)
+            try connection.service.sendCommand(.queryType)
 
             // Small delay between commands
             try await Task.sleep(nanoseconds: 100_000_000)
@@ -175,14 +283,26 @@ final class DeviceManager {
         }
     }
 
+    /// Ask which compact stats formats the firmware accepts.
+    /// Stats keep going out as JSON until (and unless) the device answers.
+    private func queryStatsCapabilities(_ connection: DeviceConnection) {
+        let service = connection.service
+        Task {
+            try? await Task.sleep(nanoseconds: 50_000_000)
+            try? service.sendCommand(.queryCapabilities)
+        }
+    }
+
     /// Handle responses from the device
-    private func handleDeviceResponse(_ response: String) {
+    private func handleDeviceResponse(_ response: String, from connection: DeviceConnection) {
         let parsed = NexProtocol.parseResponse(response)
 
-        guard let device = connectedDevice,
+        guard connections.contains(where: { $0 === connection }),
               let responseType = parsed.type else {
             return
         }
+        let device = connection.device
+        let service = connection.service
 
         switch responseType {
         case .deviceType:
@@ -190,7 +310,7 @@ final class DeviceManager {
             // Query version next
             Task {
                 try? await Task.sleep(nanoseconds: 50_000_000)
-                try? serialService.sendCommand(.queryVersion)
+                try? service.sendCommand(.queryVersion)
             }
 
         case .version:
@@ -199,13 +319,14 @@ final class DeviceManager {
             if device.deviceType != .type1 || (device.firmwareVersion ?? 0) >= 22 {
                 Task {
                     try? await Task.sleep(nanoseconds: 50_000_000)
-                    try? serialService.sendCommand(.queryId)
+                    try? service.sendCommand(.queryId)
                 }
             } else {
                 // Old firmware, skip ID query
                 device.connectionState = .connected
                 // Auto-start sending stats for old firmware
-                startSendingStats()
+                startSendingStats(to: connection)
+                queryStatsCapabilities(connection)
             }
 
         case .deviceId:
@@ -213,7 +334,7 @@ final class DeviceManager {
             // Authenticate if we have an ID
             Task {
                 try? await Task.sleep(nanoseconds: 50_000_000)
-                try? serialService.sendCommand(.authenticate)
+                try? service.sendCommand(.authenticate)
             }
 
         case .authenticate:
@@ -221,14 +342,21 @@ final class DeviceManager {
             if let deviceId = device.deviceId,
                let response = NexProtocol.generateAuthResponse(deviceId: deviceId, challenge: parsed.content) {
                 Task {
-                    try? serialService.sendCommand(.authenticate, param: response)
+                    try? service.sendCommand(.authenticate, param: response)
                 }
             }
             device.connectionState = .authenticated
             device.isAuthenticated = true
 
             // Auto-start sending stats once authenticated
-            startSendingStats()
+            startSendingStats(to: connection)
+            queryStatsCapabilities(connection)
+
+        case .capabilities:
+            let caps = NexProtocol.parseCapabilities(parsed.content)
+            device.supportsBinaryStats = caps.binaryVersions.contains(StatsDeltaEncoder.binaryVersion)
+            device.supportsPartialStats = caps.partialJSON
+            // The connection resets its encoder if this changes its format
 
         case .keyDown:
             // Key was pressed on device
@@ -243,32 +371,20 @@ final class DeviceManager {
     }
 
     /// Handle device disconnection
-    private func handleDisconnection() {
-        stopSendingStats()
-        connectedDevice?.connectionState = .disconnected
-        connectedDevice?.isConnected = false
-        connectedDevice = nil
+    private func handleDisconnection(of connection: DeviceConnection) {
+        guard let index = connections.firstIndex(where: { $0 === connection }) else { return }
+        connection.isSendingStats = false
+        connection.device.connectionState = .disconnected
+        connection.device.isConnected = false
+        connections.remove(at: index)
     }
 
-    /// Handle key press from device
+    /// Handle key press from device (string-parsed fallback; the byte path dispatches directly)
     private func handleKeyPress(profileId: Int, keyId: Int) {
         print("Key pressed: profile \(profileId), key \(keyId)")
 
-        // Find the profile and key configuration
-        guard let profile = profiles.first(where: { $0.id == profileId }),
-              let keyConfig = profile.keys.first(where: { $0.id == keyId }) else {
-            print("DeviceManager: No config found for profile \(profileId), key \(keyId)")
-            return
-        }
-
-        // Execute all actions for this key
-        guard !keyConfig.actions.isEmpty else {
-            print("DeviceManager: No actions configured for key \(keyId)")
-            return
-        }
-
-        Task {
-            await ActionExecutor.shared.execute(keyConfig.actions)
+        if !keyDispatcher.dispatch(profileId: profileId, keyId: keyId) {
+            print("DeviceManager: No actions configured for profile \(profileId), key \(keyId)")
         }
     }
 
@@ -280,14 +396,17 @@ final class DeviceManager {
     }
 
     /// Load profiles from storage
+    /// Only the folder of the last connected device is read.
     func loadConfigurations() async {
         guard !profilesLoaded else { return }
 
         do {
-            let deviceId = connectedDevice?.deviceId
-            profiles = try await ConfigurationStorage.shared.loadProfiles(deviceId: deviceId)
             let settings = try await ConfigurationStorage.shared.loadSettings()
+            let deviceId = connectedDevice?.deviceId ?? settings.lastConnectedDeviceId
+            profiles = try await ConfigurationStorage.shared.loadProfiles(deviceId: deviceId)
+            actionErrors = keyDispatcher.load(profiles: profiles)
             activeProfileId = settings.activeProfileId
+            profilesDeviceId = deviceId
             profilesLoaded = true
             print("DeviceManager: Loaded \(profiles.count) profiles")
         } catch {
@@ -296,45 +415,57 @@ final class DeviceManager {
         }
     }
 
-    /// Save current profiles to storage
+    /// Write pending edits now instead of at the end of the coalescing window
     func saveConfigurations() async {
-        do {
-            let deviceId = connectedDevice?.deviceId
-            try await ConfigurationStorage.shared.saveProfiles(profiles, deviceId: deviceId)
-
-            var settings = ConfigurationStorage.AppSettings()
-            settings.activeProfileId = activeProfileId
-            settings.lastConnectedDeviceId = deviceId
-            try await ConfigurationStorage.shared.saveSettings(settings)
+        await configWriter.flush()
+    }
 
-            print("DeviceManager: Saved configurations")
+    /// Delete stored configurations and load the defaults
+    func resetConfigurations() async {
+        await configWriter.discard()
+        do {
+            try await ConfigurationStorage.shared.deleteAllConfigurations()
         } catch {
-            print("DeviceManager: Error saving configurations: \(error)")
+            print("DeviceManager: Error deleting configurations: \(error)")
         }
+        profilesLoaded = false
+        await loadConfigurations()
+    }
+
+    /// Queue settings for the next coalesced write
+    private func settingsChanged() {
+        var settings = ConfigurationStorage.AppSettings()
+        settings.activeProfileId = activeProfileId
+        settings.lastConnectedDeviceId = profilesDeviceId
+        configWriter.settingsChanged(settings)
     }
 
     /// Update key configuration for a profile
-    func updateKeyConfig(profileId: Int, keyId: Int, config: KeyConfig) {
+    /// - Throws: `ActionPlanError` if an action added or changed by this edit cannot
+    ///   be executed; nothing is changed. Invalid actions the key already had (stored
+    ///   before validation) don't block renames, moves or deletes; they stay skipped.
+    func updateKeyConfig(profileId: Int, keyId: Int, config: KeyConfig) throws {
         guard let profileIndex = profiles.firstIndex(where: { $0.id == profileId }) else {
             return
         }
+        let previous = profiles[profileIndex].keys.first { $0.id == keyId }?.actions ?? []
+        let (plan, errors) = ActionPlan.compileCollectingErrors(config.actions)
+        if let error = errors.first(where: { !previous.contains(config.actions[$0.index]) }) {
+            throw error
+        }
         profiles[profileIndex].setKey(keyId, config: config)
+        keyDispatcher.setPlan(plan, profileId: profileId, keyId: keyId)
+        actionErrors[KeySlot(profileId: profileId, keyId: keyId)] = errors.isEmpty ? nil : errors
 
-        // Auto-save after modification
-        Task {
-            await saveConfigurations()
-        }
+        // Written behind: only this profile, once the edits settle
+        configWriter.profileChanged(profiles[profileIndex], deviceId: profilesDeviceId)
     }
 
     /// Set active profile
     func setActiveProfile(_ profileId: Int) {
         guard profileId >= 1, profileId <= 5 else { return }
         activeProfileId = profileId
-
-        // Auto-save after modification
-        Task {
-            await saveConfigurations()
-        }
+        settingsChanged()
     }
 
     // MARK: - Dynamic Profile Switching
@@ -376,66 +507,73 @@ final class DeviceManager {
 
     // MARK: - Stats Sending
 
-    /// Start sending stats to the connected device
+    /// Start sending stats to every ready device
     func startSendingStats() {
-        guard isReady, !isSendingStats else { return }
+        for connection in readyConnections {
+            startSendingStats(to: connection)
+        }
+    }
 
-        isSendingStats = true
+    /// Start sending stats to one device
+    func startSendingStats(to connection: DeviceConnection) {
+        guard connection.isReady, !connection.isSendingStats else { return }
 
-        // Start stats collection if not running
-        if !statsCollector.isRunning {
+        connection.isSendingStats = true
+        connection.resetStats()  // Display may show stale data: start with a keyframe
+
+        if statsCollector.isRunning {
+            // Send the latest snapshot immediately, then on every tick
+            packetCache.load()
+            connection.sendStats(from: packetCache, at: ProcessInfo.processInfo.systemUptime)
+        } else {
+            // First tick of the collector sends
             Task {
                 await statsCollector.start()
             }
         }
-
-        // Start sending timer
-        statsSendTimer = Timer.scheduledTimer(withTimeInterval: statsSendInterval, repeats: true) { [weak self] _ in
-            Task { @MainActor [weak self] in
-                await self?.sendCurrentStats()
-            }
-        }
-
-        // Send immediately
-        Task {
-            await sendCurrentStats()
-        }
     }
 
-    /// Stop sending stats
+    /// Stop sending stats to all devices
     func stopSendingStats() {
-        statsSendTimer?.invalidate()
-        statsSendTimer = nil
-        isSendingStats = false
+        for connection in connections {
+            connection.isSendingStats = false
+        }
     }
 
-    /// Send current stats to device
+    /// Fan the current snapshot out: read and encode once, queue per device
     private func sendCurrentStats() async {
-        guard isReady else { return }
+        let sending = connections.filter { $0.isSendingStats && $0.isReady }
+        guard !sending.isEmpty else { return }
 
-        do {
-            let json = await statsCollector.getJSON()
-            try serialService.sendStats(json: json)
-        } catch {
-            print("Error sending stats: \(error)")
+        packetCache.load()
+        let now = ProcessInfo.processInfo.systemUptime
+        for connection in sending {
+            connection.sendStats(from: packetCache, at: now)
         }
     }
 
     // MARK: - Device Commands
 
-    /// Send reboot command to device
+    /// Send reboot command to the first device
     func rebootDevice() {
-        try? serialService.sendCommand(.reboot)
+        try? connections.first?.service.sendCommand(.reboot)
     }
 
-    /// Send reset command to device
+    /// Send reset command to the first device
     func resetDevice() {
-        try? serialService.sendCommand(.reset)
+        try? connections.first?.service.sendCommand(.reset)
     }
 
-    /// Change active profile
+    /// Change active profile on every device that isn't on it already
     func changeProfile(to profileId: Int) {
-        try? serialService.sendCommand(.changeProfile, param: String(profileId))
+        for connection in readyConnections where connection.deviceProfileId != profileId {
+            do {
+                try connection.service.sendCommand(.changeProfile, param: String(profileId))
+                connection.deviceProfileId = profileId
+            } catch {
+                print("DeviceManager: Error changing profile on \(connection.portPath): \(error)")
+            }
+        }
     }
 
     // MARK: - RGB Control
@@ -477,7 +615,9 @@ final class DeviceManager {
     func setRgbColor(r: UInt8, g: UInt8, b: UInt8) {
         guard isReady else { return }
         do {
-            try serialService.sendRgbColor(r: r, g: g, b: b)
+            for connection in readyConnections {
+                try connection.service.sendRgbColor(r: r, g: g, b: b)
+            }
             rgbColor = (r, g, b)
         } catch {
             print("DeviceManager: Error setting RGB color: \(error)")
@@ -493,7 +633,9 @@ final class DeviceManager {
         }
         do {
             print("DeviceManager: Sending RGB mode \(mode.rawValue) to device")
-            try serialService.sendRgbMode(mode.rawValue)
+            for connection in readyConnections {
+                try connection.service.sendRgbMode(mode.rawValue)
+            }
             rgbMode = mode
             print("DeviceManager: RGB mode set successfully")
         } catch {
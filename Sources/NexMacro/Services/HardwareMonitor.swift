@@ -29,12 +29,194 @@ struct RawPcStats: Sendable {
     var networkUpMbps: Float = 0
     var networkDownMbps: Float = 0
     var timestamp: Int64 = 0
+    var coreLoads: [Float] = []
+    var perfCoreCount: Int = 0
+    var efficiencyCoreCount: Int = 0
+    var clusters: [CpuClusterStats] = []
+    var interfaces: [NetworkInterfaceStats] = []
+    var memoryWiredGB: Float = 0
+    var memoryCompressedGB: Float = 0
+    var swapUsedGB: Float = 0
+    var swapTotalGB: Float = 0
+    var memoryPressure: MemoryPressure = .normal
+    /// Snapshot sequence number (0 = nothing sampled yet)
+    var sequence: UInt64 = 0
 }
 
-/// Service for collecting hardware statistics using the native C library
+/// Kernel memory pressure level
+enum MemoryPressure: String, Sendable {
+    case normal = "Normal"
+    case warning = "Warning"
+    case critical = "Critical"
+
+    init(_ level: PcMemoryPressure) {
+        switch level {
+        case PCSTATS_MEMORY_PRESSURE_WARNING: self = .warning
+        case PCSTATS_MEMORY_PRESSURE_CRITICAL: self = .critical
+        default: self = .normal
+        }
+    }
+}
+
+/// Throughput of one counted network interface
+struct NetworkInterfaceStats: Sendable, Equatable {
+    var name: String
+    var upMbps: Float
+    var downMbps: Float
+}
+
+/// Frequency and residency of one CPU cluster (E, P, P1...)
+struct CpuClusterStats: Sendable, Equatable {
+    var name: String
+    var freqMHz: Float
+    var load: Float
+}
+
+extension RawPcStats {
+    /// Convert from the C snapshot structure
+    init(_ cStatus: CPcStats.PcStatus) {
+        boardTemp = cStatus.board.temp
+        boardFanRPM = cStatus.board.rpm
+        uptimeSeconds = Int(cStatus.board.tick)
+        cpuTemp = cStatus.cpu.temp
+        cpuTempMax = cStatus.cpu.tempMax
+        cpuLoad = cStatus.cpu.load
+        cpuPower = cStatus.cpu.consume
+        cpuTjMax = Int(cStatus.cpu.tjMax)
+        gpuTemp = cStatus.gpu.temp
+        gpuTempMax = cStatus.gpu.tempMax
+        gpuLoad = cStatus.gpu.load
+        gpuPower = cStatus.gpu.consume
+        gpuFanRPM = cStatus.gpu.rpm
+        gpuMemUsed = cStatus.gpu.memUsed
+        gpuMemTotal = cStatus.gpu.memTotal
+        gpuFreqMHz = cStatus.gpu.freq
+        storageTemp = cStatus.storage.temp
+        storageRead = cStatus.storage.read
+        storageWrite = cStatus.storage.write
+        storagePercent = cStatus.storage.percent
+        memoryUsedGB = cStatus.memory.used
+        memoryAvailGB = cStatus.memory.avail
+        memoryPercent = cStatus.memory.percent
+        networkUpMbps = cStatus.network.up
+        networkDownMbps = cStatus.network.down
+        timestamp = Int64(cStatus.time_stamp)
+    }
+
+    /// Add the extended per-core/per-cluster fields
+    mutating func applyExtended(_ ext: CPcStats.PcStatusExt) {
+        var cores = ext.cores
+        let coreCount = Int(max(0, min(cores.core_count, PCSTATS_MAX_CORES)))
+        coreLoads = withUnsafeBytes(of: &cores.core_load) { raw in
+            Array(raw.bindMemory(to: Float.self).prefix(coreCount))
+        }
+        perfCoreCount = Int(cores.perf_core_count)
+        efficiencyCoreCount = Int(cores.efficiency_core_count)
+
+        let clusterCount = Int(max(0, min(cores.cluster_count, PCSTATS_MAX_CLUSTERS)))
+        let freqs = withUnsafeBytes(of: &cores.cluster_freq) { Array($0.bindMemory(to: Float.self)) }
+        let loads = withUnsafeBytes(of: &cores.cluster_load) { Array($0.bindMemory(to: Float.self)) }
+        let names = withUnsafeBytes(of: &cores.cluster_name) { raw -> [String] in
+            let nameSize = raw.count / Int(PCSTATS_MAX_CLUSTERS)
+            return (0..<clusterCount).map { i in
+                let bytes = raw[(i * nameSize)..<((i + 1) * nameSize)]
+                return String(decoding: bytes.prefix { $0 != 0 }, as: UTF8.self)
+            }
+        }
+        clusters = (0..<clusterCount).map { i in
+            CpuClusterStats(name: names[i], freqMHz: freqs[i], load: loads[i])
+        }
+
+        let gigabyte = Float(1024 * 1024 * 1024)
+        memoryWiredGB = Float(ext.memory.wired_bytes) / gigabyte
+        memoryCompressedGB = Float(ext.memory.compressed_bytes) / gigabyte
+        swapUsedGB = Float(ext.memory.swap_used_bytes) / gigabyte
+        swapTotalGB = Float(ext.memory.swap_total_bytes) / gigabyte
+        memoryPressure = MemoryPressure(ext.memory.pressure_level)
+
+        var network = ext.network
+        let interfaceCount = Int(max(0, min(network.interface_count, PCSTATS_MAX_INTERFACES)))
+        interfaces = withUnsafeBytes(of: &network.interfaces) { raw in
+            raw.bindMemory(to: InterfaceStats.self).prefix(interfaceCount).map { iface in
+                var name = iface.name
+                let nameString = withUnsafeBytes(of: &name) { bytes in
+                    String(decoding: bytes.prefix { $0 != 0 }, as: UTF8.self)
+                }
+                return NetworkInterfaceStats(name: nameString, upMbps: iface.up, downMbps: iface.down)
+            }
+        }
+    }
+}
+
+/// Boxes the Swift sample handler so it can travel through the C callback context
+private final class SamplerCallbackBox: @unchecked Sendable {
+    let handler: @Sendable (UInt64) -> Void
+
+    init(_ handler: @escaping @Sendable (UInt64) -> Void) {
+        self.handler = handler
+    }
+}
+
+/// Latency of one instrumented collector (`PcStatsTimer`), in milliseconds
+struct CollectorTiming: Sendable, Identifiable {
+    let name: String
+    let count: UInt64
+    let p50Ms: Double
+    let p99Ms: Double
+    let maxMs: Double
+
+    var id: String { name }
+}
+
+/// IOKit call, error and serial byte counters (`PcStatsCounter`)
+struct CollectorCounter: Sendable, Identifiable {
+    let name: String
+    let value: UInt64
+
+    var id: String { name }
+}
+
+struct CollectorMetrics: Sendable {
+    var timings: [CollectorTiming] = []
+    var counters: [CollectorCounter] = []
+}
+
+/// One busy process from the last processes pass (`PcProcessStats`)
+struct ProcessUsage: Sendable, Equatable, Identifiable {
+    let pid: Int32
+    let name: String
+    let cpuPercent: Float     // Of one core
+    let gpuPercent: Float
+    let footprintGB: Float
+
+    var id: Int32 { pid }
+}
+
+/// One SMC temperature key from the last temperatures pass (`PcSensorReading`)
+struct TemperatureSensor: Sendable, Equatable, Identifiable {
+    let key: String
+    let kind: PcSensorKind
+    let celsius: Float
+
+    var id: String { key }
+
+    var kindName: String {
+        switch kind {
+        case PCSTATS_SENSOR_CPU_EFFICIENCY: return "E-CPU"
+        case PCSTATS_SENSOR_CPU_PERFORMANCE: return "P-CPU"
+        case PCSTATS_SENSOR_GPU: return "GPU"
+        default: return "Board"
+        }
+    }
+}
+
+/// Service for collecting hardware statistics using the native C library.
+/// Sampling is serialized by the actor (or owned by the C background sampler);
+/// snapshot reads are `nonisolated` because the C snapshot is lock-free.
 actor HardwareMonitor {
     private var isInitialized = false
     private var tempsEnabled = false
+    private var samplerBox: Unmanaged<SamplerCallbackBox>?
 
     /// Shared instance
     static let shared = HardwareMonitor()
@@ -44,162 +226,631 @@ actor HardwareMonitor {
     /// Initialize the hardware monitoring system
     func initialize() {
         guard !isInitialized else { return }
+        if let path = Self.probeCacheURL()?.path {
+            pcstats_set_probe_cache_path(path)
+        }
         pcstats_init()
         isInitialized = true
     }
 
+    /// ~/Library/Caches/NexMacro, created on first use
+    nonisolated private static func cacheDirectory() -> URL? {
+        guard let caches = FileManager.default.urls(for: .cachesDirectory, in: .userDomainMask).first else {
+            return nil
+        }
+        let directory = caches.appendingPathComponent("NexMacro", isDirectory: true)
+        try? FileManager.default.createDirectory(at: directory, withIntermediateDirectories: true)
+        return directory
+    }
+
+    /// Sensor probe results from the last launch
+    private static func probeCacheURL() -> URL? {
+        cacheDirectory()?.appendingPathComponent("probe-cache.bin")
+    }
+
+    // MARK: - Export
+
+    /// Mapped snapshot for other processes (`PcStatsExportRegion`)
+    nonisolated static var exportRegionURL: URL? {
+        cacheDirectory()?.appendingPathComponent("stats.shm")
+    }
+
+    /// Unix socket serving Prometheus text
+    nonisolated static var exportSocketURL: URL? {
+        cacheDirectory()?.appendingPathComponent("stats.sock")
+    }
+
+    /// Publish every snapshot to `exportRegionURL` and serve `exportSocketURL`
+    nonisolated func setExportEnabled(_ enabled: Bool) {
+        guard enabled else {
+            pcstats_export_socket_stop()
+            pcstats_export_shm_close()
+            return
+        }
+        if let path = Self.exportRegionURL?.path, pcstats_export_shm_open(path) != 0 {
+            print("HardwareMonitor: Could not map \(path)")
+        }
+        if let path = Self.exportSocketURL?.path, pcstats_export_socket_start(path) != 0 {
+            print("HardwareMonitor: Could not listen on \(path)")
+        }
+    }
+
+    // MARK: - Metrics
+
+    /// Record per-collector timings and IOKit call counters
+    nonisolated func setMetricsEnabled(_ enabled: Bool) {
+        pcstats_metrics_enable(enabled ? 1 : 0)
+    }
+
+    /// Everything recorded since metrics were last reset
+    nonisolated func metrics() -> CollectorMetrics {
+        var raw = PcStatsMetrics()
+        pcstats_get_metrics(&raw)
+
+        var result = CollectorMetrics()
+        withUnsafeBytes(of: raw.timers) { buffer in
+            for (index, timer) in buffer.bindMemory(to: PcStatsTimerStats.self).enumerated() {
+                result.timings.append(CollectorTiming(
+                    name: String(cString: pcstats_metrics_timer_name(PcStatsTimer(UInt32(index)))),
+                    count: timer.count,
+                    p50Ms: Double(timer.p50_ns) / 1_000_000,
+                    p99Ms: Double(timer.p99_ns) / 1_000_000,
+                    maxMs: Double(timer.max_ns) / 1_000_000
+                ))
+            }
+        }
+        withUnsafeBytes(of: raw.counters) { buffer in
+            for (index, value) in buffer.bindMemory(to: UInt64.self).enumerated() {
+                result.counters.append(CollectorCounter(
+                    name: String(cString: pcstats_metrics_counter_name(PcStatsCounter(UInt32(index)))),
+                    value: value
+                ))
+            }
+        }
+        return result
+    }
+
+    // MARK: - Top Processes
+
+    /// Track per-process CPU/GPU time (the table is freed when disabled)
+    nonisolated func setTopProcessesEnabled(_ enabled: Bool) {
+        pcstats_processes_enable(enabled ? 1 : 0)
+    }
+
+    /// Busiest processes from the last pass, busiest first
+    nonisolated func topProcesses(by sort: PcProcessSort, limit: Int) -> [ProcessUsage] {
+        var raw = [PcProcessStats](repeating: PcProcessStats(), count: Int(PCSTATS_MAX_TOP_PROCESSES))
+        let count = Int(pcstats_get_top_processes(sort, &raw, Int32(min(limit, raw.count))))
+        return raw.prefix(count).map { process in
+            let name = withUnsafeBytes(of: process.name) { buffer in
+                String(decoding: buffer.prefix { $0 != 0 }, as: UTF8.self)
+            }
+            return ProcessUsage(pid: process.pid, name: name,
+                                cpuPercent: process.cpu_percent, gpuPercent: process.gpu_percent,
+                                footprintGB: Float(process.footprint_bytes) / 1_073_741_824)
+        }
+    }
+
+    // MARK: - Temperature Sensors
+
+    /// Every SMC temperature key behind the CPU/GPU/board averages
+    nonisolated func temperatureSensors() -> [TemperatureSensor] {
+        var raw = [PcSensorReading](repeating: PcSensorReading(), count: Int(PCSTATS_MAX_SENSORS))
+        let count = Int(pcstats_get_sensors(&raw, Int32(raw.count)))
+        return raw.prefix(count).map { reading in
+            let key = withUnsafeBytes(of: reading.key) { buffer in
+                String(decoding: buffer.prefix { $0 != 0 }, as: UTF8.self)
+            }
+            return TemperatureSensor(key: key, kind: PcSensorKind(UInt32(reading.kind)), celsius: reading.celsius)
+        }
+    }
+
+    /// Key table the sensors came from ("M3", or "generic" when probed)
+    nonisolated func sensorTable() -> String {
+        String(cString: pcstats_sensor_table())
+    }
+
     /// Enable or disable temperature reading
     func enableTemperatures(_ enable: Bool) {
         pcstats_enable_temps(enable ? 1 : 0)
         tempsEnabled = enable
     }
 
-    /// Collect current hardware statistics as raw data
+    /// Run one sampling pass and return the resulting snapshot
+    /// (while the background sampler runs, this just returns its latest snapshot)
     func collectRawStats() -> RawPcStats {
         if !isInitialized {
             initialize()
         }
 
-        var cStatus = CPcStats.PcStatus()
-        collect_stats(&cStatus)
-
-        var stats = RawPcStats()
-        stats.boardTemp = cStatus.board.temp
-        stats.boardFanRPM = cStatus.board.rpm
-        stats.uptimeSeconds = Int(cStatus.board.tick)
-        stats.cpuTemp = cStatus.cpu.temp
-        stats.cpuTempMax = cStatus.cpu.tempMax
-        stats.cpuLoad = cStatus.cpu.load
-        stats.cpuPower = cStatus.cpu.consume
-        stats.cpuTjMax = Int(cStatus.cpu.tjMax)
-        stats.gpuTemp = cStatus.gpu.temp
-        stats.gpuTempMax = cStatus.gpu.tempMax
-        stats.gpuLoad = cStatus.gpu.load
-        stats.gpuPower = cStatus.gpu.consume
-        stats.gpuFanRPM = cStatus.gpu.rpm
-        stats.gpuMemUsed = cStatus.gpu.memUsed
-        stats.gpuMemTotal = cStatus.gpu.memTotal
-        stats.gpuFreqMHz = cStatus.gpu.freq
-        stats.storageTemp = cStatus.storage.temp
-        stats.storageRead = cStatus.storage.read
-        stats.storageWrite = cStatus.storage.write
-        stats.storagePercent = cStatus.storage.percent
-        stats.memoryUsedGB = cStatus.memory.used
-        stats.memoryAvailGB = cStatus.memory.avail
-        stats.memoryPercent = cStatus.memory.percent
-        stats.networkUpMbps = cStatus.network.up
-        stats.networkDownMbps = cStatus.network.down
-        stats.timestamp = Int64(cStatus.time_stamp)
-
-        return stats
+        pcstats_sample()
+        return snapshotRawStats()
     }
 
-    /// Build JSON string for device transmission
-    func buildJSON() -> String {
+    // MARK: - Background Sampler
+
+    /// Start the C background sampler thread.
+    /// `onSample` is called on the sampler thread after each snapshot is published.
+    /// Returns false if the thread could not be started.
+    @discardableResult
+    func startSampler(interval: TimeInterval, onSample: @escaping @Sendable (UInt64) -> Void) -> Bool {
         if !isInitialized {
             initialize()
         }
+        stopSampler()
+
+        let box = Unmanaged.passRetained(SamplerCallbackBox(onSample))
+        let result = pcstats_sampler_start(Self.milliseconds(interval), { seq, ctx in
+            guard let ctx = ctx else { return }
+            Unmanaged<SamplerCallbackBox>.fromOpaque(ctx).takeUnretainedValue().handler(seq)
+        }, box.toOpaque())
+
+        guard result == 0 else {
+            box.release()
+            return false
+        }
+        samplerBox = box
+        return true
+    }
+
+    /// Stop the background sampler (no callbacks run after this returns)
+    func stopSampler() {
+        pcstats_sampler_stop()
+        samplerBox?.release()
+        samplerBox = nil
+    }
+
+    /// Change the background sampler interval
+    nonisolated func setSamplerInterval(_ interval: TimeInterval) {
+        pcstats_sampler_set_interval(Self.milliseconds(interval))
+    }
+
+    /// Have the background sampler run now instead of at the end of its interval
+    nonisolated func triggerSample() {
+        pcstats_sampler_trigger()
+    }
+
+    /// Release the IOReport subscription (power/frequency read as 0 while paused)
+    nonisolated func setIOReportPaused(_ paused: Bool) {
+        pcstats_set_ioreport_paused(paused ? 1 : 0)
+    }
+
+    private static func milliseconds(_ interval: TimeInterval) -> UInt32 {
+        UInt32(max(1, min(interval * 1000, Double(UInt32.max))))
+    }
+
+    /// Only count the named interfaces (e.g. ["en0"]); empty restores the
+    /// default of all physical interfaces. Names beyond the C limit are dropped.
+    nonisolated func setNetworkInterfaces(_ names: [String]) {
+        let limited = Array(names.prefix(Int(PCSTATS_MAX_INTERFACES)))
+        let cStrings = limited.map { strdup($0) }
+        defer { cStrings.forEach { free($0) } }
+
+        let pointers = cStrings.map { UnsafePointer<CChar>($0) }
+        pointers.withUnsafeBufferPointer { buffer in
+            _ = pcstats_set_network_interfaces(buffer.baseAddress, Int32(buffer.count))
+        }
+    }
+
+    // MARK: - Snapshot Reads (wait-free, no actor hop)
 
+    /// Read the current snapshot without sampling again
+    nonisolated func snapshotRawStats() -> RawPcStats {
         var cStatus = CPcStats.PcStatus()
-        collect_stats(&cStatus)
+        var cExt = CPcStats.PcStatusExt()
+        let seq = pcstats_snapshot_get_ext(&cStatus, &cExt)
+        var stats = RawPcStats(cStatus)
+        stats.applyExtended(cExt)
+        stats.sequence = seq
+        return stats
+    }
 
-        var buffer = [CChar](repeating: 0, count: 2048)
-        let length = build_json(&cStatus, &buffer, buffer.count)
+    // MARK: - History
 
-        if length > 0 {
-            return String(cString: buffer)
+    /// Copy a metric's points since `since` into `buffer` (oldest first) without
+    /// allocating; keeps the most recent `buffer.count`. Returns the number written.
+    nonisolated func copyHistory(_ metric: PcStatsMetric, tier: PcStatsTier, since: Date,
+                                 into buffer: inout [PcStatsHistoryPoint]) -> Int {
+        let sinceMs = Int64(since.timeIntervalSince1970 * 1000)
+        return buffer.withUnsafeMutableBufferPointer { points in
+            Int(pcstats_history_copy(tier, metric, sinceMs, points.baseAddress, Int32(points.count)))
         }
-        return "{}"
+    }
+
+    /// Min/max/avg of a metric since `since` (nil if there is no history yet)
+    nonisolated func historySummary(_ metric: PcStatsMetric, tier: PcStatsTier, since: Date) -> PcStatsHistoryPoint? {
+        var summary = PcStatsHistoryPoint()
+        let sinceMs = Int64(since.timeIntervalSince1970 * 1000)
+        return pcstats_history_summary(tier, metric, sinceMs, &summary) > 0 ? summary : nil
     }
 
     /// Get CPU usage percentage
-    func getCPUUsage() -> Float {
-        return get_cpu_usage()
+    nonisolated func getCPUUsage() -> Float {
+        snapshotRawStats().cpuLoad
     }
 
     /// Get CPU temperature
-    func getCPUTemperature() -> Float {
-        return get_cpu_temperature()
+    nonisolated func getCPUTemperature() -> Float {
+        get_cpu_temperature()
     }
 
     /// Get GPU temperature
-    func getGPUTemperature() -> Float {
-        return get_gpu_temperature()
+    nonisolated func getGPUTemperature() -> Float {
+        get_gpu_temperature()
     }
 
     /// Get memory usage
-    func getMemoryUsage() -> (used: Float, available: Float, percent: Float) {
-        var mem = CPcStats.Memory()
-        get_memory_usage(&mem)
-        return (used: mem.used, available: mem.avail, percent: mem.percent)
+    nonisolated func getMemoryUsage() -> (used: Float, available: Float, percent: Float) {
+        let stats = snapshotRawStats()
+        return (used: stats.memoryUsedGB, available: stats.memoryAvailGB, percent: stats.memoryPercent)
     }
 
     /// Get network throughput in Mb/s
-    func getNetworkThroughput() -> (up: Float, down: Float) {
-        var net = CPcStats.Network()
-        get_network_throughput(&net)
-        return (up: net.up, down: net.down)
+    nonisolated func getNetworkThroughput() -> (up: Float, down: Float) {
+        let stats = snapshotRawStats()
+        return (up: stats.networkUpMbps, down: stats.networkDownMbps)
     }
 
     /// Get disk usage
-    func getDiskUsage() -> (temp: Float, read: Float, write: Float, percent: Float) {
-        var storage = CPcStats.Storage()
-        get_disk_usage(&storage)
-        return (temp: storage.temp, read: storage.read, write: storage.write, percent: storage.percent)
+    nonisolated func getDiskUsage() -> (temp: Float, read: Float, write: Float, percent: Float) {
+        let stats = snapshotRawStats()
+        return (temp: stats.storageTemp, read: stats.storageRead, write: stats.storageWrite, percent: stats.storagePercent)
     }
 
     /// Get uptime in seconds
-    func getUptimeSeconds() -> Int {
-        return Int(get_uptime_seconds())
+    nonisolated func getUptimeSeconds() -> Int {
+        Int(get_uptime_seconds())
+    }
+}
+
+// MARK: - Delta Packet Encoder
+
+/// Per-connection change detection for stats packets.
+/// Skips ticks where nothing visible changed and, when the firmware merges
+/// partial updates, sends only the dirty sections; a full keyframe goes out
+/// every `keyframeInterval` packets and after `reset()`.
+final class StatsDeltaEncoder {
+    private var state = PcStatsDelta()
+
+    init(keyframeInterval: UInt32 = UInt32(PCSTATS_DELTA_DEFAULT_KEYFRAME)) {
+        pcstats_delta_init(&state, keyframeInterval)
+    }
+
+    /// Force the next packet to be a full keyframe (e.g. after reconnecting)
+    func reset() {
+        pcstats_delta_reset(&state)
+    }
+
+    /// Scale the per-field hysteresis (1 = default, 0 = send on any change)
+    var thresholdScale: Float {
+        get { state.threshold_scale }
+        set { state.threshold_scale = max(0, newValue) }
+    }
+
+    /// Binary frame version this build encodes
+    static let binaryVersion = Int(PCSTATS_BINARY_VERSION)
+
+    /// Packet for the tick in `cache`; complete packets are shared with every other
+    /// connection using the same format on this tick
+    func nextPacket(format: StatsFormat, from cache: StatsPacketCache) -> Data? {
+        let sections = pcstats_delta_plan(&state, &cache.status, format.flags)
+        guard sections != 0 else { return nil }
+
+        let packet: Data?
+        if sections == PCSTATS_SECTION_ALL.rawValue {
+            packet = cache.completePacket(binary: format == .binary)
+        } else {
+            packet = StatsPacketCache.build { buffer, size in
+                pcstats_build_sections_packet(&cache.status, sections, buffer, size)
+            }
+        }
+        guard let packet else { return nil }
+
+        pcstats_delta_mark_sent(&state, &cache.status, sections)
+        return packet
+    }
+}
+
+/// Stats wire format for one connection
+enum StatsFormat: String, CaseIterable, Sendable {
+    case json     // Complete JSON packet on every change
+    case delta    // JSON with only the changed sections (firmware merges them)
+    case binary   // "pcb" frame
+
+    var flags: Int32 {
+        switch self {
+        case .json: return 0
+        case .delta: return PCSTATS_PACKET_PARTIAL
+        case .binary: return PCSTATS_PACKET_BINARY
+        }
+    }
+
+    var displayName: String {
+        switch self {
+        case .json: return "JSON"
+        case .delta: return "Delta JSON"
+        case .binary: return "Binary"
+        }
+    }
+}
+
+/// One snapshot per sampling tick and its complete packets, each encoded at
+/// most once however many devices it is sent to
+final class StatsPacketCache {
+    fileprivate(set) var status = CPcStats.PcStatus()
+    private var json: Data?
+    private var binary: Data?
+
+    /// Take the latest snapshot and drop the packets built for the previous one
+    func load() {
+        pcstats_snapshot_get(&status)
+        json = nil
+        binary = nil
+    }
+
+    fileprivate func completePacket(binary isBinary: Bool) -> Data? {
+        if isBinary {
+            if binary == nil {
+                binary = Self.build { pcstats_build_binary_packet(&status, $0, $1) }
+            }
+            return binary
+        }
+        if json == nil {
+            json = Self.build { pcstats_build_packet(&status, $0, $1) }
+        }
+        return json
+    }
+
+    fileprivate static func build(_ encode: (UnsafeMutablePointer<UInt8>?, Int) -> Int32) -> Data? {
+        var packet = Data(count: Int(PCSTATS_MAX_PACKET_LEN))
+        let length = packet.withUnsafeMutableBytes { buffer in
+            encode(buffer.bindMemory(to: UInt8.self).baseAddress, buffer.count)
+        }
+        guard length > 0 else { return nil }
+
+        packet.count = Int(length)
+        return packet
     }
 }
 
 // MARK: - Stats Collection Timer
 
-/// Manages periodic stats collection
+/// Manages periodic stats collection.
+/// This is the single scheduler for sampling: each tick runs exactly one
+/// sampling pass, then notifies `onSample` so consumers (like the serial
+/// sender) read the same snapshot instead of sampling on their own timers.
 @MainActor
 @Observable
 final class StatsCollector {
     private(set) var currentStats: PcStats
     private var timer: Timer?
+    private var samplerActive = false
+    private var lastSequence: UInt64 = 0
     private let monitor = HardwareMonitor.shared
-    var updateInterval: TimeInterval = 3.0
+    private let activity: SystemActivityMonitor
+    private var policy = AdaptiveSamplingPolicy()
+
+    /// Sample on the C background thread instead of on a main-thread timer.
+    /// Falls back to the timer if the thread cannot be started.
+    var usesBackgroundSampler = true
+
+    /// Seconds between sampling passes; with `adaptiveSampling` this is the
+    /// interval for steady, moderately changing stats
+    var updateInterval: TimeInterval = 3.0 {
+        didSet {
+            guard oldValue != updateInterval else { return }
+            policy.baseInterval = updateInterval
+            restartPolicy()
+        }
+    }
+
+    /// Sample faster while load or temperature move quickly, and back off
+    /// while they are stable, the display sleeps, the session is locked or
+    /// the Mac runs on battery
+    var adaptiveSampling = true {
+        didSet {
+            guard oldValue != adaptiveSampling else { return }
+            restartPolicy()
+        }
+    }
+
+    /// Interval the scheduler currently uses
+    private(set) var samplingInterval: TimeInterval = 3.0
+
+    /// Sample IOReport power/frequency; off releases the subscription
+    var powerSamplingEnabled = true {
+        didSet {
+            guard oldValue != powerSamplingEnabled else { return }
+            monitor.setIOReportPaused(!powerSamplingEnabled)
+        }
+    }
+
+    /// Interfaces counted for network throughput (empty = all physical interfaces)
+    var networkInterfaces: [String] = [] {
+        didSet {
+            guard oldValue != networkInterfaces else { return }
+            monitor.setNetworkInterfaces(networkInterfaces)
+        }
+    }
+
+    /// Share snapshots with other processes (mapped file + Prometheus socket)
+    var exportEnabled = false {
+        didSet {
+            guard oldValue != exportEnabled else { return }
+            monitor.setExportEnabled(exportEnabled)
+        }
+    }
+
+    /// Record collector timings; `metrics` is refreshed with every snapshot while on
+    var metricsEnabled = false {
+        didSet {
+            guard oldValue != metricsEnabled else { return }
+            monitor.setMetricsEnabled(metricsEnabled)
+            if !metricsEnabled { metrics = nil }
+        }
+    }
+
+    /// Collector timings and counters (nil while `metricsEnabled` is off)
+    private(set) var metrics: CollectorMetrics?
+
+    /// Track which processes use the CPU and GPU; the lists refresh with every snapshot
+    var topProcessesEnabled = false {
+        didSet {
+            guard oldValue != topProcessesEnabled else { return }
+            monitor.setTopProcessesEnabled(topProcessesEnabled)
+            if !topProcessesEnabled {
+                topCPUProcesses = []
+                topGPUProcesses = []
+            }
+        }
+    }
+
+    /// Processes shown per list
+    var topProcessCount = 5
+
+    /// Busiest processes by CPU and by GPU (empty while `topProcessesEnabled` is off)
+    private(set) var topCPUProcesses: [ProcessUsage] = []
+    private(set) var topGPUProcesses: [ProcessUsage] = []
+
+    /// Per-key temperatures, refreshed with every snapshot while `sensorsEnabled` is on
+    var sensorsEnabled = false {
+        didSet {
+            if !sensorsEnabled { sensors = [] }
+        }
+    }
+    private(set) var sensors: [TemperatureSensor] = []
+
+    /// Key table the sensors came from
+    var sensorTable: String {
+        monitor.sensorTable()
+    }
+
+    /// How far back the menu sparklines reach
+    static let sparklineWindow: TimeInterval = 300
+
+    /// Recent CPU load and power from the raw history tier, oldest first
+    private(set) var cpuLoadHistory: [Float] = []
+    private(set) var cpuPowerHistory: [Float] = []
+
+    /// Reused for every history copy, so sparklines don't allocate per tick
+    @ObservationIgnored private var historyBuffer = [PcStatsHistoryPoint](repeating: PcStatsHistoryPoint(), count: 100)
+
+    /// Called after every sampling pass, once `currentStats` holds the new snapshot
+    var onSample: (@MainActor () async -> Void)?
 
     var isRunning: Bool {
-        timer != nil
+        timer != nil || samplerActive
     }
 
     init() {
         self.currentStats = PcStats()
+        self.activity = SystemActivityMonitor()
+        activity.onChange = { [weak self] conditions in
+            self?.activityChanged(conditions)
+        }
+        samplingInterval = policy.interval(for: activity.conditions)
     }
 
     /// Start collecting stats at the specified interval
     func start() async {
+        guard !isRunning else { return }
+
         await monitor.initialize()
         await monitor.enableTemperatures(true)
 
-        // Initial collection
-        await updateStats()
-
-        // Start timer on main thread
-        timer = Timer.scheduledTimer(withTimeInterval: updateInterval, repeats: true) { [weak self] _ in
-            Task { @MainActor [weak self] in
-                await self?.updateStats()
+        if usesBackgroundSampler {
+            samplerActive = await monitor.startSampler(interval: samplingInterval) { [weak self] _ in
+                Task { @MainActor [weak self] in
+                    await self?.publishSnapshot()
+                }
             }
+            if samplerActive { return }
         }
+
+        // Start timer on main thread
+        scheduleTimer()
+
+        // Initial collection
+        await tick()
     }
 
     /// Stop collecting stats
     func stop() {
         timer?.invalidate()
         timer = nil
+        if samplerActive {
+            samplerActive = false
+            Task {
+                await monitor.stopSampler()
+            }
+        }
+    }
+
+    private func scheduleTimer() {
+        timer?.invalidate()
+        timer = Timer.scheduledTimer(withTimeInterval: samplingInterval, repeats: true) { [weak self] _ in
+            Task { @MainActor [weak self] in
+                await self?.tick()
+            }
+        }
+    }
+
+    // MARK: - Adaptive Interval
+
+    private func setSamplingInterval(_ interval: TimeInterval) {
+        guard interval != samplingInterval else { return }
+        samplingInterval = interval
+        if samplerActive {
+            monitor.setSamplerInterval(interval)
+        } else if timer != nil {
+            scheduleTimer()
+        }
     }
 
-    /// Update stats once
-    private func updateStats() async {
-        let raw = await monitor.collectRawStats()
+    /// Drop the policy's trend and apply the interval for the current conditions
+    private func restartPolicy() {
+        policy.reset()
+        setSamplingInterval(adaptiveSampling ? policy.interval(for: activity.conditions) : updateInterval)
+    }
+
+    private func activityChanged(_ conditions: SamplingConditions) {
+        guard adaptiveSampling else { return }
+        let previousInterval = samplingInterval
+        restartPolicy()
+
+        // Back from sleep or lock: refresh now rather than after the idle interval
+        if !conditions.isIdle && samplingInterval < previousInterval {
+            if samplerActive {
+                monitor.triggerSample()
+            } else if timer != nil {
+                Task { await tick() }
+            }
+        }
+    }
+
+    /// Timer tick: sample once, then hand the snapshot to consumers
+    private func tick() async {
+        _ = await monitor.collectRawStats()
+        await publishSnapshot()
+    }
 
-        // Update observable stats on main actor
+    /// Apply the latest snapshot and notify consumers (skips already-seen snapshots)
+    private func publishSnapshot() async {
+        let raw = monitor.snapshotRawStats()
+        guard raw.sequence != lastSequence else { return }
+        lastSequence = raw.sequence
+
+        apply(raw)
+        if adaptiveSampling {
+            setSamplingInterval(policy.nextInterval(load: raw.cpuLoad, temp: raw.cpuTemp,
+                                                    at: ProcessInfo.processInfo.systemUptime,
+                                                    conditions: activity.conditions))
+        }
+        await onSample?()
+    }
+
+    /// Update observable stats on main actor
+    private func apply(_ raw: RawPcStats) {
         currentStats.boardTemp = raw.boardTemp
         currentStats.boardFanRPM = raw.boardFanRPM
         currentStats.uptimeSeconds = raw.uptimeSeconds
@@ -226,10 +877,43 @@ final class StatsCollector {
         currentStats.networkUpMbps = raw.networkUpMbps
         currentStats.networkDownMbps = raw.networkDownMbps
         currentStats.timestamp = raw.timestamp
+        if currentStats.coreLoads != raw.coreLoads { currentStats.coreLoads = raw.coreLoads }
+        currentStats.perfCoreCount = raw.perfCoreCount
+        currentStats.efficiencyCoreCount = raw.efficiencyCoreCount
+        if currentStats.clusters != raw.clusters { currentStats.clusters = raw.clusters }
+        currentStats.memoryWiredGB = raw.memoryWiredGB
+        currentStats.memoryCompressedGB = raw.memoryCompressedGB
+        currentStats.swapUsedGB = raw.swapUsedGB
+        currentStats.swapTotalGB = raw.swapTotalGB
+        currentStats.memoryPressure = raw.memoryPressure
+        if currentStats.networkInterfaces != raw.interfaces { currentStats.networkInterfaces = raw.interfaces }
+
+        let lastHour = monitor.historySummary(PCSTATS_METRIC_CPU_POWER, tier: PCSTATS_TIER_MINUTE,
+                                              since: Date().addingTimeInterval(-3600))
+        currentStats.cpuPowerPeakLastHour = lastHour?.max ?? raw.cpuPower
+        cpuLoadHistory = recentHistory(PCSTATS_METRIC_CPU_LOAD)
+        cpuPowerHistory = recentHistory(PCSTATS_METRIC_CPU_POWER)
+
+        if metricsEnabled {
+            metrics = monitor.metrics()
+        }
+        if sensorsEnabled {
+            let readings = monitor.temperatureSensors()
+            if sensors != readings { sensors = readings }
+        }
+        if topProcessesEnabled {
+            let byCPU = monitor.topProcesses(by: PCSTATS_PROCESS_SORT_CPU, limit: topProcessCount)
+            let byGPU = monitor.topProcesses(by: PCSTATS_PROCESS_SORT_GPU, limit: topProcessCount)
+            if topCPUProcesses != byCPU { topCPUProcesses = byCPU }
+            if topGPUProcesses != byGPU { topGPUProcesses = byGPU }
+        }
     }
 
-    /// Get JSON for current stats
-    func getJSON() async -> String {
-        await monitor.buildJSON()
+    /// Averages of the raw points inside the sparkline window (the newest
+    /// `historyBuffer.count` of them)
+    private func recentHistory(_ metric: PcStatsMetric) -> [Float] {
+        let since = Date().addingTimeInterval(-Self.sparklineWindow)
+        let count = monitor.copyHistory(metric, tier: PCSTATS_TIER_RAW, since: since, into: &historyBuffer)
+        return historyBuffer.prefix(count).map(\.avg)
     }
 }
@@ -0,0 +1,110 @@
+import Foundation
+import os
+
+/// Press-to-event latency of the key dispatch path, in milliseconds
+struct KeyLatencyStats: Sendable {
+    var count = 0
+    var lastMs = 0.0
+    var maxMs = 0.0
+    var averageMs = 0.0
+
+    mutating func record(_ ms: Double) {
+        count += 1
+        lastMs = ms
+        maxMs = max(maxMs, ms)
+        // Running mean; presses are rare enough that precision is not a concern
+        averageMs += (ms - averageMs) / Double(count)
+    }
+}
+
+/// One key of one profile
+struct KeySlot: Hashable, Sendable {
+    let profileId: Int
+    let keyId: Int
+}
+
+/// Dispatches device key presses to `ActionExecutor` without going through
+/// the MainActor. The serial callback looks the key up in a table of
+/// compiled plans and enqueues it; a single high-priority consumer executes
+/// presses in arrival order, so a busy main thread cannot delay them.
+final class KeyDispatcher: Sendable {
+    private struct Press: Sendable {
+        let plan: ActionPlan
+        let receivedAt: UInt64
+    }
+
+    /// Plans per key, keyed by `tableKey(profileId:keyId:)`
+    private let table = OSAllocatedUnfairLock<[Int: ActionPlan]>(initialState: [:])
+    private let latency = OSAllocatedUnfairLock(initialState: KeyLatencyStats())
+    private let presses: AsyncStream<Press>.Continuation
+
+    init() {
+        let (stream, continuation) = AsyncStream.makeStream(of: Press.self)
+        presses = continuation
+
+        Task.detached(priority: .high) { [latency] in
+            for await press in stream {
+                await ActionExecutor.shared.execute(press.plan) {
+                    let ns = DispatchTime.now().uptimeNanoseconds - press.receivedAt
+                    latency.withLock { $0.record(Double(ns) / 1_000_000) }
+                }
+            }
+        }
+    }
+
+    deinit {
+        presses.finish()
+    }
+
+    private static func tableKey(profileId: Int, keyId: Int) -> Int {
+        profileId << 8 | keyId
+    }
+
+    /// Replace all plans, compiling stored profiles (invalid actions are skipped)
+    /// - Returns: why actions were skipped, for the keys that have any
+    @discardableResult
+    func load(profiles: [Profile]) -> [KeySlot: [ActionPlanError]] {
+        var newTable: [Int: ActionPlan] = [:]
+        var skipped: [KeySlot: [ActionPlanError]] = [:]
+        for profile in profiles {
+            for key in profile.keys where !key.actions.isEmpty {
+                let (plan, errors) = ActionPlan.compileCollectingErrors(key.actions)
+                if !plan.isEmpty {
+                    newTable[Self.tableKey(profileId: profile.id, keyId: key.id)] = plan
+                }
+                if !errors.isEmpty {
+                    skipped[KeySlot(profileId: profile.id, keyId: key.id)] = errors
+                    for error in errors {
+                        print("KeyDispatcher: Skipping invalid action: \(error.localizedDescription)")
+                    }
+                }
+            }
+        }
+        table.withLock { $0 = newTable }
+        return skipped
+    }
+
+    /// Install the plan for one key
+    func setPlan(_ plan: ActionPlan, profileId: Int, keyId: Int) {
+        let key = Self.tableKey(profileId: profileId, keyId: keyId)
+        table.withLock { $0[key] = plan.isEmpty ? nil : plan }
+    }
+
+    /// Queue the actions for a key press. Safe to call from any thread.
+    /// - Returns: false when the key has no actions configured
+    @discardableResult
+    func dispatch(profileId: Int, keyId: Int) -> Bool {
+        let receivedAt = DispatchTime.now().uptimeNanoseconds
+        let key = Self.tableKey(profileId: profileId, keyId: keyId)
+        guard let plan = table.withLock({ $0[key] }) else {
+            return false
+        }
+        presses.yield(Press(plan: plan, receivedAt: receivedAt))
+        return true
+    }
+
+    /// Latency from decoding a press to its first action's events being posted
+    var latencyStats: KeyLatencyStats {
+        latency.withLock { $0 }
+    }
+}
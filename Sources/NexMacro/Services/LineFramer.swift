@@ -0,0 +1,74 @@
+import Foundation
+
+/// Splits the serial byte stream into newline-terminated lines.
+/// Bytes are consumed by advancing a read cursor; the buffer is only
+/// compacted once the consumed prefix outgrows the unread tail, so a burst
+/// of N lines costs O(N) instead of copying the remainder per line.
+/// A separate scan cursor remembers how far the unread tail was already
+/// searched for a newline, so a long line arriving in small reads is only
+/// scanned once.
+struct LineFramer {
+    /// Longest line kept while waiting for a newline; longer input is discarded
+    static let maxLineLength = 4096
+
+    private var buffer: [UInt8] = []
+    private var readIndex = 0
+    /// First byte of the unread tail not yet checked for a newline
+    private var scanIndex = 0
+
+    init() {
+        buffer.reserveCapacity(Self.maxLineLength)
+    }
+
+    /// Bytes received but not yet terminated by a newline
+    var pendingCount: Int {
+        buffer.count - readIndex
+    }
+
+    mutating func reset() {
+        buffer.removeAll(keepingCapacity: true)
+        readIndex = 0
+        scanIndex = 0
+    }
+
+    /// Append received bytes and call `onLine` for each complete line with
+    /// surrounding whitespace (including "\r") trimmed; empty lines are skipped.
+    /// The buffer passed to `onLine` is only valid during the call.
+    mutating func append<Bytes: Sequence>(_ data: Bytes, onLine: (UnsafeBufferPointer<UInt8>) -> Void)
+        where Bytes.Element == UInt8 {
+        buffer.append(contentsOf: data)
+
+        buffer.withUnsafeBufferPointer { bytes in
+            var lineStart = readIndex
+            var index = scanIndex
+            while index < bytes.count {
+                if bytes[index] == 0x0A {  // \n
+                    var start = lineStart
+                    var end = index
+                    while start < end, Self.isWhitespace(bytes[start]) { start += 1 }
+                    while end > start, Self.isWhitespace(bytes[end - 1]) { end -= 1 }
+                    if end > start {
+                        onLine(UnsafeBufferPointer(rebasing: bytes[start..<end]))
+                    }
+                    lineStart = index + 1
+                }
+                index += 1
+            }
+            readIndex = lineStart
+            scanIndex = index
+        }
+
+        if pendingCount > Self.maxLineLength {
+            // No newline in sight: drop the garbage rather than grow forever
+            reset()
+        } else if readIndex > 0 && readIndex >= pendingCount {
+            buffer.removeSubrange(0..<readIndex)
+            scanIndex -= readIndex
+            readIndex = 0
+        }
+    }
+
+    private static func isWhitespace(_ byte: UInt8) -> Bool {
+        byte == 0x20 || byte == 0x09 || byte == 0x0D || byte == 0x0A
+    }
+}
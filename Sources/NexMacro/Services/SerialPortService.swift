@@ -1,17 +1,84 @@
 import Foundation
+import IOKit
 import ORSSerial
+import CPcStats
 
 /// Service for serial port communication with NexMacro devices
 final class SerialPortService: NSObject, @unchecked Sendable {
-    private var port: ORSSerialPort?
     private let portManager = ORSSerialPortManager.shared()
 
-    private var responseBuffer = Data()
+    /// Open port, nonblocking; only touched on the write queue (-1 while closed)
+    private var fd: Int32 = -1
+    private var portPath: String?
+    private var readSource: DispatchSourceRead?
+
+    /// Reads, line framing and key dispatch run here, never on the main
+    /// thread, so a busy UI can't delay a key press. `lineFramer` and
+    /// `readBuffer` belong to this queue.
+    private let readQueue = DispatchQueue(label: "com.nexmacro.serial.read", qos: .userInteractive)
+    private var lineFramer = LineFramer()
+    private var readBuffer = [UInt8](repeating: 0, count: 1024)
     private var onResponse: ((String) -> Void)?
+    private var onKeyPress: ((Int, Int) -> Void)?
     private var onConnectionChange: ((Bool) -> Void)?
 
+    /// Writes for this port; stats are handed over here so a slow device
+    /// never holds up the sampler or the other devices
+    private let writeQueue = DispatchQueue(label: "com.nexmacro.serial.write", qos: .userInitiated)
+
+    /// Stats frames not yet accepted by the port: a small drop-oldest ring
+    /// flushed with one writev (serial_txq_*). Only touched on the write queue.
+    private let txQueue = UnsafeMutablePointer<SerialTxQueue>.allocate(capacity: 1)
+    private var flushScheduled = false
+
+    private let pendingLock = NSLock()
+    private var droppedStats = 0
+    private var statsFrameLost = false
+
+    /// Stats packets dropped from the ring before they were written
+    var droppedStatsPackets: Int {
+        pendingLock.lock()
+        defer { pendingLock.unlock() }
+        return droppedStats
+    }
+
+    /// Whether a stats frame was dropped since the last call. The next packet
+    /// has to be complete then: a dropped delta's sections were already marked
+    /// sent and would never reach the device.
+    func takeStatsFrameLost() -> Bool {
+        pendingLock.lock()
+        defer { pendingLock.unlock() }
+        let lost = statsFrameLost
+        statsFrameLost = false
+        return lost
+    }
+
+    /// Connection state is set from the read queue on unplug and read from
+    /// any caller, so it sits behind its own lock
+    private let stateLock = NSLock()
+    private var connected = false
+    private var appliedBaud: Int?
+
     /// Current connection state
-    private(set) var isConnected = false
+    var isConnected: Bool {
+        stateLock.lock()
+        defer { stateLock.unlock() }
+        return connected
+    }
+
+    /// Baud rate the driver reports after opening (nil while closed)
+    var appliedBaudRate: Int? {
+        stateLock.lock()
+        defer { stateLock.unlock() }
+        return appliedBaud
+    }
+
+    private func setConnected(_ isConnected: Bool, baudRate: Int?) {
+        stateLock.lock()
+        connected = isConnected
+        appliedBaud = baudRate
+        stateLock.unlock()
+    }
 
     /// Available serial ports
     var availablePorts: [ORSSerialPort] {
@@ -19,52 +86,150 @@ final class SerialPortService: NSObject, @unchecked Sendable {
     }
 
     override init() {
+        serial_txq_init(txQueue)
         super.init()
     }
 
+    deinit {
+        txQueue.deallocate()
+    }
+
     /// Connect to a serial port
     func connect(to portPath: String) async throws {
-        guard let serialPort = ORSSerialPort(path: portPath) else {
+        guard FileManager.default.fileExists(atPath: portPath) else {
             throw SerialError.portNotFound
         }
 
-        port = serialPort
-        port?.baudRate = NSNumber(value: NexProtocol.baudRate)
-        port?.numberOfDataBits = UInt(NexProtocol.dataBits)
-        port?.numberOfStopBits = UInt(NexProtocol.stopBits)
-        port?.parity = .none
-        port?.delegate = self
+        // 8N1 raw at any rate (IOSSIOSPEED), 1 ms receive latency (IOSSDATALAT)
+        var applied: Int32 = 0
+        let fd = open_serial_ex(portPath, Int32(NexProtocol.baudRate), 1000, &applied)
+        guard fd >= 0 else {
+            throw SerialError.connectionFailed
+        }
+        guard serial_set_nonblocking(fd, 1) == 0 else {
+            close(fd)
+            throw SerialError.connectionFailed
+        }
+
+        let source = DispatchSource.makeReadSource(fileDescriptor: fd, queue: readQueue)
+        source.setEventHandler { [weak self] in
+            self?.readAvailable(from: fd)
+        }
+        source.setCancelHandler {
+            close(fd)
+        }
 
-        port?.open()
+        readQueue.sync {
+            lineFramer.reset()
+        }
+        writeQueue.sync {
+            self.fd = fd
+            self.portPath = portPath
+            readSource = source
+        }
+        source.resume()
 
-        // Wait a moment for connection
+        // Wait a moment for the device to settle after the port opens
         try await Task.sleep(nanoseconds: 100_000_000)  // 100ms
 
-        if port?.isOpen == true {
-            isConnected = true
-            onConnectionChange?(true)
-        } else {
-            throw SerialError.connectionFailed
+        if Int(applied) != NexProtocol.baudRate {
+            print("SerialPortService: Requested \(NexProtocol.baudRate) baud, driver applied \(applied)")
         }
+        setConnected(true, baudRate: Int(applied))
+        onConnectionChange?(true)
     }
 
     /// Disconnect from current port
     func disconnect() {
-        port?.close()
-        port = nil
-        isConnected = false
+        closePort()
+        setConnected(false, baudRate: nil)
+        onConnectionChange?(false)
+    }
+
+    /// Stop reading and close the fd (the read source's cancel handler closes
+    /// it once no read is in flight). Runs after the writes already queued,
+    /// which read `fd` on the write queue, without waiting for them.
+    private func closePort() {
+        writeQueue.async { [self] in
+            serial_txq_init(txQueue)  // Unsent stats are stale by the next connection
+            fd = -1
+            portPath = nil
+            readSource?.cancel()
+            readSource = nil
+        }
+    }
+
+    /// Runs on the read queue whenever the port has bytes
+    private func readAvailable(from fd: Int32) {
+        let count = readBuffer.withUnsafeMutableBytes { buffer in
+            read(fd, buffer.baseAddress, buffer.count)
+        }
+        if count > 0 {
+            readBuffer.withUnsafeBufferPointer { bytes in
+                lineFramer.append(UnsafeBufferPointer(rebasing: bytes[0..<count])) { line in
+                    // Key presses are the hot path: decode them from the bytes
+                    if let onKeyPress, let key = NexProtocol.parseKeyDown(line) {
+                        onKeyPress(key.profileId, key.keyId)
+                        return
+                    }
+                    onResponse?(String(decoding: line, as: UTF8.self))
+                }
+            }
+            return
+        }
+        if count < 0 && (errno == EAGAIN || errno == EINTR) {
+            return
+        }
+
+        // EOF or a read error: the device was unplugged or reset
+        if count < 0 {
+            print("Serial port error: \(String(cString: strerror(errno)))")
+        }
+        closePort()
+        setConnected(false, baudRate: nil)
         onConnectionChange?(false)
     }
 
-    /// Send data to the device
+    /// Queue data for the device and return at once, so a stalled port never
+    /// holds up the caller (commands are sent from the main actor). Writes go
+    /// out in order; a failed one is logged on the write queue.
     func send(_ data: Data) throws {
-        guard let port = port, port.isOpen else {
+        guard isConnected else {
+            pcstats_metrics_add(PCSTATS_COUNTER_SERIAL_BYTES_DROPPED, UInt64(data.count))
             throw SerialError.notConnected
         }
+        writeQueue.async { [weak self] in
+            guard let self else { return }
+            do {
+                try self.write(data)
+            } catch {
+                print("SerialPortService: Error writing to \(self.portPath ?? "closed port"): \(error)")
+            }
+        }
+    }
 
-        if !port.send(data) {
+    private func write(_ data: Data) throws {
+        guard fd >= 0 else {
+            pcstats_metrics_add(PCSTATS_COUNTER_SERIAL_BYTES_DROPPED, UInt64(data.count))
+            throw SerialError.notConnected
+        }
+
+        // Finish the queued stats first: a half-sent frame would break framing
+        if serial_txq_drain(txQueue, fd, 1000) != 0 {
+            serial_txq_init(txQueue)
+            markStatsFrameLost()
+        }
+
+        // Waits up to 1 s for a stalled device to drain, like send_pc_status()
+        let result = data.withUnsafeBytes { bytes in
+            serial_write_all(fd, bytes.bindMemory(to: UInt8.self).baseAddress, bytes.count, 1000)
+        }
+        if result != 0 {
+            pcstats_metrics_add(PCSTATS_COUNTER_SERIAL_ERRORS, 1)
+            pcstats_metrics_add(PCSTATS_COUNTER_SERIAL_BYTES_DROPPED, UInt64(data.count))
             throw SerialError.sendFailed
         }
+        pcstats_metrics_add(PCSTATS_COUNTER_SERIAL_BYTES_SENT, UInt64(data.count))
     }
 
     /// Send a string to the device
@@ -75,10 +240,63 @@ final class SerialPortService: NSObject, @unchecked Sendable {
         try send(data)
     }
 
-    /// Send PC stats JSON to the device
-    func sendStats(json: String) throws {
-        let packet = NexProtocol.buildStatsPacket(json: json)
-        try send(packet)
+    /// Queue a stats packet without waiting for the port. It joins the ring
+    /// and goes out with whatever the port accepts; when the device falls
+    /// behind the oldest frame not yet started is dropped, and callers send a
+    /// complete packet after `takeStatsFrameLost()` reports it.
+    func enqueueStats(packet: Data) {
+        writeQueue.async { [weak self] in
+            self?.queueStats(packet)
+        }
+    }
+
+    private func queueStats(_ packet: Data) {
+        guard fd >= 0 else {
+            pcstats_metrics_add(PCSTATS_COUNTER_SERIAL_BYTES_DROPPED, UInt64(packet.count))
+            return
+        }
+        let started = DispatchTime.now().uptimeNanoseconds
+        defer {
+            pcstats_metrics_record_ns(PCSTATS_TIMER_SERIAL_SEND, DispatchTime.now().uptimeNanoseconds - started)
+        }
+
+        let pushed = packet.withUnsafeBytes { bytes in
+            serial_txq_push(txQueue, bytes.bindMemory(to: UInt8.self).baseAddress, bytes.count)
+        }
+        if pushed < 0 {
+            print("SerialPortService: Stats packet of \(packet.count) bytes is too large")
+            return
+        }
+        if pushed == 1 {
+            markStatsFrameLost()
+        }
+        flushStats()
+    }
+
+    /// Write what the port accepts without blocking; while frames are left,
+    /// try again shortly instead of waiting on the device
+    private func flushStats() {
+        guard fd >= 0 else { return }
+        let pending = serial_txq_flush(txQueue, fd)
+        if pending < 0 {
+            print("Error sending stats to \(portPath ?? "closed port"): \(String(cString: strerror(errno)))")
+            serial_txq_init(txQueue)
+            markStatsFrameLost()
+        } else if pending > 0 && !flushScheduled {
+            flushScheduled = true
+            writeQueue.asyncAfter(deadline: .now() + .milliseconds(10)) { [weak self] in
+                guard let self else { return }
+                self.flushScheduled = false
+                self.flushStats()
+            }
+        }
+    }
+
+    private func markStatsFrameLost() {
+        pendingLock.lock()
+        droppedStats += 1
+        statsFrameLost = true
+        pendingLock.unlock()
     }
 
     /// Send a command to the device
@@ -114,7 +332,7 @@ final class SerialPortService: NSObject, @unchecked Sendable {
             throw SerialError.invalidData
         }
         try send(data)
-        print("SerialPortService: RGB mode command sent successfully")
+        print("SerialPortService: RGB mode command queued")
     }
 
     /// Set response handler
@@ -122,6 +340,11 @@ final class SerialPortService: NSObject, @unchecked Sendable {
         onResponse = handler
     }
 
+    /// Set key press handler (profile ID, key ID), decoded without going through `onResponse`
+    func setKeyPressHandler(_ handler: @escaping (Int, Int) -> Void) {
+        onKeyPress = handler
+    }
+
     /// Set connection change handler
     func setConnectionHandler(_ handler: @escaping (Bool) -> Void) {
         onConnectionChange = handler
@@ -145,8 +368,8 @@ final class SerialPortService: NSObject, @unchecked Sendable {
             let device = DiscoveredDevice(
                 id: path,
                 portPath: path,
-                vendorId: NexMacroUSB.vendorId,
-                productId: NexMacroUSB.productId,
+                vendorId: usbProperty("idVendor", of: port),
+                productId: usbProperty("idProduct", of: port),
                 name: name
             )
             devices.append(device)
@@ -155,6 +378,18 @@ final class SerialPortService: NSObject, @unchecked Sendable {
         return devices
     }
 
+    /// USB descriptor field of the device behind a serial port (the serial
+    /// service sits below the USB device in the registry, so search upwards)
+    private func usbProperty(_ key: String, of port: ORSSerialPort) -> Int? {
+        let service = port.ioKitDevice
+        guard service != 0 else { return nil }
+        let value = IORegistryEntrySearchCFProperty(
+            service, kIOServicePlane, key as CFString, kCFAllocatorDefault,
+            IOOptionBits(kIORegistryIterateRecursively | kIORegistryIterateParents)
+        )
+        return (value as? NSNumber)?.intValue
+    }
+
     // MARK: - Errors
 
     enum SerialError: Error, LocalizedError {
@@ -176,48 +411,6 @@ final class SerialPortService: NSObject, @unchecked Sendable {
     }
 }
 
-// MARK: - ORSSerialPort Delegate
-
-extension SerialPortService: ORSSerialPortDelegate {
-    func serialPortWasOpened(_ serialPort: ORSSerialPort) {
-        isConnected = true
-        onConnectionChange?(true)
-    }
-
-    func serialPortWasClosed(_ serialPort: ORSSerialPort) {
-        isConnected = false
-        onConnectionChange?(false)
-    }
-
-    func serialPortWasRemovedFromSystem(_ serialPort: ORSSerialPort) {
-        isConnected = false
-        port = nil
-        onConnectionChange?(false)
-    }
-
-    func serialPort(_ serialPort: ORSSerialPort, didReceive data: Data) {
-        // Append to buffer
-        responseBuffer.append(data)
-
-        // Process complete lines
-        while let newlineIndex = responseBuffer.firstIndex(of: 0x0A) {  // \n
-            let lineData = responseBuffer[..<newlineIndex]
-            responseBuffer = Data(responseBuffer[(newlineIndex + 1)...])
-
-            if let line = String(data: lineData, encoding: .utf8) {
-                let trimmed = line.trimmingCharacters(in: .whitespacesAndNewlines)
-                if !trimmed.isEmpty {
-                    onResponse?(trimmed)
-                }
-            }
-        }
-    }
-
-    func serialPort(_ serialPort: ORSSerialPort, didEncounterError error: Error) {
-        print("Serial port error: \(error.localizedDescription)")
-    }
-}
-
 // MARK: - Port Discovery Notifications
 
 extension SerialPortService {
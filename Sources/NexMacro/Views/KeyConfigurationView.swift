@@ -147,6 +147,9 @@ struct ActionEditorView: View {
     @State private var keyAlias: String = ""
     @State private var showingAddAction = false
 
+    /// Why the last edit was rejected
+    @State private var errorMessage: String?
+
     private var keyConfig: KeyConfig? {
         deviceManager.profiles
             .first { $0.id == profileId }?
@@ -185,6 +188,13 @@ struct ActionEditorView: View {
             // Actions list
             actionsListView
 
+            if let errorMessage {
+                Text(errorMessage)
+                    .font(.caption)
+                    .foregroundStyle(.red)
+                    .fixedSize(horizontal: false, vertical: true)
+            }
+
             Spacer()
         }
         .sheet(isPresented: $showingAddAction) {
@@ -200,6 +210,8 @@ struct ActionEditorView: View {
                 .foregroundStyle(.secondary)
 
             if let config = keyConfig, !config.actions.isEmpty {
+                // Stored actions may predate validation; flag the ones that won't run
+                let invalid = deviceManager.actionErrors[KeySlot(profileId: profileId, keyId: keyId)] ?? []
                 ScrollView {
                     VStack(spacing: 4) {
                         ForEach(Array(config.actions.enumerated()), id: \.offset) { index, action in
@@ -207,7 +219,9 @@ struct ActionEditorView: View {
                                 action: action,
                                 index: index,
                                 profileId: profileId,
-                                keyId: keyId
+                                keyId: keyId,
+                                compileError: invalid.first { $0.index == index },
+                                errorMessage: $errorMessage
                             )
                         }
                     }
@@ -226,7 +240,12 @@ struct ActionEditorView: View {
     private func updateKeyAlias(_ newAlias: String) {
         guard var config = keyConfig else { return }
         config.alias = newAlias
-        deviceManager.updateKeyConfig(profileId: profileId, keyId: keyId, config: config)
+        do {
+            try deviceManager.updateKeyConfig(profileId: profileId, keyId: keyId, config: config)
+            errorMessage = nil
+        } catch {
+            errorMessage = error.localizedDescription
+        }
     }
 }
 
@@ -237,11 +256,14 @@ struct ActionRowView: View {
     let index: Int
     let profileId: Int
     let keyId: Int
+    /// Why this action is skipped when the key is pressed
+    let compileError: ActionPlanError?
+    @Binding var errorMessage: String?
 
     var body: some View {
         HStack {
-            Image(systemName: iconForAction(action.type))
-                .foregroundStyle(.secondary)
+            Image(systemName: compileError == nil ? iconForAction(action.type) : "exclamationmark.triangle.fill")
+                .foregroundStyle(compileError == nil ? Color.secondary : Color.red)
                 .frame(width: 24)
 
             VStack(alignment: .leading, spacing: 2) {
@@ -253,7 +275,15 @@ struct ActionRowView: View {
                     .font(.caption2)
                     .foregroundStyle(.secondary)
                     .lineLimit(1)
+
+                if let compileError {
+                    Text(compileError.reason)
+                        .font(.caption2)
+                        .foregroundStyle(.red)
+                        .lineLimit(2)
+                }
             }
+            .help(compileError?.localizedDescription ?? "")
 
             Spacer()
 
@@ -308,7 +338,7 @@ struct ActionRowView: View {
         guard newIndex >= 0, newIndex < keyConfig.actions.count else { return }
 
         keyConfig.actions.swapAt(index, newIndex)
-        deviceManager.updateKeyConfig(profileId: profileId, keyId: keyId, config: keyConfig)
+        save(keyConfig)
     }
 
     private func deleteAction(at index: Int) {
@@ -316,7 +346,16 @@ struct ActionRowView: View {
               var keyConfig = profile.keys.first(where: { $0.id == keyId }) else { return }
 
         keyConfig.actions.remove(at: index)
-        deviceManager.updateKeyConfig(profileId: profileId, keyId: keyId, config: keyConfig)
+        save(keyConfig)
+    }
+
+    private func save(_ keyConfig: KeyConfig) {
+        do {
+            try deviceManager.updateKeyConfig(profileId: profileId, keyId: keyId, config: keyConfig)
+            errorMessage = nil
+        } catch {
+            errorMessage = error.localizedDescription
+        }
     }
 
     private func iconForAction(_ type: KeyActionType) -> String {
@@ -374,6 +413,9 @@ struct AddActionSheet: View {
     // Delay-specific
     @State private var delayMs: String = "100"
 
+    /// Why the last "Add" was rejected
+    @State private var errorMessage: String?
+
     var body: some View {
         VStack(spacing: 16) {
             Text("Add Action")
@@ -393,6 +435,13 @@ struct AddActionSheet: View {
             // Type-specific parameters
             parameterEditor
 
+            if let errorMessage {
+                Text(errorMessage)
+                    .font(.caption)
+                    .foregroundStyle(.red)
+                    .fixedSize(horizontal: false, vertical: true)
+            }
+
             Spacer()
 
             // Buttons
@@ -405,8 +454,9 @@ struct AddActionSheet: View {
                 Spacer()
 
                 Button("Add") {
-                    addAction()
-                    dismiss()
+                    if addAction() {
+                        dismiss()
+                    }
                 }
                 .buttonStyle(.borderedProminent)
             }
@@ -517,7 +567,8 @@ struct AddActionSheet: View {
         }
     }
 
-    private func addAction() {
+    /// Add the configured action; returns false (and shows why) if it is invalid
+    private func addAction() -> Bool {
         let action: KeyAction
 
         switch selectedType {
@@ -569,10 +620,16 @@ struct AddActionSheet: View {
         // Add to key config
         guard var keyConfig = deviceManager.profiles
             .first(where: { $0.id == profileId })?
-            .keys.first(where: { $0.id == keyId }) else { return }
+            .keys.first(where: { $0.id == keyId }) else { return true }
 
         keyConfig.actions.append(action)
-        deviceManager.updateKeyConfig(profileId: profileId, keyId: keyId, config: keyConfig)
+        do {
+            try deviceManager.updateKeyConfig(profileId: profileId, keyId: keyId, config: keyConfig)
+            return true
+        } catch {
+            errorMessage = error.localizedDescription
+            return false
+        }
     }
 }
 
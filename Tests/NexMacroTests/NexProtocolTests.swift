@@ -1,5 +1,6 @@
 import XCTest
 import Foundation
+import CPcStats
 
 /// Tests for NexMacro protocol command construction
 final class NexProtocolTests: XCTestCase {
@@ -176,6 +177,38 @@ final class NexProtocolTests: XCTestCase {
         XCTAssertEqual(parsed.content, "ABC123")
     }
 
+    func testParseCapabilitiesResponse() {
+        let parsed = parseResponse("p=pcb2, pcsd")
+        XCTAssertEqual(parsed.type, "p")
+
+        let caps = parseCapabilities(parsed.content)
+        XCTAssertEqual(caps.binary_versions, 1 << 2)
+        XCTAssertEqual(caps.binary, 1)
+        XCTAssertEqual(caps.partial_json, 1)
+        XCTAssertEqual(statsFormat(for: caps), "binary")
+    }
+
+    func testCapabilitiesFallBackToSupportedFormat() {
+        // Binary frame of another version: partial JSON is the best match
+        let older = parseCapabilities("pcb1,pcsd")
+        XCTAssertEqual(older.binary_versions, 1 << 1)
+        XCTAssertEqual(older.binary, 0)
+        XCTAssertEqual(statsFormat(for: older), "delta")
+        // Unknown and malformed tokens are ignored
+        let unknown = parseCapabilities("pcbx,pcz9,,pcb,pcb2x,pcb99,pcsdd")
+        XCTAssertEqual(unknown.binary_versions, 0)
+        XCTAssertEqual(unknown.partial_json, 0)
+        XCTAssertEqual(statsFormat(for: unknown), "json")
+        // No reply at all stays on JSON
+        XCTAssertEqual(statsFormat(for: parseCapabilities("")), "json")
+    }
+
+    func testCapabilitiesListSeveralBinaryVersions() {
+        let caps = parseCapabilities(" pcb1 ,pcb2,pcb31 ")
+        XCTAssertEqual(caps.binary_versions, 1 << 1 | 1 << 2 | 1 << 31)
+        XCTAssertEqual(caps.binary, 1)  // This build encodes version 2
+    }
+
     func testParseEmptyResponse() {
         let response = ""
         let parsed = parseResponse(response)
@@ -229,6 +262,20 @@ final class NexProtocolTests: XCTestCase {
         return packet
     }
 
+    /// The app's parser (NexProtocol.parseCapabilities wraps it)
+    private func parseCapabilities(_ content: String) -> PcStatsCapabilities {
+        var caps = PcStatsCapabilities()
+        pcstats_parse_capabilities(content, &caps)
+        return caps
+    }
+
+    /// Most compact format the firmware accepts, as DeviceConnection.statsFormat picks it
+    private func statsFormat(for caps: PcStatsCapabilities) -> String {
+        if caps.binary != 0 { return "binary" }
+        if caps.partial_json != 0 { return "delta" }
+        return "json"
+    }
+
     private struct ParsedResponse {
         let type: String?
         let content: String
@@ -0,0 +1,128 @@
+import XCTest
+import Foundation
+import CPcStats
+
+/// Tests for the serial transmit ring (serial_txq_*), written to a nonblocking pipe
+final class SerialTxQueueTests: XCTestCase {
+
+    private var readEnd: Int32 = -1
+    private var writeEnd: Int32 = -1
+    private var queue = SerialTxQueue()
+
+    override func setUp() {
+        super.setUp()
+        var fds: [Int32] = [0, 0]
+        XCTAssertEqual(pipe(&fds), 0)
+        readEnd = fds[0]
+        writeEnd = fds[1]
+        XCTAssertEqual(serial_set_nonblocking(readEnd, 1), 0)
+        XCTAssertEqual(serial_set_nonblocking(writeEnd, 1), 0)
+        serial_txq_init(&queue)
+    }
+
+    override func tearDown() {
+        close(readEnd)
+        close(writeEnd)
+        super.tearDown()
+    }
+
+    private func frame(_ index: Int, length: Int = 10) -> [UInt8] {
+        (0..<length).map { UInt8(truncatingIfNeeded: index * 31 + $0) }
+    }
+
+    @discardableResult
+    private func push(_ frame: [UInt8]) -> Int32 {
+        frame.withUnsafeBufferPointer { serial_txq_push(&queue, $0.baseAddress, $0.count) }
+    }
+
+    private func flush() -> Int32 {
+        serial_txq_flush(&queue, writeEnd)
+    }
+
+    /// Whatever the pipe holds, up to `limit` bytes
+    private func readAvailable(limit: Int = 65536) -> [UInt8] {
+        var buffer = [UInt8](repeating: 0, count: limit)
+        let count = buffer.withUnsafeMutableBytes { read(readEnd, $0.baseAddress, $0.count) }
+        return count > 0 ? Array(buffer[0..<count]) : []
+    }
+
+    func testFlushWritesFramesInOrder() {
+        for index in 0..<3 {
+            XCTAssertEqual(push(frame(index)), 0)
+        }
+        XCTAssertEqual(flush(), 0)
+        XCTAssertEqual(queue.count, 0)
+        XCTAssertEqual(readAvailable(), frame(0) + frame(1) + frame(2))
+    }
+
+    func testRejectsEmptyAndOversizedFrames() {
+        XCTAssertEqual(push([]), -1)
+        XCTAssertEqual(push([UInt8](repeating: 0, count: Int(PCSTATS_MAX_PACKET_LEN) + 1)), -1)
+        XCTAssertEqual(queue.count, 0)
+    }
+
+    func testOverflowDropsOldestFrame() {
+        for index in 0..<Int(PCSTATS_TXQ_SLOTS) {
+            XCTAssertEqual(push(frame(index)), 0)
+        }
+        XCTAssertEqual(push(frame(4)), 1)
+        XCTAssertEqual(queue.dropped, 1)
+        XCTAssertEqual(queue.count, PCSTATS_TXQ_SLOTS)
+
+        XCTAssertEqual(flush(), 0)
+        XCTAssertEqual(readAvailable(), frame(1) + frame(2) + frame(3) + frame(4))
+    }
+
+    func testOverflowKeepsHalfSentFrame() {
+        for index in 0..<Int(PCSTATS_TXQ_SLOTS) {
+            push(frame(index))
+        }
+        // As if an earlier flush stopped three bytes into the head frame
+        XCTAssertEqual(queue.head, 0)
+        queue.slots.0.offset = 3
+
+        XCTAssertEqual(push(frame(4)), 1)
+        XCTAssertEqual(flush(), 0)
+        XCTAssertEqual(readAvailable(), Array(frame(0)[3...]) + frame(2) + frame(3) + frame(4))
+    }
+
+    func testShortWritevResumesMidFrame() {
+        // Fill the pipe so the device looks stalled
+        let filler = [UInt8](repeating: 0xFF, count: 256)
+        var filled = 0
+        while true {
+            let written = filler.withUnsafeBytes { write(writeEnd, $0.baseAddress, $0.count) }
+            guard written > 0 else { break }
+            filled += written
+        }
+
+        let frameLength = 1000
+        var expected: [UInt8] = []
+        for index in 0..<Int(PCSTATS_TXQ_SLOTS) {
+            let bytes = frame(index, length: frameLength)
+            XCTAssertEqual(push(bytes), 0)
+            expected += bytes
+        }
+        XCTAssertEqual(flush(), Int32(expected.count))  // Nothing fits yet
+
+        // Drain less than a frame at a time: each writev only partly succeeds
+        var received: [UInt8] = []
+        var sawPartialFrame = false
+        var rounds = 0
+        while received.count < filled + expected.count && rounds < 10_000 {
+            received += readAvailable(limit: 700)
+            let pending = flush()
+            XCTAssertGreaterThanOrEqual(pending, 0)
+            if pending % Int32(frameLength) != 0 {
+                sawPartialFrame = true
+            }
+            rounds += 1
+        }
+
+        XCTAssertTrue(sawPartialFrame)
+        XCTAssertEqual(queue.count, 0)
+        XCTAssertEqual(received.count, filled + expected.count)
+        XCTAssertEqual(Array(received.suffix(expected.count)), expected)
+        XCTAssertEqual(queue.dropped, 0)
+    }
+}
@@ -0,0 +1,206 @@
+import XCTest
+import Foundation
+import CPcStats
+
+/// Tests for the C stats packet encoder (pcstats_build_packet / build_json)
+final class StatsEncoderTests: XCTestCase {
+
+    // MARK: - Helpers
+
+    private func sampleStatus() -> PcStatus {
+        var status = PcStatus()
+        status.board.temp = 41.26
+        status.board.tick = 3600
+        status.cpu.temp = 55.04
+        status.cpu.load = 12.34
+        status.cpu.tjMax = 100
+        status.gpu.freq = 1398
+        status.memory.percent = 73.96
+        status.network.down = 0.04
+        status.time_stamp = 1_700_000_000
+        return status
+    }
+
+    private func json(_ status: PcStatus) -> String {
+        var status = status
+        var buffer = [CChar](repeating: 0, count: 2048)
+        let length = build_json(&status, &buffer, buffer.count)
+        XCTAssertGreaterThan(length, 0)
+        return String(cString: buffer)
+    }
+
+    // MARK: - JSON Formatting
+
+    func testOneDecimalFormatting() {
+        let text = json(sampleStatus())
+
+        XCTAssertTrue(text.hasPrefix("{\"board\":{\"temp\":41.3,\"rpm\":0.0,\"tick\":3600}"))
+        XCTAssertTrue(text.contains("\"load\":12.3"))
+        XCTAssertTrue(text.contains("\"freq\":1398.0"))
+        XCTAssertTrue(text.contains("\"percent\":74.0"))
+        XCTAssertTrue(text.contains("\"tjMax\":100"))
+        XCTAssertTrue(text.hasSuffix("\"cmd\":1230,\"time\":1700000000}"))
+    }
+
+    func testNegativeAndInvalidValues() {
+        var status = sampleStatus()
+        status.cpu.core1DistanceToTjMax = -3.46
+        status.cpu.consume = -0.04
+        status.gpu.load = .nan
+        let text = json(status)
+
+        XCTAssertTrue(text.contains("\"core1DistanceToTjMax\":-3.5"))
+        XCTAssertTrue(text.contains("\"consume\":0.0"))   // No "-0.0"
+        XCTAssertFalse(text.contains("nan"))
+    }
+
+    func testOutputIsValidJSON() throws {
+        let data = Data(json(sampleStatus()).utf8)
+        let object = try JSONSerialization.jsonObject(with: data) as? [String: Any]
+        XCTAssertNotNil(object?["cpu"])
+        XCTAssertEqual(object?["cmd"] as? Int, 1230)
+    }
+
+    // MARK: - Packet Framing
+
+    func testPacketHeaderAndLength() {
+        var status = sampleStatus()
+        var packet = [UInt8](repeating: 0, count: Int(PCSTATS_MAX_PACKET_LEN))
+        let length = Int(pcstats_build_packet(&status, &packet, packet.count))
+
+        XCTAssertGreaterThan(length, Int(PCSTATS_PACKET_HEADER_LEN))
+        XCTAssertEqual(Array(packet[0..<3]), Array("pcs".utf8))
+
+        let jsonLength = Int(packet[3]) << 8 | Int(packet[4])
+        XCTAssertEqual(jsonLength, length - Int(PCSTATS_PACKET_HEADER_LEN))
+
+        let body = String(bytes: packet[5..<length], encoding: .utf8)
+        XCTAssertEqual(body, json(sampleStatus()))
+    }
+
+    func testPacketRejectsSmallBuffer() {
+        var status = sampleStatus()
+        var packet = [UInt8](repeating: 0, count: 64)
+        XCTAssertEqual(pcstats_build_packet(&status, &packet, packet.count), -1)
+    }
+
+    // MARK: - Delta Packets
+
+    private func deltaPacket(_ delta: inout PcStatsDelta, _ status: PcStatus, partial: Bool) -> String? {
+        var status = status
+        var packet = [UInt8](repeating: 0, count: Int(PCSTATS_MAX_PACKET_LEN))
+        let length = Int(pcstats_delta_build_packet(&delta, &status, partial ? 1 : 0, &packet, packet.count))
+        guard length > 0 else { return nil }
+        return String(bytes: packet[5..<length], encoding: .utf8)
+    }
+
+    func testDeltaSkipsUnchangedAndSendsDirtySections() {
+        var delta = PcStatsDelta()
+        pcstats_delta_init(&delta, 100)
+        var status = sampleStatus()
+
+        // First packet is always a full keyframe
+        XCTAssertEqual(deltaPacket(&delta, status, partial: true), json(status))
+
+        // Changes below the hysteresis are skipped
+        status.cpu.load += 0.4
+        status.time_stamp += 3
+        XCTAssertNil(deltaPacket(&delta, status, partial: true))
+
+        // A dirty CPU section is sent alone when partial updates are supported
+        status.cpu.load += 5
+        let partial = deltaPacket(&delta, status, partial: true)
+        XCTAssertNotNil(partial)
+        XCTAssertTrue(partial?.hasPrefix("{\"cpu\":") ?? false)
+        XCTAssertFalse(partial?.contains("\"network\"") ?? true)
+    }
+
+    func testDeltaSendsFullPacketWithoutPartialSupport() {
+        var delta = PcStatsDelta()
+        pcstats_delta_init(&delta, 100)
+        var status = sampleStatus()
+        _ = deltaPacket(&delta, status, partial: false)
+
+        status.network.up = 25
+        XCTAssertEqual(deltaPacket(&delta, status, partial: false), json(status))
+    }
+
+    func testDeltaKeyframeAfterReset() {
+        var delta = PcStatsDelta()
+        pcstats_delta_init(&delta, 100)
+        let status = sampleStatus()
+        _ = deltaPacket(&delta, status, partial: true)
+        XCTAssertNil(deltaPacket(&delta, status, partial: true))
+
+        pcstats_delta_reset(&delta)
+        XCTAssertEqual(deltaPacket(&delta, status, partial: true), json(status))
+    }
+
+    func testPlanMatchesOneStepBuild() {
+        var oneStep = PcStatsDelta()
+        var twoStep = PcStatsDelta()
+        pcstats_delta_init(&oneStep, 4)
+        pcstats_delta_init(&twoStep, 4)
+        var status = sampleStatus()
+
+        for tick in 0..<12 {
+            if tick % 3 == 0 { status.cpu.load += 5 }
+            if tick == 7 { status.time_stamp += 61 }  // Only the clock is due
+
+            let expected = deltaPacket(&oneStep, status, partial: true)
+            let sections = pcstats_delta_plan(&twoStep, &status, PCSTATS_PACKET_PARTIAL)
+            var packet = [UInt8](repeating: 0, count: Int(PCSTATS_MAX_PACKET_LEN))
+            var actual: String?
+            if sections != 0 {
+                let length = Int(pcstats_build_sections_packet(&status, sections, &packet, packet.count))
+                pcstats_delta_mark_sent(&twoStep, &status, sections)
+                actual = String(bytes: packet[5..<length], encoding: .utf8)
+            }
+
+            XCTAssertEqual(actual, expected, "tick \(tick)")
+            if sections == PCSTATS_SECTION_ALL.rawValue {
+                XCTAssertEqual(actual, json(status))  // Complete packets can be shared
+            }
+        }
+        XCTAssertEqual(oneStep.packets_since_keyframe, twoStep.packets_since_keyframe)
+        XCTAssertEqual(oneStep.skipped, twoStep.skipped)
+    }
+
+    // MARK: - Binary Frame
+
+    func testCRC16CheckValue() {
+        let check = Array("123456789".utf8)
+        XCTAssertEqual(pcstats_crc16(check, check.count), 0x29B1)
+    }
+
+    func testBinaryFrameLayout() {
+        var status = sampleStatus()
+        status.board.rpm = 99_999  // Saturates
+        status.storage.read = 7_400.5  // Past int16 tenths, fits u32
+        status.network.down = 9_412.3  // 10GbE
+        var frame = [UInt8](repeating: 0, count: Int(PCSTATS_BINARY_FRAME_LEN))
+        let length = Int(pcstats_build_binary_packet(&status, &frame, frame.count))
+
+        XCTAssertEqual(length, Int(PCSTATS_BINARY_FRAME_LEN))
+        XCTAssertEqual(Array(frame[0..<3]), Array("pcb".utf8))
+        XCTAssertEqual(Int(frame[3]), Int(PCSTATS_BINARY_VERSION))
+        XCTAssertEqual(Int(frame[4]), Int(PCSTATS_BINARY_PAYLOAD_LEN))
+
+        func int16(at offset: Int) -> Int16 {
+            Int16(bitPattern: UInt16(frame[offset]) | UInt16(frame[offset + 1]) << 8)
+        }
+        XCTAssertEqual(int16(at: 5), 413)            // board.temp 41.26 -> tenths
+        XCTAssertEqual(int16(at: 7), Int16.max)      // board.rpm saturated
+        XCTAssertEqual(int16(at: 13), 123)           // cpu.load 12.34
+
+        // The u32 throughputs follow the 22 int16 fields
+        func uint32(at offset: Int) -> UInt32 {
+            (0..<4).reduce(UInt32(0)) { $0 | UInt32(frame[offset + $1]) << (8 * $1) }
+        }
+        XCTAssertEqual(uint32(at: 5 + 22 * 2), 74_005)       // storage.read
+        XCTAssertEqual(uint32(at: 5 + 22 * 2 + 12), 94_123)  // network.down
+
+        let crc = UInt16(frame[length - 2]) | UInt16(frame[length - 1]) << 8
+        XCTAssertEqual(crc, pcstats_crc16(frame, length - 2))
+    }
+}
@@ -0,0 +1,85 @@
+import XCTest
+import Foundation
+import CPcStats
+
+/// Tests for the C stats history rings (pcstats_history_*)
+final class StatsHistoryTests: XCTestCase {
+
+    /// 10:00 on an arbitrary day, minute aligned
+    private let base: Int64 = 1_700_000_000_000 - 1_700_000_000_000 % 3_600_000
+
+    override func setUp() {
+        super.setUp()
+        pcstats_history_reset()
+    }
+
+    private func record(power: Float, at time: Int64) {
+        var status = PcStatus()
+        status.cpu.consume = power
+        pcstats_history_record(&status, time)
+    }
+
+    // MARK: - Rollups
+
+    func testMinuteRollupMinMaxAvg() {
+        // Two minutes of 10 s samples: 0...5 W, then 6...11 W
+        for i in 0..<12 {
+            record(power: Float(i), at: base + Int64(i) * 10_000)
+        }
+
+        var points = [PcStatsHistoryPoint](repeating: PcStatsHistoryPoint(), count: 8)
+        let count = Int(pcstats_history_copy(PCSTATS_TIER_MINUTE, PCSTATS_METRIC_CPU_POWER, 0, &points, Int32(points.count)))
+
+        XCTAssertEqual(count, 2)  // Closed minute + the one still being filled
+        XCTAssertEqual(points[0].time_ms, base)
+        XCTAssertEqual(points[0].min, 0)
+        XCTAssertEqual(points[0].max, 5)
+        XCTAssertEqual(points[0].avg, 2.5, accuracy: 0.001)
+        XCTAssertEqual(points[0].samples, 6)
+        XCTAssertEqual(points[1].time_ms, base + 60_000)
+        XCTAssertEqual(points[1].max, 11)
+    }
+
+    func testSummaryIsSampleWeighted() {
+        record(power: 10, at: base)
+        for i in 0..<3 {
+            record(power: 2, at: base + 60_000 + Int64(i) * 1000)
+        }
+
+        var summary = PcStatsHistoryPoint()
+        XCTAssertEqual(pcstats_history_summary(PCSTATS_TIER_MINUTE, PCSTATS_METRIC_CPU_POWER, 0, &summary), 2)
+        XCTAssertEqual(summary.max, 10)
+        XCTAssertEqual(summary.min, 2)
+        XCTAssertEqual(summary.avg, 4, accuracy: 0.001)  // (10 + 3 * 2) / 4
+        XCTAssertEqual(summary.samples, 4)
+    }
+
+    // MARK: - Windows
+
+    func testRawWindowKeepsMostRecent() {
+        for i in 0..<10 {
+            record(power: Float(i), at: base + Int64(i) * 1000)
+        }
+
+        var points = [PcStatsHistoryPoint](repeating: PcStatsHistoryPoint(), count: 3)
+        XCTAssertEqual(pcstats_history_copy(PCSTATS_TIER_RAW, PCSTATS_METRIC_CPU_POWER, 0, &points, 3), 3)
+        XCTAssertEqual(points.map(\.avg), [7, 8, 9])
+
+        var window = [PcStatsHistoryPoint](repeating: PcStatsHistoryPoint(), count: 16)
+        XCTAssertEqual(pcstats_history_copy(PCSTATS_TIER_RAW, PCSTATS_METRIC_CPU_POWER, base + 6000, &window, 16), 4)
+        XCTAssertEqual(window[0].avg, 6)
+    }
+
+    func testRawRingIsBounded() {
+        let total = Int(PCSTATS_HISTORY_RAW_CAPACITY) + 50
+        for i in 0..<total {
+            record(power: Float(i), at: base + Int64(i) * 1000)
+        }
+
+        var summary = PcStatsHistoryPoint()
+        XCTAssertEqual(Int(pcstats_history_summary(PCSTATS_TIER_RAW, PCSTATS_METRIC_CPU_POWER, 0, &summary)),
+                       Int(PCSTATS_HISTORY_RAW_CAPACITY))
+        XCTAssertEqual(summary.min, 50)  // Oldest 50 samples overwritten
+        XCTAssertEqual(summary.max, Float(total - 1))
+    }
+}
@@ -0,0 +1,62 @@
+import XCTest
+import Foundation
+import CPcStats
+
+/// Tests for the C collector instrumentation (pcstats_metrics_*)
+final class StatsMetricsTests: XCTestCase {
+
+    override func setUp() {
+        super.setUp()
+        pcstats_metrics_enable(1)
+        pcstats_metrics_reset()
+    }
+
+    override func tearDown() {
+        pcstats_metrics_enable(0)
+        pcstats_metrics_reset()
+        super.tearDown()
+    }
+
+    private func metrics() -> PcStatsMetrics {
+        var metrics = PcStatsMetrics()
+        XCTAssertEqual(pcstats_get_metrics(&metrics), 0)
+        return metrics
+    }
+
+    func testDisabledRecordsNothing() {
+        pcstats_metrics_enable(0)
+        pcstats_metrics_record_ns(PCSTATS_TIMER_TICK, 1_000)
+        pcstats_metrics_add(PCSTATS_COUNTER_SMC_CALLS, 1)
+
+        let recorded = metrics()
+        XCTAssertEqual(recorded.enabled, 0)
+        XCTAssertEqual(recorded.timers.0.count, 0)
+        XCTAssertEqual(recorded.counters.0, 0)
+    }
+
+    func testPercentilesWithinBucketResolution() {
+        // 1 µs ... 1 ms, uniformly
+        for i in 1...1000 {
+            pcstats_metrics_record_ns(PCSTATS_TIMER_TICK, UInt64(i) * 1_000)
+        }
+
+        let tick = metrics().timers.0
+        XCTAssertEqual(tick.count, 1000)
+        XCTAssertEqual(tick.max_ns, 1_000_000)
+        XCTAssertEqual(tick.total_ns, 500_500_000)
+        XCTAssertEqual(Double(tick.p50_ns), 500_000, accuracy: 125_000)
+        XCTAssertEqual(Double(tick.p99_ns), 990_000, accuracy: 125_000)
+        XCTAssertLessThanOrEqual(tick.p99_ns, tick.max_ns)
+    }
+
+    func testCountersAndNames() {
+        pcstats_metrics_add(PCSTATS_COUNTER_SERIAL_BYTES_SENT, 64)
+        pcstats_metrics_add(PCSTATS_COUNTER_SERIAL_BYTES_SENT, 36)
+        pcstats_metrics_add(PCSTATS_COUNTER_COUNT, 1)  // Out of range: ignored
+
+        XCTAssertEqual(metrics().counters.9, 100)
+        XCTAssertEqual(String(cString: pcstats_metrics_counter_name(PCSTATS_COUNTER_SERIAL_BYTES_SENT)), "serial_bytes_sent")
+        XCTAssertEqual(String(cString: pcstats_metrics_timer_name(PCSTATS_TIMER_SMC_TEMPS)), "smc_temps")
+        XCTAssertEqual(String(cString: pcstats_metrics_timer_name(PCSTATS_TIMER_COUNT)), "")
+    }
+}
@@ -0,0 +1,114 @@
+import XCTest
+import Foundation
+import CPcStats
+
+/// Tests for replaying recorded collector output (pcstats_replay_*)
+final class StatsReplayTests: XCTestCase {
+
+    private var savedPeriods: [UInt32] = []
+
+    override func setUp() {
+        super.setUp()
+        savedPeriods = (0..<PCSTATS_COLLECTOR_COUNT.rawValue).map {
+            pcstats_get_collector_period(PcCollector($0))
+        }
+    }
+
+    override func tearDown() {
+        pcstats_replay_close()
+        for (index, period) in savedPeriods.enumerated() {
+            pcstats_set_collector_period(PcCollector(UInt32(index)), period)
+        }
+        super.tearDown()
+    }
+
+    /// Frames 3 s apart with distinct readings per frame
+    private func frames(_ count: Int) -> [PcStatsReplayFrame] {
+        (0..<count).map { i in
+            var frame = PcStatsReplayFrame()
+            frame.offset_ms = UInt64(i) * 3000
+            frame.time_stamp = 1_700_000_000
+            frame.cpu_temp = 40 + Float(i)
+            frame.cpu_load = 10 * Float(i)
+            frame.fans.count = 1
+            frame.fans.rpm.0 = 1000 + Float(i)
+            return frame
+        }
+    }
+
+    private func collect() -> PcStatus {
+        var status = PcStatus()
+        collect_stats(&status)
+        return status
+    }
+
+    func testCollectorsFollowTheirPeriodsOnTheReplayClock() {
+        pcstats_set_collector_period(PCSTATS_COLLECTOR_CPU, 0)
+        pcstats_set_collector_period(PCSTATS_COLLECTOR_FANS, 5000)
+        XCTAssertEqual(pcstats_replay_load(frames(4), 4, 0), 4)
+
+        let samples = (0..<4).map { _ in collect() }
+
+        // CPU runs every tick, fans only at 0 s and 6 s
+        XCTAssertEqual(samples.map(\.cpu.load), [0, 10, 20, 30])
+        XCTAssertEqual(samples.map(\.board.rpm), [1000, 1000, 1002, 1002])
+        XCTAssertEqual(pcstats_replay_position(), 4)
+    }
+
+    func testFinalFrameRepeatsWithoutLoop() {
+        pcstats_set_collector_period(PCSTATS_COLLECTOR_CPU, 0)
+        pcstats_replay_load(frames(2), 2, 0)
+
+        _ = collect()
+        XCTAssertEqual(collect().cpu.load, 10)
+        XCTAssertEqual(collect().cpu.load, 10)
+
+        pcstats_replay_close()
+        XCTAssertEqual(pcstats_replay_position(), -1)
+    }
+
+    func testGPUMemoryFollowsMemoryCollector() {
+        pcstats_set_collector_period(PCSTATS_COLLECTOR_MEMORY, 0)
+        var replay = frames(2)
+        replay[0].gpu_mem_used = 1.5
+        replay[0].gpu_mem_total = 10.7
+        replay[1].gpu_mem_used = 4.25
+        replay[1].gpu_mem_total = 10.7
+        pcstats_replay_load(replay, 2, 0)
+
+        XCTAssertEqual(collect().gpu.memUsed, 1.5)
+        let second = collect()
+        XCTAssertEqual(second.gpu.memUsed, 4.25)
+        XCTAssertEqual(second.gpu.memTotal, 10.7)
+    }
+
+    func testDeltaSeesOnlyReplayedChanges() {
+        for index in 0..<PCSTATS_COLLECTOR_COUNT.rawValue {
+            pcstats_set_collector_period(PcCollector(index), 0)
+        }
+        var replay = frames(2)
+        replay[1] = replay[0]
+        replay[1].offset_ms = 3000
+        replay[1].network.down = 250
+        pcstats_replay_load(replay, 2, 0)
+
+        var delta = PcStatsDelta()
+        pcstats_delta_init(&delta, UInt32(PCSTATS_DELTA_DEFAULT_KEYFRAME))
+        var packet = [UInt8](repeating: 0, count: Int(PCSTATS_MAX_PACKET_LEN))
+        var first = collect()
+        XCTAssertGreaterThan(pcstats_delta_build_packet(&delta, &first, 0, &packet, packet.count), 0)
+
+        var second = collect()
+        XCTAssertEqual(pcstats_delta_dirty_sections(&delta, &second), PCSTATS_SECTION_NETWORK.rawValue)
+    }
+
+    func testRejectsFilesThatAreNotRecordings() throws {
+        let url = FileManager.default.temporaryDirectory.appendingPathComponent("replay-\(UUID().uuidString).bin")
+        try Data("not a recording".utf8).write(to: url)
+        defer { try? FileManager.default.removeItem(at: url) }
+
+        XCTAssertEqual(pcstats_replay_open(url.path, 0), -1)
+        XCTAssertEqual(pcstats_replay_open("/nonexistent/replay.bin", 0), -1)
+        XCTAssertEqual(pcstats_replay_position(), -1)
+    }
+}